@@ -0,0 +1,264 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: allpairs.c
+* Description: All-pairs cost table for cost queries without filters: one full cost search per start city, built on
+*              the thread pool, and the .sol line of a client written by walking the row of its start city.
+*/
+
+#include "allpairs.h"
+#include "threadpool.h"
+#include <string.h>
+#include <stdlib.h>
+
+// Rows to build, shared by the thread pool tasks
+struct TableFill {
+    struct CostTable* table;
+    const struct Graph* graph;
+    struct Workspace** workspaces;
+    const int* startCities;
+    int numStarts;
+};
+
+/***********************************************************************************************************************
+ * costTablePays()
+ *
+ * Arguments: numCities - number of cities of the map
+ *            numClients - number of cost queries without filters in the batch
+ * Returns: true if the table fits in COST_TABLE_MAX_BYTES and there are enough queries per city
+ * Side-Effects: none
+ *
+ * Description: a row costs a full search, where the clients of a start city grouped together stop their search once
+ *              their end cities are settled. With COST_TABLE_CLIENTS_PER_CITY queries per city, start cities have
+ *              enough clients for that search to settle nearly every city anyway, and the table saves the sorting
+ *              and grouping of those clients.
+ ***********************************************************************************************************************/
+bool costTablePays(int numCities, int numClients) {
+    if (numCities <= 0) return false;
+    if ((size_t)numCities * numCities * sizeof(struct CostEntry) > COST_TABLE_MAX_BYTES) return false;
+    return numClients / numCities >= COST_TABLE_CLIENTS_PER_CITY;
+}
+
+/***********************************************************************************************************************
+ * costTableEligible()
+ *
+ * Arguments: graph - map graph
+ *            client - client request
+ *            budgetAware - true if clients with B1 or B2 are answered by the budget-aware engine
+ * Returns: true if the client can be answered from the table
+ * Side-Effects: none
+ *
+ * Description: cost queries between two cities of the map with no A1 transport of the map excluded and no A2 or A3
+ *              limit. An A1 transport the map does not know filters nothing (see compile_restrictions()).
+ ***********************************************************************************************************************/
+bool costTableEligible(const struct Graph* graph, const struct Client* client, bool budgetAware) {
+    const struct Restrictions* restrictions = &client->restrictions;
+    if (client->startCity <= 0 || client->endCity <= 0 || client->startCity > graph->numCities || client->endCity > graph->numCities) {
+        return false;
+    }
+    if (strcmp(client->filter, "cost") != 0) return false;
+    if (restrictions->allowedTransports != ~(uint64_t)0 || restrictions->excludedTransport >= 0 || restrictions->A2 || restrictions->A3) {
+        return false;
+    }
+    return !(budgetAware && (restrictions->B1 || restrictions->B2));
+}
+
+/***********************************************************************************************************************
+ * setOrigins()
+ *
+ * Arguments: table - cost table
+ *            graph - map graph
+ * Returns: void
+ * Side-Effects: (re)allocates and fills table->origin, exits if memory runs out
+ *
+ * Description: the city each edge leaves, from the CSR offsets.
+ ***********************************************************************************************************************/
+static void setOrigins(struct CostTable* table, const struct Graph* graph) {
+    free(table->origin);
+    table->numEdges = graph->numEdges;
+    table->origin = malloc((graph->numEdges > 0 ? graph->numEdges : 1) * sizeof(int));
+    if (table->origin == NULL) exit(0);
+    for (int u = 0; u < graph->numCities; u++) {
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) table->origin[e] = u;
+    }
+}
+
+/***********************************************************************************************************************
+ * createCostTable()
+ *
+ * Arguments: graph - map graph
+ * Returns: pointer to a table without rows
+ * Side-Effects: allocates dynamic memory, exits if memory runs out
+ *
+ * Description: only the row pointers and the edge origins are allocated; rows come with fillCostTable().
+ ***********************************************************************************************************************/
+struct CostTable* createCostTable(const struct Graph* graph) {
+    struct CostTable* table = malloc(sizeof(struct CostTable));
+    if (table == NULL) exit(0);
+    table->numCities = graph->numCities;
+    table->numRows = 0;
+    table->origin = NULL;
+    table->rows = calloc(graph->numCities > 0 ? graph->numCities : 1, sizeof(struct CostEntry*));
+    if (table->rows == NULL) exit(0);
+    setOrigins(table, graph);
+    return table;
+}
+
+/***********************************************************************************************************************
+ * buildRows()
+ *
+ * Arguments: context - pointer to the TableFill
+ *            task - index of the task: rows of startCities[task * COST_TABLE_BLOCK ..]
+ *            thread - index of the worker running the task
+ * Returns: void
+ * Side-Effects: fills the rows of the task, overwrites the worker's workspace
+ *
+ * Description: thread pool task: one full cost search per start city with the worker's workspace, copied into the
+ *              city's row (allocated before the workers start). Cities the search did not reach get INF.
+ ***********************************************************************************************************************/
+static void buildRows(void* context, int task, int thread) {
+    struct TableFill* fill = context;
+    struct Workspace* ws = fill->workspaces[thread];
+    int n = fill->graph->numCities;
+    char filter[10] = "cost";
+    struct Restrictions restrictions;
+    memset(&restrictions, 0, sizeof(restrictions));
+    restrictions.allowedTransports = ~(uint64_t)0;
+    restrictions.excludedTransport = -1;
+
+    int last = (task + 1) * COST_TABLE_BLOCK < fill->numStarts ? (task + 1) * COST_TABLE_BLOCK : fill->numStarts;
+    for (int k = task * COST_TABLE_BLOCK; k < last; k++) {
+        int start = fill->startCities[k];
+        struct CostEntry* row = fill->table->rows[start - 1];
+        dijkstra_search(fill->graph, ws, restrictions, start, 0, filter, NULL, 0);
+        for (int v = 0; v < n; v++) {
+            bool reached = ws->stamp[v] == ws->epoch && ws->weight[v] != INF;
+            row[v].cost = reached ? ws->weight[v] : INF;
+            row[v].edge = reached && v != start - 1 ? ws->prevEdge[v] : -1;
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ * fillCostTable()
+ *
+ * Arguments: table - cost table of the graph
+ *            graph - map graph
+ *            workspaces - one workspace per thread
+ *            numThreads - number of threads
+ *            startCities - 1-based start cities whose rows are needed
+ *            numStarts - number of entries in startCities
+ * Returns: void
+ * Side-Effects: allocates and fills the missing rows, creates threads if numThreads > 1 and there is more than one
+ *               block, exits if memory runs out
+ *
+ * Description: the missing rows are allocated here, so the workers only write their own rows, and built in blocks of
+ *              COST_TABLE_BLOCK start cities per task. A start city listed twice is built once.
+ ***********************************************************************************************************************/
+void fillCostTable(struct CostTable* table, const struct Graph* graph, struct Workspace** workspaces, int numThreads, const int* startCities, int numStarts) {
+    int* missing = malloc((numStarts > 0 ? numStarts : 1) * sizeof(int));
+    if (missing == NULL) exit(0);
+
+    int numMissing = 0;
+    for (int k = 0; k < numStarts; k++) {
+        int s = startCities[k] - 1;
+        if (table->rows[s] != NULL) continue;
+        table->rows[s] = malloc((size_t)table->numCities * sizeof(struct CostEntry));
+        if (table->rows[s] == NULL) exit(0);
+        missing[numMissing++] = s + 1;
+    }
+    table->numRows += numMissing;
+
+    struct TableFill fill = { table, graph, workspaces, missing, numMissing };
+    int numTasks = (numMissing + COST_TABLE_BLOCK - 1) / COST_TABLE_BLOCK;
+    if (numThreads > 1 && numTasks > 1) {
+        joinThreadPool(startThreadPool(numThreads, numTasks, buildRows, &fill));
+    } else {
+        for (int t = 0; t < numTasks; t++) buildRows(&fill, t, 0);
+    }
+    free(missing);
+}
+
+/***********************************************************************************************************************
+ * write_table()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            table - cost table with the row of the client's start city built
+ *            ws - workspace whose tripEdge array is used to replay the waiting times
+ *            client - cost query accepted by costTableEligible()
+ *            output - buffer receiving the .sol line
+ * Returns: void
+ * Side-Effects: appends the result to the output buffer, overwrites the tripEdge array of the workspace
+ *
+ * Description: the same line write_tree() writes from a search tree: the hops are built backwards from the end city
+ *              along the row of the start city, then the waiting times of the path are replayed forwards from the
+ *              client's departure.
+ ***********************************************************************************************************************/
+void write_table(const struct Graph* graph, const struct CostTable* table, struct Workspace* ws, const struct Client* client, struct SolBuffer* output) {
+    const struct CostEntry* row = table->rows[client->startCity - 1];
+    int startCity = client->startCity;
+    int primary = row[client->endCity - 1].cost;
+
+    if (!check_budget(client->restrictions, client->filter, primary)) {
+        solPutInt(output, client->clientID, ' ');
+        solPutInt(output, -1, '\n');
+        return;
+    }
+
+    solPutInt(output, client->clientID, ' ');
+    solPutInt(output, startCity, ' ');
+
+    int numHops = 0;
+    solBeginBackward(output);
+    for (int v = client->endCity - 1; v != startCity - 1; v = table->origin[row[v].edge]) {
+        const struct Edge* edge = &graph->edges[row[v].edge];
+        solPrependInt(output, v + 1, ' ');
+        solPrependWord(output, graph->transports[edge->transport], ' ');
+        ws->tripEdge[numHops++] = row[v].edge;
+    }
+    solEndBackward(output);
+
+    int time = client->departureTime;
+    for (int i = numHops - 1; i >= 0; i--) {
+        const struct Edge* edge = &graph->edges[ws->tripEdge[i]];
+        time += waiting_time(time, edge) + edge->travelDuration;
+    }
+    solPutInt(output, time - client->departureTime, ' ');
+    solPutInt(output, primary, '\n');
+}
+
+/***********************************************************************************************************************
+ * clearCostTable()
+ *
+ * Arguments: table - cost table
+ *            graph - the graph after its change
+ * Returns: void
+ * Side-Effects: frees every row, recomputes the edge origins
+ *
+ * Description: the rows are rebuilt on demand for the changed map.
+ ***********************************************************************************************************************/
+void clearCostTable(struct CostTable* table, const struct Graph* graph) {
+    for (int s = 0; s < table->numCities; s++) {
+        free(table->rows[s]);
+        table->rows[s] = NULL;
+    }
+    table->numRows = 0;
+    setOrigins(table, graph);
+}
+
+/***********************************************************************************************************************
+ * freeCostTable()
+ *
+ * Arguments: table - cost table, or NULL
+ * Returns: void
+ * Side-Effects: frees dynamically allocated memory
+ *
+ * Description: frees the rows, the edge origins and the table.
+ ***********************************************************************************************************************/
+void freeCostTable(struct CostTable* table) {
+    if (table == NULL) return;
+    for (int s = 0; s < table->numCities; s++) free(table->rows[s]);
+    free(table->rows);
+    free(table->origin);
+    free(table);
+}
@@ -0,0 +1,74 @@
+/******************************************************************************
+ * NAME
+ *   allpairs.h
+ *
+ * DESCRIPTION
+ *   Header file for the all-pairs cost table: the cost and the last edge of
+ *   the cheapest path between every pair of cities, so that a cost query
+ *   without connection filters is a walk along its path.
+ *
+ * COMMENTS
+ *   Row s of the table is the predecessor tree of a full cost search from
+ *   city s + 1: entry v holds the cost of reaching v and the edge the
+ *   search reached it through, and origin[] gives the city that edge
+ *   leaves, so the path to v is read backwards from row s alone. Rows are
+ *   filled the first time a start city is asked for, by dijkstra_search()
+ *   with the workspaces of the batch, so the paths are the ones the grouped
+ *   Dijkstra searches give (same queue, same ties). Each row is one block
+ *   of numCities entries, built by one worker thread and then only read.
+ *   B1 and B2 are checked on the cost and the replayed duration, as after
+ *   a search, so they do not keep a client from the table.
+ *
+ ******************************************************************************/
+
+#ifndef ALLPAIRS_H
+#define ALLPAIRS_H
+
+#include "dijkstra.h"
+
+// Largest table (numCities^2 entries) processFiles() makes
+#define COST_TABLE_MAX_BYTES ((size_t)256 << 20)
+// Cost queries without filters per city from which the table is used
+#define COST_TABLE_CLIENTS_PER_CITY 64
+// Rows built by one thread pool task
+#define COST_TABLE_BLOCK 8
+
+// Entry v of the row of a start city
+struct CostEntry {
+    int cost;                   // INF if v cannot be reached
+    int edge;                   // index in graph->edges of the last edge of the path (-1 at the start city)
+};
+
+// All-pairs cost table of a graph, filled one row per start city
+struct CostTable {
+    int numCities;
+    struct CostEntry** rows;    // rows[s] for start city s + 1, NULL until it is built
+    int* origin;                // origin[e] = city edges[e] leaves
+    int numEdges;
+    int numRows;                // rows built
+};
+
+struct Workspace;
+
+// True if a batch with numClients cost queries without filters on a map of numCities cities should use the table
+bool costTablePays(int numCities, int numClients);
+
+// True if the client is a cost query the table answers (budgetAware: B1/B2 clients go to the budget-aware engine)
+bool costTableEligible(const struct Graph* graph, const struct Client* client, bool budgetAware);
+
+// Allocates an empty table for the graph; exits if memory runs out
+struct CostTable* createCostTable(const struct Graph* graph);
+
+// Builds the rows of the start cities (1-based, the missing ones only), on numThreads threads with their workspaces
+void fillCostTable(struct CostTable* table, const struct Graph* graph, struct Workspace** workspaces, int numThreads, const int* startCities, int numStarts);
+
+// Writes the .sol line of a client whose start city's row is built; ws provides scratch for the path
+void write_table(const struct Graph* graph, const struct CostTable* table, struct Workspace* ws, const struct Client* client, struct SolBuffer* output);
+
+// Drops every row after the graph changed
+void clearCostTable(struct CostTable* table, const struct Graph* graph);
+
+// Frees the table (NULL is ignored)
+void freeCostTable(struct CostTable* table);
+
+#endif
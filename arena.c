@@ -0,0 +1,147 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: arena.c
+* Description: Arena allocator: memory handed out from large blocks and released all at once.
+*/
+
+#include "arena.h"
+#include <stdlib.h>
+
+// Header of a block; the memory handed out follows it
+struct ArenaBlock {
+    struct ArenaBlock* next;    // older block
+    size_t size;                // bytes after the header
+};
+
+// Bytes from the start of a block to its memory, which malloc()'s alignment keeps aligned to ARENA_ALIGN
+#define BLOCK_HEADER ((sizeof(struct ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+/***********************************************************************************************************************
+ * roundUp()
+ *
+ * Arguments: bytes - size to round
+ * Returns: bytes rounded up to a multiple of ARENA_ALIGN
+ * Side-Effects: none
+ *
+ * Description: every allocation takes a multiple of ARENA_ALIGN bytes, so the next one stays aligned.
+ ***********************************************************************************************************************/
+static size_t roundUp(size_t bytes) {
+    return (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+/***********************************************************************************************************************
+ * addBlock()
+ *
+ * Arguments: arena - arena to grow
+ *            size - bytes the block must hold
+ * Returns: 1 if the block was allocated, 0 if memory runs out
+ * Side-Effects: allocates a block and makes it the one allocations come from
+ *
+ * Description: the older blocks stay in the list until the arena is reset or freed.
+ ***********************************************************************************************************************/
+static int addBlock(struct Arena* arena, size_t size) {
+    struct ArenaBlock* block = malloc(BLOCK_HEADER + size);
+    if (block == NULL) return 0;
+    block->next = arena->blocks;
+    block->size = size;
+    arena->blocks = block;
+    arena->used = 0;
+    arena->size = size;
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * initArena()
+ *
+ * Arguments: arena - arena to initialize
+ *            size - bytes of the first block, 0 to allocate it on the first arenaAlloc()
+ * Returns: 1 if the arena is ready, 0 if the first block cannot be allocated
+ * Side-Effects: allocates the first block
+ *
+ * Description: callers that know how much they will allocate pass it here (see arenaBytes()), so everything comes
+ *              from one block.
+ ***********************************************************************************************************************/
+int initArena(struct Arena* arena, size_t size) {
+    arena->blocks = NULL;
+    arena->used = 0;
+    arena->size = 0;
+    return size == 0 || addBlock(arena, roundUp(size));
+}
+
+/***********************************************************************************************************************
+ * arenaBytes()
+ *
+ * Arguments: count - number of elements
+ *            elementSize - bytes of one element
+ * Returns: bytes taken by one allocation of count elements
+ * Side-Effects: none
+ *
+ * Description: an allocation takes at least one element, rounded up to ARENA_ALIGN.
+ ***********************************************************************************************************************/
+size_t arenaBytes(size_t count, size_t elementSize) {
+    return roundUp((count > 0 ? count : 1) * elementSize);
+}
+
+/***********************************************************************************************************************
+ * arenaAlloc()
+ *
+ * Arguments: arena - arena to allocate from
+ *            bytes - size of the allocation (0 is allocated as 1)
+ * Returns: pointer to the memory
+ * Side-Effects: may allocate a new block, exits if memory runs out
+ *
+ * Description: bumps the position in the newest block; when the allocation does not fit, a new block twice the size
+ *              of the last one (or large enough for the allocation) is started.
+ ***********************************************************************************************************************/
+void* arenaAlloc(struct Arena* arena, size_t bytes) {
+    bytes = roundUp(bytes > 0 ? bytes : 1);
+    if (arena->blocks == NULL || arena->size - arena->used < bytes) {
+        size_t size = arena->size > 0 ? 2 * arena->size : ARENA_BLOCK_SIZE;
+        if (size < bytes) size = bytes;
+        if (!addBlock(arena, size)) exit(0);
+    }
+    void* memory = (char*)arena->blocks + BLOCK_HEADER + arena->used;
+    arena->used += bytes;
+    return memory;
+}
+
+/***********************************************************************************************************************
+ * resetArena()
+ *
+ * Arguments: arena - arena to empty
+ * Returns: void
+ * Side-Effects: frees the blocks and allocates one as large as all of them, exits if memory runs out
+ *
+ * Description: with a single block nothing is freed; its memory is just handed out again.
+ ***********************************************************************************************************************/
+void resetArena(struct Arena* arena) {
+    if (arena->blocks != NULL && arena->blocks->next != NULL) {
+        size_t total = 0;
+        for (struct ArenaBlock* block = arena->blocks; block != NULL; block = block->next) total += block->size;
+        freeArena(arena);
+        if (!addBlock(arena, total)) exit(0);
+    }
+    arena->used = 0;
+}
+
+/***********************************************************************************************************************
+ * freeArena()
+ *
+ * Arguments: arena - arena to free
+ * Returns: void
+ * Side-Effects: frees dynamically allocated memory
+ *
+ * Description: frees every block and leaves the arena empty, ready to be used again.
+ ***********************************************************************************************************************/
+void freeArena(struct Arena* arena) {
+    struct ArenaBlock* block = arena->blocks;
+    while (block != NULL) {
+        struct ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+    arena->used = 0;
+    arena->size = 0;
+}
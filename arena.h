@@ -0,0 +1,54 @@
+/******************************************************************************
+ * NAME
+ *   arena.h
+ *
+ * DESCRIPTION
+ *   Header file for the arena (bump) allocator used for memory that is
+ *   allocated piece by piece and released all at once: the connections read
+ *   while the graph is built, and the scratch arrays of a batch of clients.
+ *
+ * COMMENTS
+ *   An allocation moves a pointer forward in the current block; a block that
+ *   is full is followed by one at least twice as large. Nothing is freed on
+ *   its own: resetArena() forgets every allocation, keeping one block as
+ *   large as all the blocks used, so a caller that allocates the same amount
+ *   again does it in that single block, and freeArena() releases the blocks.
+ *   An arena is not thread safe.
+ *
+ ******************************************************************************/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Alignment of every allocation
+#define ARENA_ALIGN 16
+// Size of the first block when the arena was created without one
+#define ARENA_BLOCK_SIZE (1 << 16)
+
+struct ArenaBlock;
+
+// Blocks of memory handed out front to back
+struct Arena {
+    struct ArenaBlock* blocks;  // newest first
+    size_t used;                // bytes handed out from the newest block
+    size_t size;                // bytes in the newest block
+};
+
+// Initializes an arena with a first block of size bytes (none if 0); returns 0 if it cannot be allocated
+int initArena(struct Arena* arena, size_t size);
+
+// Bytes initArena() needs for count elements of elementSize bytes allocated by one arenaAlloc()
+size_t arenaBytes(size_t count, size_t elementSize);
+
+// Returns bytes of memory aligned to ARENA_ALIGN, valid until the arena is reset or freed; exits if memory runs out
+void* arenaAlloc(struct Arena* arena, size_t bytes);
+
+// Forgets every allocation
+void resetArena(struct Arena* arena);
+
+// Frees every block of the arena
+void freeArena(struct Arena* arena);
+
+#endif
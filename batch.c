@@ -0,0 +1,828 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: batch.c
+* Description: Groups the clients of a batch by the search they need, solves each group with one search (on one or
+*              more threads) and writes the results in the original client order.
+*/
+
+#include "batch.h"
+#include "processFiles.h"
+#include "threadpool.h"
+#include "bidirectional.h"
+#include "csa.h"
+#include "landmarks.h"
+#include "hierarchy.h"
+#include "rcsp.h"
+#include "profile.h"
+#include "allpairs.h"
+#include "cache.h"
+#include "subgraph.h"
+#include "timer.h"
+#include "arena.h"
+#include <string.h>
+#include <stdlib.h>
+
+// Minimum number of clients handed to one thread pool task
+#define CLIENTS_PER_TASK 64
+// Clients handed to one task answering from the cost table
+#define TABLE_CLIENTS_PER_TASK 4096
+
+// Everything that determines the search tree a client needs
+struct SearchKey {
+    int valid;              // 0 if a city does not exist (answered with -1, no search)
+    int startCity;
+    int costFilter;
+    uint64_t allowedTransports;
+    int excludedTransport;  // see compile_restrictions()
+    int maxDuration;        // -1 without A2
+    int maxCost;            // -1 without A3
+    int departureTime;      // 0 for cost queries: the cost tree does not depend on it
+    int budgeted;           // 1 if the client has B1 or B2 and the budget-aware engine answers it
+    int profile;            // 1 if its group is answered by a profile sweep, which ignores departureTime
+    int index;              // position of the client in the batch
+};
+
+// How a group is answered
+#define GROUP_INVALID 0         // a city outside the map: -1 without a search
+#define GROUP_RCSP 1            // each client by the budget-aware engine
+#define GROUP_HIERARCHY 2       // each client from the contraction hierarchy
+#define GROUP_ALT 3             // single cost query, A* with landmarks
+#define GROUP_BIDIRECTIONAL 4   // single cost query, bidirectional Dijkstra
+#define GROUP_CSA 5             // one connection scan for the whole group
+#define GROUP_DIJKSTRA 6        // one Dijkstra search for the whole group
+#define GROUP_PROFILE 7         // duration queries of one start city at several departure times, one profile sweep
+
+// State shared by the workers of a batch
+struct Batch {
+    const struct Graph* graph;
+    const struct Indexes* indexes;
+    const struct RunOptions* options;
+    struct Workspace** workspaces;      // one per worker thread
+    struct Client* clients;
+    int numClients;
+    int* pending;                       // clients that need a search (all of them without a result cache)
+    int numPending;
+    int* order;                         // client indices sorted by search key
+    int* targets;                       // targets[k] = end city of client order[k]
+    int* groupStart;                    // group g is order[groupStart[g]] .. order[groupStart[g + 1] - 1]
+    int numGroups;
+    const struct Subgraph** views;      // per group: subgraph view its Dijkstra search runs on, or NULL
+    char* profileGroup;                 // per group: 1 if it is answered by a profile sweep
+    int* taskStart;                     // task t solves groups taskStart[t] .. taskStart[t + 1] - 1
+    int numTasks;
+    struct CostTable* table;            // all-pairs cost table, NULL without
+    char* fromTable;                    // per client: 1 if it is answered from the table (NULL without a table)
+    int* tableOrder;                    // the clients answered from the table, by start city
+    int numTable;
+    int numTableTasks;                  // task numTasks + t answers tableOrder[t * TABLE_CLIENTS_PER_TASK ..]
+    struct SolBuffer* buffers;          // one per task
+    struct SolBuffer found;             // lines found in the result cache or copied from a repeated question
+    int* lineTask;                      // per client: task whose buffer holds its line, -1 for the found buffer
+    size_t* lineOffset;                 // per client: position and length of its line in that buffer
+    size_t* lineLength;
+    struct QueryStats* queries;         // per client: time and counters of its group, filled if not NULL
+    struct Arena* scratch;              // the arrays above, released together when the batch ends
+};
+
+/***********************************************************************************************************************
+ * validClient()
+ *
+ * Arguments: graph - map graph
+ *            client - client request
+ * Returns: true if both cities exist
+ * Side-Effects: none
+ *
+ * Description: clients with a city outside the map are answered with -1 without a search.
+ ***********************************************************************************************************************/
+static bool validClient(const struct Graph* graph, const struct Client* client) {
+    return client->startCity > 0 && client->endCity > 0 && client->startCity <= graph->numCities && client->endCity <= graph->numCities;
+}
+
+/***********************************************************************************************************************
+ * makeKey()
+ *
+ * Arguments: graph - map graph
+ *            client - client request
+ *            index - position of the client in the batch
+ *            budgetAware - true if clients with B1 or B2 are answered by the budget-aware engine
+ * Returns: search key of the client
+ * Side-Effects: none
+ *
+ * Description: normalizes the fields that influence the search tree. B1/B2 are only checked after the search and
+ *              the departure time only matters in duration mode, so they are left out. With the budget-aware
+ *              engine, clients with a budget are kept apart from those without one.
+ ***********************************************************************************************************************/
+static struct SearchKey makeKey(const struct Graph* graph, const struct Client* client, int index, bool budgetAware) {
+    struct SearchKey key;
+    memset(&key, 0, sizeof(key));
+    key.index = index;
+    key.valid = validClient(graph, client);
+    if (!key.valid) return key;
+
+    key.startCity = client->startCity;
+    key.costFilter = strcmp(client->filter, "cost") == 0;
+    key.allowedTransports = client->restrictions.allowedTransports;
+    key.excludedTransport = client->restrictions.excludedTransport;
+    key.maxDuration = client->restrictions.A2 ? client->restrictions.maxDuration : -1;
+    key.maxCost = client->restrictions.A3 ? client->restrictions.maxCost : -1;
+    key.departureTime = key.costFilter ? 0 : client->departureTime;
+    key.budgeted = budgetAware && (client->restrictions.B1 || client->restrictions.B2);
+    return key;
+}
+
+/***********************************************************************************************************************
+ * compareSearch()
+ *
+ * Arguments: a, b - search keys
+ * Returns: negative, zero or positive as in strcmp; zero if both clients can share one search
+ * Side-Effects: none
+ *
+ * Description: orders keys by the search they need, ignoring the client position. Invalid clients never share. The
+ *              edge filters come first so the searches of one restriction profile are solved one after another, and
+ *              the departure time last so the clients a profile sweep could answer are consecutive.
+ ***********************************************************************************************************************/
+static int compareSearch(const struct SearchKey* a, const struct SearchKey* b) {
+    if (a->valid != b->valid) return a->valid - b->valid;
+    if (!a->valid) return (a->index > b->index) - (a->index < b->index);
+    if (a->allowedTransports != b->allowedTransports) return a->allowedTransports < b->allowedTransports ? -1 : 1;
+    if (a->excludedTransport != b->excludedTransport) return a->excludedTransport < b->excludedTransport ? -1 : 1;
+    if (a->maxDuration != b->maxDuration) return a->maxDuration < b->maxDuration ? -1 : 1;
+    if (a->maxCost != b->maxCost) return a->maxCost < b->maxCost ? -1 : 1;
+    if (a->startCity != b->startCity) return a->startCity < b->startCity ? -1 : 1;
+    if (a->costFilter != b->costFilter) return a->costFilter - b->costFilter;
+    if (a->budgeted != b->budgeted) return a->budgeted - b->budgeted;
+    if (a->profile && b->profile) return 0;
+    if (a->departureTime != b->departureTime) return a->departureTime < b->departureTime ? -1 : 1;
+    return 0;
+}
+
+/***********************************************************************************************************************
+ * sameProfile()
+ *
+ * Arguments: a, b - restrictions of two clients
+ * Returns: true if they allow the same connections
+ * Side-Effects: none
+ *
+ * Description: compares the A1/A2/A3 filters as makeKey() normalizes them.
+ ***********************************************************************************************************************/
+static bool sameProfile(const struct Restrictions* a, const struct Restrictions* b) {
+    return a->allowedTransports == b->allowedTransports && a->excludedTransport == b->excludedTransport && (a->A2 ? a->maxDuration : -1) == (b->A2 ? b->maxDuration : -1) &&
+           (a->A3 ? a->maxCost : -1) == (b->A3 ? b->maxCost : -1);
+}
+
+/***********************************************************************************************************************
+ * compareKeys()
+ *
+ * Arguments: a, b - pointers to search keys
+ * Returns: qsort ordering: by search, then by client position
+ * Side-Effects: none
+ *
+ * Description: qsort comparator; the position tie-break keeps the clients of a group in batch order.
+ ***********************************************************************************************************************/
+static int compareKeys(const void* a, const void* b) {
+    const struct SearchKey* x = a;
+    const struct SearchKey* y = b;
+    int result = compareSearch(x, y);
+    if (result != 0) return result;
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+/***********************************************************************************************************************
+ * compareMinutes()
+ *
+ * Arguments: a, b - pointers to search keys
+ * Returns: qsort ordering: latest departure minute of the day first, then by client position
+ * Side-Effects: none
+ *
+ * Description: the order in which a profile sweep answers its clients.
+ ***********************************************************************************************************************/
+static int compareMinutes(const void* a, const void* b) {
+    const struct SearchKey* x = a;
+    const struct SearchKey* y = b;
+    int minuteX = x->departureTime % 1440;
+    int minuteY = y->departureTime % 1440;
+    if (minuteX != minuteY) return minuteX < minuteY ? 1 : -1;
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+/***********************************************************************************************************************
+ * markProfiles()
+ *
+ * Arguments: keys - search keys sorted by compareKeys()
+ *            n - number of keys
+ * Returns: void
+ * Side-Effects: sets the profile flag of the keys answered by a sweep and sorts each of their runs by compareMinutes()
+ *
+ * Description: duration queries that only differ by their departure time are consecutive. When there are at least
+ *              PROFILE_MIN_CLIENTS of them, not all leaving at the same time, they become one group answered by a
+ *              profile sweep. Queries leaving before time 0 and those of the budget-aware engine are left out.
+ ***********************************************************************************************************************/
+static void markProfiles(struct SearchKey* keys, int n) {
+    for (int start = 0; start < n; ) {
+        int end = start + 1;
+        const struct SearchKey* first = &keys[start];
+        bool eligible = first->valid && !first->costFilter && !first->budgeted && first->departureTime >= 0;
+        while (end < n && eligible) {
+            struct SearchKey next = keys[end];
+            next.departureTime = first->departureTime;
+            if (compareSearch(first, &next) != 0) break;
+            end++;
+        }
+        if (eligible && end - start >= PROFILE_MIN_CLIENTS && keys[end - 1].departureTime != first->departureTime) {
+            for (int k = start; k < end; k++) keys[k].profile = 1;
+            qsort(keys + start, end - start, sizeof(struct SearchKey), compareMinutes);
+        }
+        start = end;
+    }
+}
+
+/***********************************************************************************************************************
+ * buildGroups()
+ *
+ * Arguments: batch - batch with graph and clients set
+ * Returns: void
+ * Side-Effects: allocates order, targets, groupStart, profileGroup and taskStart from the batch's arena and fills them
+ *
+ * Description: sorts the pending clients by search key, cuts the sorted list into groups of clients that share a search
+ *              (or a profile sweep), then packs consecutive groups into tasks of at least CLIENTS_PER_TASK clients.
+ ***********************************************************************************************************************/
+static void buildGroups(struct Batch* batch) {
+    int n = batch->numPending;
+    struct SearchKey* keys = arenaAlloc(batch->scratch, n * sizeof(struct SearchKey));
+    batch->order = arenaAlloc(batch->scratch, n * sizeof(int));
+    batch->targets = arenaAlloc(batch->scratch, n * sizeof(int));
+    batch->groupStart = arenaAlloc(batch->scratch, (n + 1) * sizeof(int));
+    batch->profileGroup = arenaAlloc(batch->scratch, n);
+    batch->taskStart = arenaAlloc(batch->scratch, (n + 1) * sizeof(int));
+
+    for (int i = 0; i < n; i++) {
+        int client = batch->pending[i];
+        keys[i] = makeKey(batch->graph, &batch->clients[client], client, (batch->options->engines & ENGINE_RCSP) != 0);
+    }
+    qsort(keys, n, sizeof(struct SearchKey), compareKeys);
+    markProfiles(keys, n);
+
+    batch->numGroups = 0;
+    for (int k = 0; k < n; k++) {
+        batch->order[k] = keys[k].index;
+        batch->targets[k] = batch->clients[keys[k].index].endCity;
+        if (k == 0 || compareSearch(&keys[k - 1], &keys[k]) != 0) {
+            batch->profileGroup[batch->numGroups] = (char)keys[k].profile;
+            batch->groupStart[batch->numGroups++] = k;
+        }
+    }
+    batch->groupStart[batch->numGroups] = n;
+
+    batch->numTasks = 0;
+    for (int g = 0; g < batch->numGroups; ) {
+        int first = g;
+        batch->taskStart[batch->numTasks++] = g;
+        while (g < batch->numGroups && batch->groupStart[g] - batch->groupStart[first] < CLIENTS_PER_TASK) {
+            g++;
+        }
+    }
+    batch->taskStart[batch->numTasks] = batch->numGroups;
+}
+
+/***********************************************************************************************************************
+ * groupEngine()
+ *
+ * Arguments: batch - pointer to the batch
+ *            group - index of the group
+ * Returns: GROUP_* engine that answers the group
+ * Side-Effects: none
+ *
+ * Description: groups made for a profile sweep (see markProfiles()) are answered by it. Clients with a B1 or B2
+ *              budget go to the budget-aware engine when it is enabled. Cost queries without filters are answered
+ *              from the contraction hierarchy when it is loaded, and a group with a single cost query uses A* with
+ *              landmarks or the bidirectional engine when one of them is enabled. Duration groups scan the timetable
+ *              when it has been built. Everything else runs Dijkstra.
+ ***********************************************************************************************************************/
+static int groupEngine(const struct Batch* batch, int group) {
+    int first = batch->groupStart[group];
+    int last = batch->groupStart[group + 1];
+    const struct Client* leader = &batch->clients[batch->order[first]];
+
+    if (!validClient(batch->graph, leader)) return GROUP_INVALID;
+    bool single = last - first == 1 && strcmp(leader->filter, "cost") == 0;
+    if (batch->profileGroup[group]) return GROUP_PROFILE;
+    if ((batch->options->engines & ENGINE_RCSP) && (leader->restrictions.B1 || leader->restrictions.B2)) return GROUP_RCSP;
+    if (batch->indexes->hierarchy != NULL && hierarchyEligible(batch->graph, leader)) return GROUP_HIERARCHY;
+    if (single && batch->indexes->landmarks != NULL) return GROUP_ALT;
+    if (single && (batch->options->engines & ENGINE_BIDIRECTIONAL)) return GROUP_BIDIRECTIONAL;
+    if (batch->indexes->timetable != NULL && strcmp(leader->filter, "cost") != 0 && leader->departureTime >= 0) return GROUP_CSA;
+    return GROUP_DIJKSTRA;
+}
+
+/***********************************************************************************************************************
+ * solveGroup()
+ *
+ * Arguments: batch - pointer to the batch
+ *            ws - workspace of the calling thread
+ *            group - index of the group
+ *            task - index of the task the group belongs to
+ * Returns: void
+ * Side-Effects: appends one line per client to the task's buffer and records where each line starts
+ *
+ * Description: runs the engine chosen by groupEngine(). Dijkstra and the connection scan run one search from the
+ *              group's start city that stops once every client's end city is settled, then extract each client's
+ *              path from the shared predecessor tree; Dijkstra searches the group's subgraph view when it has one.
+ *              A profile group searches every minute of the day from the latest down to the earliest departure
+ *              minute of its clients, and answers the clients of a minute right after its search; a client whose
+ *              path Dijkstra could write differently is searched again with it. The other engines answer their
+ *              clients one by one.
+ ***********************************************************************************************************************/
+static void solveGroup(struct Batch* batch, struct Workspace* ws, int group, int task) {
+    int first = batch->groupStart[group];
+    int last = batch->groupStart[group + 1];
+    struct SolBuffer* output = &batch->buffers[task];
+    struct Client* leader = &batch->clients[batch->order[first]];
+    int engine = groupEngine(batch, group);
+
+    if (engine == GROUP_RCSP || engine == GROUP_HIERARCHY) {
+        for (int k = first; k < last; k++) {
+            int i = batch->order[k];
+            batch->lineTask[i] = task;
+            batch->lineOffset[i] = output->length;
+            if (engine == GROUP_RCSP) rcsp_query(batch->graph, ws, &batch->clients[i], output);
+            else hierarchy_query(batch->graph, ws, batch->indexes->hierarchy, &batch->clients[i], output);
+            batch->lineLength[i] = output->length - batch->lineOffset[i];
+        }
+        return;
+    }
+    if (engine == GROUP_PROFILE) {
+        startProfile(ws);
+        int minute = 1440;
+        for (int k = first; k < last; k++) {
+            int i = batch->order[k];
+            struct Client* client = &batch->clients[i];
+            while (minute > client->departureTime % 1440) {
+                profile_search(batch->graph, ws, leader->restrictions, leader->startCity, --minute, &batch->targets[first], last - first);
+            }
+            batch->lineTask[i] = task;
+            batch->lineOffset[i] = output->length;
+            if (!write_profile(batch->graph, ws, client, output)) {
+                dijkstra_search(batch->graph, ws, client->restrictions, client->startCity, client->departureTime, client->filter, &batch->targets[k], 1);
+                write_result(batch->graph, ws, client, output);
+            }
+            batch->lineLength[i] = output->length - batch->lineOffset[i];
+        }
+        return;
+    }
+    if (engine == GROUP_ALT || engine == GROUP_BIDIRECTIONAL) {
+        int i = batch->order[first];
+        batch->lineTask[i] = task;
+        batch->lineOffset[i] = output->length;
+        if (engine == GROUP_ALT) {
+            alt_search(batch->graph, ws, batch->indexes->landmarks, leader->restrictions, leader->startCity, leader->endCity);
+            write_result(batch->graph, ws, leader, output);
+        } else {
+            bidirectional_dijkstra(batch->graph, ws, leader, output);
+        }
+        batch->lineLength[i] = output->length - batch->lineOffset[i];
+        return;
+    }
+    if (engine == GROUP_CSA) {
+        if (!csa_search(batch->graph, ws, batch->indexes->timetable, leader->restrictions, leader->startCity, leader->departureTime, &batch->targets[first], last - first)) {
+            dijkstra_search(batch->graph, ws, leader->restrictions, leader->startCity, leader->departureTime, leader->filter, &batch->targets[first], last - first);
+        }
+    } else if (engine == GROUP_DIJKSTRA) {
+        const struct Subgraph* view = batch->views != NULL ? batch->views[group] : NULL;
+        dijkstra_search_view(batch->graph, view, ws, leader->restrictions, leader->startCity, leader->departureTime, leader->filter, &batch->targets[first], last - first);
+    }
+
+    for (int k = first; k < last; k++) {
+        int i = batch->order[k];
+        struct Client* client = &batch->clients[i];
+        batch->lineTask[i] = task;
+        batch->lineOffset[i] = output->length;
+        if (engine != GROUP_INVALID) {
+            // In case of restriction violation, print "<clientID> -1"
+            write_result(batch->graph, ws, client, output);
+        } else {
+            solPutInt(output, client->clientID, ' ');
+            solPutInt(output, -1, '\n');
+        }
+        batch->lineLength[i] = output->length - batch->lineOffset[i];
+    }
+}
+
+/***********************************************************************************************************************
+ * answerTable()
+ *
+ * Arguments: batch - pointer to the batch
+ *            ws - workspace of the calling thread
+ *            task - index of the task, at least batch->numTasks
+ * Returns: void
+ * Side-Effects: appends one line per client of the task to the task's buffer and records where each line starts
+ *
+ * Description: TABLE_CLIENTS_PER_TASK clients answered from the cost table, taken by start city so the row being
+ *              walked stays in cache, each timed alone when per client measurements are wanted.
+ ***********************************************************************************************************************/
+static void answerTable(struct Batch* batch, struct Workspace* ws, int task) {
+    struct SolBuffer* output = &batch->buffers[task];
+    int first = (task - batch->numTasks) * TABLE_CLIENTS_PER_TASK;
+    int last = first + TABLE_CLIENTS_PER_TASK < batch->numTable ? first + TABLE_CLIENTS_PER_TASK : batch->numTable;
+
+    for (int k = first; k < last; k++) {
+        int i = batch->tableOrder[k];
+        long long start = batch->queries != NULL ? nowNanoseconds() : 0;
+        batch->lineTask[i] = task;
+        batch->lineOffset[i] = output->length;
+        write_table(batch->graph, batch->table, ws, &batch->clients[i], output);
+        batch->lineLength[i] = output->length - batch->lineOffset[i];
+        if (batch->queries != NULL) {
+            batch->queries[i].nanoseconds = nowNanoseconds() - start;
+            batch->queries[i].groupSize = 1;
+            batch->queries[i].counters = (struct SearchCounters){ 0, 0, 0, 0, 0, 0, 0 };
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ * solveTask()
+ *
+ * Arguments: context - pointer to the batch
+ *            task - index of the task
+ *            thread - index of the worker running the task
+ * Returns: void
+ * Side-Effects: fills the task's buffer
+ *
+ * Description: thread pool task: solves a run of consecutive groups with the worker's own workspace, timing each
+ *              group and collecting its counters when per client measurements are wanted. The tasks numbered after
+ *              those of the groups answer clients from the cost table (see answerTable()).
+ ***********************************************************************************************************************/
+static void solveTask(void* context, int task, int thread) {
+    struct Batch* batch = context;
+    if (task >= batch->numTasks) {
+        answerTable(batch, batch->workspaces[thread], task);
+        return;
+    }
+    for (int g = batch->taskStart[task]; g < batch->taskStart[task + 1]; g++) {
+        if (batch->queries == NULL) {
+            solveGroup(batch, batch->workspaces[thread], g, task);
+            continue;
+        }
+        struct SearchCounters counters = { 0, 0, 0, 0, 0, 0, 0 };
+        int groupSize = batch->groupStart[g + 1] - batch->groupStart[g];
+
+        long long start = nowNanoseconds();
+        solveGroup(batch, batch->workspaces[thread], g, task);
+        long long share = (nowNanoseconds() - start) / groupSize;
+        takeCounters(batch->workspaces[thread], &counters);
+
+        for (int k = batch->groupStart[g]; k < batch->groupStart[g + 1]; k++) {
+            struct QueryStats* query = &batch->queries[batch->order[k]];
+            query->nanoseconds = share;
+            query->groupSize = groupSize;
+            query->counters = counters;
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ * findCached()
+ *
+ * Arguments: batch - batch with clients, cache and buffers set
+ *            cache - result cache
+ *            keys - set to the cache key of each client
+ *            source - set for each client: -1 if it needs a search, -2 if its line was found in the cache, -3 if it is
+ *                     answered from the cost table, or the earlier client of the batch that asks the same question
+ * Returns: void
+ * Side-Effects: fills batch->pending, writes the lines found in the cache to the found buffer
+ *
+ * Description: a question asked twice in the batch is searched once; the table of questions asked so far is open
+ *              addressed, with at least twice as many slots as clients. Clients of the cost table are not looked up:
+ *              their line costs less to write than to find.
+ ***********************************************************************************************************************/
+static void findCached(struct Batch* batch, struct ResultCache* cache, struct CacheKey* keys, int* source) {
+    int n = batch->numClients;
+    struct SolBuffer* found = &batch->found;
+    bool budgetAware = (batch->options->engines & ENGINE_RCSP) != 0;
+
+    int numSlots = 16;
+    while (numSlots < 2 * n) numSlots *= 2;
+    int* slots = arenaAlloc(batch->scratch, numSlots * sizeof(int));
+    for (int s = 0; s < numSlots; s++) slots[s] = -1;
+
+    batch->numPending = 0;
+    for (int i = 0; i < n; i++) {
+        struct Client* client = &batch->clients[i];
+        source[i] = -1;
+        if (batch->fromTable != NULL && batch->fromTable[i]) {
+            source[i] = -3;
+            continue;
+        }
+        if (!validClient(batch->graph, client)) {
+            batch->pending[batch->numPending++] = i;
+            continue;
+        }
+        resultKey(client, budgetAware, &keys[i]);
+
+        int s = hashResultKey(&keys[i]) & (numSlots - 1);
+        while (slots[s] >= 0 && !sameResultKey(&keys[slots[s]], &keys[i])) s = (s + 1) & (numSlots - 1);
+        if (slots[s] >= 0) {
+            source[i] = slots[s];
+            cache->hits++;
+            continue;
+        }
+
+        int length;
+        const char* text = lookupResult(cache, &keys[i], &length);
+        if (text != NULL) {
+            source[i] = -2;
+            batch->lineTask[i] = -1;
+            batch->lineOffset[i] = found->length;
+            solPutInt(found, client->clientID, ' ');
+            solAppend(found, text + 1, length - 1);
+            batch->lineLength[i] = found->length - batch->lineOffset[i];
+        } else {
+            slots[s] = i;
+            batch->pending[batch->numPending++] = i;
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ * storeSearched()
+ *
+ * Arguments: batch - solved batch
+ *            cache - result cache
+ *            keys - cache key of each client
+ *            source - origin of each client's line, as set by findCached()
+ * Returns: void
+ * Side-Effects: stores the lines searched in the cache, writes the lines of repeated questions to the found buffer
+ *
+ * Description: a line is stored without the client identifier, which is the text up to its first space.
+ ***********************************************************************************************************************/
+static void storeSearched(struct Batch* batch, struct ResultCache* cache, const struct CacheKey* keys, const int* source) {
+    struct SolBuffer* found = &batch->found;
+
+    for (int i = 0; i < batch->numClients; i++) {
+        if (source[i] == -1 && validClient(batch->graph, &batch->clients[i])) {
+            const char* line = batch->buffers[batch->lineTask[i]].data + batch->lineOffset[i];
+            const char* text = memchr(line, ' ', batch->lineLength[i]);
+            storeResult(cache, &keys[i], text, (int)(batch->lineLength[i] - (text - line)));
+        }
+    }
+    for (int i = 0; i < batch->numClients; i++) {
+        if (source[i] < 0) continue;
+        int j = source[i];
+        const char* line = batch->buffers[batch->lineTask[j]].data + batch->lineOffset[j];
+        const char* text = memchr(line, ' ', batch->lineLength[j]);
+        size_t length = batch->lineLength[j] - (text - line);
+        batch->lineTask[i] = -1;
+        batch->lineOffset[i] = found->length;
+        solPutInt(found, batch->clients[i].clientID, ' ');
+        solAppend(found, text + 1, length - 1);
+        batch->lineLength[i] = found->length - batch->lineOffset[i];
+    }
+}
+
+/***********************************************************************************************************************
+ * createWorkspaces()
+ *
+ * Arguments: graph - map graph
+ *            options - run options (number of threads, priority queue)
+ * Returns: one workspace per thread, using the priority queue of the options
+ * Side-Effects: allocates dynamic memory, exits if memory runs out
+ *
+ * Description: made for each batch, or once by a caller that solves many batches (see struct Caches).
+ ***********************************************************************************************************************/
+struct Workspace** createWorkspaces(const struct Graph* graph, const struct RunOptions* options) {
+    int numThreads = options->numThreads > 1 ? options->numThreads : 1;
+    struct Workspace** workspaces = malloc(numThreads * sizeof(struct Workspace*));
+    if (workspaces == NULL) exit(0);
+    int maxStep = options->queue != QUEUE_BINARY ? graphMaxStep(graph) : 0;
+    int queue = chooseQueue(options->queue, maxStep);
+    for (int t = 0; t < numThreads; t++) {
+        workspaces[t] = createWorkspace(graph->numCities);
+        if (queue != QUEUE_BINARY) setWorkspaceQueue(workspaces[t], queue, maxStep);
+    }
+    return workspaces;
+}
+
+/***********************************************************************************************************************
+ * freeWorkspaces()
+ *
+ * Arguments: workspaces - array made by createWorkspaces()
+ *            options - the same run options
+ * Returns: void
+ * Side-Effects: frees dynamically allocated memory
+ *
+ * Description: frees every workspace and the array.
+ ***********************************************************************************************************************/
+void freeWorkspaces(struct Workspace** workspaces, const struct RunOptions* options) {
+    int numThreads = options->numThreads > 1 ? options->numThreads : 1;
+    for (int t = 0; t < numThreads; t++) {
+        freeWorkspace(workspaces[t]);
+    }
+    free(workspaces);
+}
+
+/***********************************************************************************************************************
+ * markTable()
+ *
+ * Arguments: batch - batch with clients, workspaces and cost table set
+ *            numThreads - number of worker threads
+ * Returns: void
+ * Side-Effects: allocates fromTable and tableOrder from the batch's arena and fills them, builds the rows the batch
+ *               needs, sets numTable and numTableTasks
+ *
+ * Description: the clients accepted by costTableEligible() are answered from the table and are neither looked up in
+ *              the result cache nor grouped. A counting sort puts them in order of start city (in batch order for
+ *              each city), and the rows of their start cities that earlier batches did not build are built first,
+ *              on the worker threads.
+ ***********************************************************************************************************************/
+static void markTable(struct Batch* batch, int numThreads) {
+    int n = batch->numClients;
+    int cities = batch->graph->numCities;
+    bool budgetAware = (batch->options->engines & ENGINE_RCSP) != 0;
+    int* count = arenaAlloc(batch->scratch, (cities + 1) * sizeof(int));
+    memset(count, 0, (cities + 1) * sizeof(int));
+
+    batch->fromTable = arenaAlloc(batch->scratch, n);
+    batch->numTable = 0;
+    for (int i = 0; i < n; i++) {
+        batch->fromTable[i] = (char)costTableEligible(batch->graph, &batch->clients[i], budgetAware);
+        if (batch->fromTable[i]) {
+            count[batch->clients[i].startCity]++;
+            batch->numTable++;
+        }
+    }
+
+    int* starts = arenaAlloc(batch->scratch, cities * sizeof(int));
+    int numStarts = 0, position = 0;
+    for (int city = 1; city <= cities; city++) {
+        if (count[city] > 0 && batch->table->rows[city - 1] == NULL) starts[numStarts++] = city;
+        int size = count[city];
+        count[city] = position;
+        position += size;
+    }
+    batch->tableOrder = arenaAlloc(batch->scratch, batch->numTable * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        if (batch->fromTable[i]) batch->tableOrder[count[batch->clients[i].startCity]++] = i;
+    }
+
+    fillCostTable(batch->table, batch->graph, batch->workspaces, numThreads, starts, numStarts);
+    batch->numTableTasks = (batch->numTable + TABLE_CLIENTS_PER_TASK - 1) / TABLE_CLIENTS_PER_TASK;
+}
+
+/***********************************************************************************************************************
+ * scratchBytes()
+ *
+ * Arguments: numClients - number of clients of the batch
+ *            cached - true if the batch looks its clients up in a result cache
+ *            table - true if the batch answers clients from the cost table
+ * Returns: bytes of the arrays solveBatch() allocates for them
+ * Side-Effects: none
+ *
+ * Description: the per client arrays, with one group and one task per client at most, so a batch without a result
+ *              cache never needs a second arena block (the cache's slot table, the views and the per city arrays of
+ *              the cost table are not counted).
+ ***********************************************************************************************************************/
+static size_t scratchBytes(int numClients, bool cached, bool table) {
+    size_t bytes = 4 * arenaBytes(numClients, sizeof(int)) + 2 * arenaBytes(numClients, sizeof(size_t)) +
+                   2 * arenaBytes(numClients + 1, sizeof(int)) + arenaBytes(numClients, sizeof(struct SearchKey)) +
+                   arenaBytes(numClients, sizeof(struct SolBuffer)) + arenaBytes(numClients, 1);
+    if (cached) bytes += arenaBytes(numClients, sizeof(struct CacheKey)) + arenaBytes(numClients, sizeof(int));
+    if (table) {
+        int numTableTasks = (numClients + TABLE_CLIENTS_PER_TASK - 1) / TABLE_CLIENTS_PER_TASK;
+        bytes += arenaBytes(numClients, sizeof(int)) + arenaBytes(numClients, 1) + arenaBytes(numTableTasks, sizeof(struct SolBuffer));
+    }
+    return bytes;
+}
+
+/***********************************************************************************************************************
+ * solveBatch()
+ *
+ * Arguments: graph - map graph
+ *            indexes - preprocessed data of the optional engines
+ *            caches - result and subgraph caches (NULL members are not used)
+ *            clients - clients of the batch
+ *            numClients - number of clients
+ *            options - run options (number of threads, priority queue)
+ *            output - output file
+ *            queries - per client measurements, filled if not NULL (clients sharing a search split its time)
+ * Returns: 1 if every line was written, 0 if writing to the output file failed
+ * Side-Effects: creates threads if options->numThreads > 1 and there is more than one task, writes the results to the
+ *               output file
+ *
+ * Description: with a result cache, the clients whose question was answered before, in this batch or an earlier
+ *              one, are not searched. The others are grouped, the groups are solved serially or on a work-stealing
+ *              thread pool with one workspace per thread, and every line is written in client order so the file
+ *              does not depend on the grouping, on the number of threads or on the caches. Subgraph views are
+ *              looked up (and built) before the workers start, so the workers only read them. The lines are gathered in
+ *              client order and written SOL_FLUSH_SIZE bytes at a time. The batch's arrays come from one arena and
+ *              are released together. With a cost table, its clients skip the cache and the grouping and are answered
+ *              by tasks of their own after the groups' (see markTable()).
+ ***********************************************************************************************************************/
+int solveBatch(const struct Graph* graph, const struct Indexes* indexes, const struct Caches* caches, struct Client* clients, int numClients, const struct RunOptions* options, FILE* output, struct QueryStats* queries) {
+    struct Batch batch;
+    int numThreads = options->numThreads > 1 ? options->numThreads : 1;
+    struct ResultCache* cache = caches->results;
+    struct CacheKey* keys = NULL;
+    int* source = NULL;
+    struct Arena arena;
+
+    batch.scratch = caches->scratch;
+    if (batch.scratch == NULL) {
+        if (!initArena(&arena, scratchBytes(numClients, cache != NULL, caches->costs != NULL))) exit(0);
+        batch.scratch = &arena;
+    }
+    batch.graph = graph;
+    batch.indexes = indexes;
+    batch.options = options;
+    batch.queries = queries;
+    batch.clients = clients;
+    batch.numClients = numClients;
+    batch.pending = arenaAlloc(batch.scratch, numClients * sizeof(int));
+    batch.lineTask = arenaAlloc(batch.scratch, numClients * sizeof(int));
+    batch.lineOffset = arenaAlloc(batch.scratch, numClients * sizeof(size_t));
+    batch.lineLength = arenaAlloc(batch.scratch, numClients * sizeof(size_t));
+    initSolBuffer(&batch.found);
+    batch.workspaces = caches->workspaces != NULL ? caches->workspaces : createWorkspaces(graph, options);
+
+    batch.table = caches->costs;
+    batch.fromTable = NULL;
+    batch.numTable = 0;
+    batch.numTableTasks = 0;
+    if (batch.table != NULL) markTable(&batch, numThreads);
+
+    if (cache != NULL) {
+        keys = arenaAlloc(batch.scratch, numClients * sizeof(struct CacheKey));
+        source = arenaAlloc(batch.scratch, numClients * sizeof(int));
+        findCached(&batch, cache, keys, source);
+    } else {
+        batch.numPending = 0;
+        for (int i = 0; i < numClients; i++) {
+            if (batch.fromTable == NULL || !batch.fromTable[i]) batch.pending[batch.numPending++] = i;
+        }
+    }
+    buildGroups(&batch);
+
+    batch.views = NULL;
+    if (caches->subgraphs != NULL) {
+        batch.views = arenaAlloc(batch.scratch, batch.numGroups * sizeof(const struct Subgraph*));
+        startSubgraphBatch(caches->subgraphs);
+        for (int g = 0; g < batch.numGroups; ) {
+            // Groups are sorted by restriction profile, so the groups of a profile are consecutive
+            const struct Restrictions* profile = &clients[batch.order[batch.groupStart[g]]].restrictions;
+            int end = g, searches = 0;
+            for (; end < batch.numGroups && sameProfile(profile, &clients[batch.order[batch.groupStart[end]]].restrictions); end++) {
+                if (groupEngine(&batch, end) == GROUP_DIJKSTRA) searches++;
+            }
+            const struct Subgraph* view = searches > 0 ? findSubgraph(caches->subgraphs, graph, profile, searches) : NULL;
+            for (; g < end; g++) {
+                batch.views[g] = groupEngine(&batch, g) == GROUP_DIJKSTRA ? view : NULL;
+            }
+        }
+    }
+
+    int numTasks = batch.numTasks + batch.numTableTasks;
+    batch.buffers = arenaAlloc(batch.scratch, numTasks * sizeof(struct SolBuffer));
+    for (int i = 0; i < numTasks; i++) {
+        initSolBuffer(&batch.buffers[i]);
+    }
+
+    if (numThreads > 1 && numTasks > 1) {
+        joinThreadPool(startThreadPool(numThreads, numTasks, solveTask, &batch));
+    } else {
+        for (int i = 0; i < numTasks; i++) {
+            solveTask(&batch, i, 0);
+        }
+    }
+
+    if (cache != NULL) {
+        storeSearched(&batch, cache, keys, source);
+        if (queries != NULL) {
+            for (int i = 0; i < numClients; i++) {
+                if (source[i] == -1 || source[i] == -3) continue;
+                queries[i].nanoseconds = 0;
+                queries[i].groupSize = 1;
+                queries[i].counters = (struct SearchCounters){ 0, 0, 0, 0, 0, 0, 0 };
+            }
+        }
+    }
+
+    struct SolBuffer lines;
+    int written = 1;
+    initSolBuffer(&lines);
+    for (int i = 0; i < numClients; i++) {
+        const struct SolBuffer* buffer = batch.lineTask[i] >= 0 ? &batch.buffers[batch.lineTask[i]] : &batch.found;
+        solAppend(&lines, buffer->data + batch.lineOffset[i], batch.lineLength[i]);
+        if (lines.length >= SOL_FLUSH_SIZE) written &= flushSolBuffer(&lines, output);
+    }
+    written &= flushSolBuffer(&lines, output);
+    freeSolBuffer(&lines);
+
+    if (caches->workspaces == NULL) freeWorkspaces(batch.workspaces, options);
+    for (int i = 0; i < numTasks; i++) {
+        freeSolBuffer(&batch.buffers[i]);
+    }
+    freeSolBuffer(&batch.found);
+    if (batch.scratch == &arena) freeArena(&arena);
+    else resetArena(batch.scratch);
+    return written;
+}
@@ -0,0 +1,62 @@
+/******************************************************************************
+ * NAME
+ *   batch.h
+ *
+ * DESCRIPTION
+ *   Header file for solving a whole batch of clients.
+ *
+ * COMMENTS
+ *   Clients that need the same search (same start city, filter and edge
+ *   restrictions, and the same departure time for duration queries) are
+ *   grouped and answered from one shared search tree. Results are written in
+ *   the original client order. Cost queries without filters are answered
+ *   from the all-pairs cost table instead when there is one (see
+ *   allpairs.h).
+ *
+ ******************************************************************************/
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include "dijkstra.h"
+#include "stats.h"
+
+struct RunOptions;
+struct Landmarks;
+struct Hierarchy;
+struct ResultCache;
+struct SubgraphCache;
+struct Arena;
+struct CostTable;
+
+// Preprocessed data used by the optional engines (NULL when not loaded)
+struct Indexes {
+    struct Landmarks* landmarks;        // -e alt
+    struct Hierarchy* hierarchy;        // -e ch
+    struct Timetable* timetable;        // -e csa
+};
+
+// State kept across batches (NULL when disabled)
+struct Caches {
+    struct ResultCache* results;        // --cache
+    struct SubgraphCache* subgraphs;    // --subgraphs
+    struct Workspace** workspaces;      // one per thread with the queue of the options (serve), NULL to create them
+                                        // for each batch
+    struct Arena* scratch;              // arena for the arrays of a batch, reset after each one (serve), NULL to use
+                                        // a new arena sized for each batch
+    struct CostTable* costs;            // all-pairs cost table whose rows are built as start cities are asked for
+                                        // (chosen by processFiles()), NULL to search every cost query
+};
+
+// Creates one workspace per thread of the options, with their priority queue
+struct Workspace** createWorkspaces(const struct Graph* graph, const struct RunOptions* options);
+
+// Frees the workspaces made by createWorkspaces() with the same options
+void freeWorkspaces(struct Workspace** workspaces, const struct RunOptions* options);
+
+// Solves every client and writes the .sol lines in client order; queries (if not NULL) gets each client's measurements;
+// returns 0 if writing failed
+int solveBatch(const struct Graph* graph, const struct Indexes* indexes, const struct Caches* caches, struct Client* clients, int numClients, const struct RunOptions* options, FILE* output, struct QueryStats* queries);
+
+#endif
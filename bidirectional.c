@@ -0,0 +1,156 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: bidirectional.c
+* Description: Bidirectional Dijkstra for cost queries: a forward search from the start city and a backward search
+*              from the end city that stop once their frontiers meet.
+*/
+
+#include "bidirectional.h"
+#include "heap.h"
+#include <string.h>
+
+/***********************************************************************************************************************
+ * label()
+ *
+ * Arguments: ws - search state
+ *            city - city index
+ * Returns: tentative cost of the city in this search, INF if the search has not reached it
+ * Side-Effects: none
+ *
+ * Description: reads a label without initializing the city (the other search must not touch it).
+ ***********************************************************************************************************************/
+static inline int label(const struct Workspace* ws, int city) {
+    return ws->stamp[city] == ws->epoch ? ws->weight[city] : INF;
+}
+
+/***********************************************************************************************************************
+ * expand()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            side - search state being expanded
+ *            other - search state of the opposite direction
+ *            restrictions - structure containing travel restrictions
+ *            best - cost of the best complete path found so far, updated
+ *            meet - city where that path joins both searches, updated
+ * Returns: void
+ * Side-Effects: settles one city of side and relaxes its edges
+ *
+ * Description: one step of either search. Because the graph is symmetric, the backward search walks the same
+ *              outgoing edges as the forward one.
+ ***********************************************************************************************************************/
+static void expand(const struct Graph* graph, struct Workspace* side, const struct Workspace* other, struct Restrictions restrictions, int* best, int* meet) {
+    struct heapNode minNode = extractMin(side->heap, side->heapIndex);
+    int u = minNode.city;
+    side->heapIndex[u] = -2;
+    STAT(side->counters.settled++);
+
+    const struct Edge* edge = graph->edges + graph->offsets[u];
+    const struct Edge* lastEdge = graph->edges + graph->offsets[u + 1];
+    for (; edge < lastEdge; edge++) {
+        int v = edge->destination;
+
+        touchCity(side, v);
+        STAT(side->counters.scanned++);
+        if(!check_restrictions(restrictions, edge)){
+            STAT(side->counters.filtered++);
+            continue;
+        }
+        if(side->heapIndex[v] == -2){
+            continue;
+        }
+
+        int newWeight = side->weight[u] + edge->travelCost;
+        if(side->weight[v] > newWeight){
+            side->weight[v] = newWeight;
+            side->prevCity[v] = u;
+            side->prevEdge[v] = (int)(edge - graph->edges);
+
+            if(side->heapIndex[v] == -1){
+                insertMinHeap(side->heap, v, newWeight, side->heapIndex);
+            } else {
+                decreaseKey(side->heap, v, newWeight, side->heapIndex);
+            }
+
+            int otherWeight = label(other, v);
+            if(otherWeight != INF && newWeight + otherWeight < *best){
+                *best = newWeight + otherWeight;
+                *meet = v;
+            }
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ * bidirectional_dijkstra()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            ws - query workspace; its reverse state holds the backward search
+ *            client - cost query to answer
+ *            output - buffer receiving the .sol line
+ * Returns: void
+ * Side-Effects: appends the result to the output buffer, overwrites both search states of the workspace
+ *
+ * Description: alternates between the search whose next city is closer, and stops when the two smallest tentative
+ *              costs add up to at least the best path found through a city reached by both searches. A1/A2/A3
+ *              filters apply to both directions because both copies of a connection share their attributes. The
+ *              path is the forward tree from the start to the meeting city followed by the backward tree from there
+ *              to the end, and it is written by write_path(), which replays the waiting times.
+ ***********************************************************************************************************************/
+void bidirectional_dijkstra(const struct Graph* graph, struct Workspace* ws, const struct Client* client, struct SolBuffer* output) {
+    struct Workspace* forward = ws;
+    struct Workspace* backward = reverseWorkspace(ws);
+    int s = client->startCity - 1;
+    int t = client->endCity - 1;
+
+    resetWorkspace(forward);
+    resetWorkspace(backward);
+    touchCity(forward, s);
+    touchCity(backward, t);
+    forward->weight[s] = 0;
+    backward->weight[t] = 0;
+    insertMinHeap(forward->heap, s, 0, forward->heapIndex);
+    insertMinHeap(backward->heap, t, 0, backward->heapIndex);
+
+    int best = s == t ? 0 : INF;
+    int meet = s;
+
+    while(!isEmpty(forward->heap) && !isEmpty(backward->heap)) {
+        int forwardTop = minKey(forward->heap, forward->heapIndex);
+        int backwardTop = minKey(backward->heap, backward->heapIndex);
+        if (best != INF && (long long)forwardTop + backwardTop >= best) break;
+
+        if (forwardTop <= backwardTop) {
+            expand(graph, forward, backward, client->restrictions, &best, &meet);
+        } else {
+            expand(graph, backward, forward, client->restrictions, &best, &meet);
+        }
+    }
+
+    if (!check_budget(client->restrictions, client->filter, best)) {
+        solPutInt(output, client->clientID, ' ');
+        solPutInt(output, -1, '\n');
+        return;
+    }
+
+    // Forward half: start -> meet, collected backwards then in place
+    int numHops = 0;
+    for (int v = meet; v != s; v = forward->prevCity[v]) {
+        numHops++;
+    }
+    int count = numHops;
+    for (int v = meet; v != s; v = forward->prevCity[v]) {
+        --count;
+        ws->trip[count] = v;
+        ws->tripEdge[count] = forward->prevEdge[v];
+    }
+
+    // Backward half: the backward tree already points from meet towards the end city
+    for (int v = meet; v != t; v = backward->prevCity[v]) {
+        ws->trip[numHops] = backward->prevCity[v];
+        ws->tripEdge[numHops] = backward->prevEdge[v];
+        numHops++;
+    }
+
+    write_path(graph, ws, numHops, best, client, output);
+}
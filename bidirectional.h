@@ -0,0 +1,23 @@
+/******************************************************************************
+ * NAME
+ *   bidirectional.h
+ *
+ * DESCRIPTION
+ *   Header file for the bidirectional Dijkstra engine used by cost queries.
+ *
+ * COMMENTS
+ *   Every connection is stored in both directions with the same cost, so a
+ *   cost query is a static shortest path problem on a symmetric graph and
+ *   can be searched from both ends at once.
+ *
+ ******************************************************************************/
+
+#ifndef BIDIRECTIONAL_H
+#define BIDIRECTIONAL_H
+
+#include "dijkstra.h"
+
+// Answers one cost query with a bidirectional search and writes its .sol line
+void bidirectional_dijkstra(const struct Graph* graph, struct Workspace* ws, const struct Client* client, struct SolBuffer* output);
+
+#endif
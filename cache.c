@@ -0,0 +1,263 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: cache.c
+* Description: Result cache: hashed .sol lines of answered questions, evicted in least recently used order when the
+*              memory budget is reached.
+*/
+
+#include "cache.h"
+#include <string.h>
+#include <stdlib.h>
+
+/***********************************************************************************************************************
+ * createResultCache()
+ *
+ * Arguments: maxBytes - memory budget of the cache
+ * Returns: pointer to the empty cache
+ * Side-Effects: allocates dynamic memory, exits if memory runs out
+ *
+ * Description: one bucket per CACHE_BYTES_PER_BUCKET bytes of budget, rounded up to a power of two.
+ ***********************************************************************************************************************/
+struct ResultCache* createResultCache(size_t maxBytes) {
+    struct ResultCache* cache = malloc(sizeof(struct ResultCache));
+    if (cache == NULL) exit(0);
+
+    int numBuckets = CACHE_MIN_BUCKETS;
+    while (numBuckets < (1 << 24) && (size_t)numBuckets * CACHE_BYTES_PER_BUCKET < maxBytes) {
+        numBuckets *= 2;
+    }
+    cache->buckets = calloc(numBuckets, sizeof(struct CacheEntry*));
+    if (cache->buckets == NULL) exit(0);
+
+    cache->maxBytes = maxBytes;
+    cache->bytes = sizeof(struct ResultCache) + numBuckets * sizeof(struct CacheEntry*);
+    cache->numBuckets = numBuckets;
+    cache->newest = NULL;
+    cache->oldest = NULL;
+    cache->numEntries = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+    return cache;
+}
+
+/***********************************************************************************************************************
+ * resultKey()
+ *
+ * Arguments: client - client with valid cities
+ *            budgetAware - true if the client is answered by the budget-aware engine when it has B1 or B2
+ *            key - key filled
+ * Returns: void
+ * Side-Effects: none
+ *
+ * Description: keeps the budgets write_result() checks (B2 for cost queries, B1 for duration queries), or both when
+ *              the budget-aware engine answers the client. The default B1 check compares the arrival time, so
+ *              duration queries with B1 keep their whole departure time; the other queries only keep its minute of
+ *              the day, since waiting_time() does not look further.
+ ***********************************************************************************************************************/
+void resultKey(const struct Client* client, bool budgetAware, struct CacheKey* key) {
+    const struct Restrictions* restrictions = &client->restrictions;
+    bool budgeted = budgetAware && (restrictions->B1 || restrictions->B2);
+
+    memset(key, 0, sizeof(struct CacheKey));
+    key->startCity = client->startCity;
+    key->endCity = client->endCity;
+    key->costFilter = strcmp(client->filter, "cost") == 0;
+    key->allowedTransports = restrictions->allowedTransports;
+    key->excludedTransport = restrictions->excludedTransport;
+    key->maxDuration = restrictions->A2 ? restrictions->maxDuration : INF;
+    key->maxCost = restrictions->A3 ? restrictions->maxCost : INF;
+    key->totalDuration = restrictions->B1 && (budgeted || !key->costFilter) ? restrictions->totalDuration : INF;
+    key->totalCost = restrictions->B2 && (budgeted || key->costFilter) ? restrictions->totalCost : INF;
+
+    bool absolute = !key->costFilter && restrictions->B1 && !budgeted;
+    key->departure = client->departureTime >= 0 && !absolute ? client->departureTime % 1440 : client->departureTime;
+}
+
+/***********************************************************************************************************************
+ * hashResultKey()
+ *
+ * Arguments: key - normalized question
+ * Returns: hash of the key
+ * Side-Effects: none
+ *
+ * Description: fnv1a() over the fields, folded to 32 bits.
+ ***********************************************************************************************************************/
+unsigned int hashResultKey(const struct CacheKey* key) {
+    uint64_t fields[10] = { (unsigned int)key->startCity, (unsigned int)key->endCity, (unsigned int)key->costFilter,
+                            (unsigned int)key->departure, key->allowedTransports, (unsigned int)key->excludedTransport,
+                            (unsigned int)key->maxDuration, (unsigned int)key->maxCost, (unsigned int)key->totalDuration,
+                            (unsigned int)key->totalCost };
+    uint64_t hash = fnv1a(FNV_OFFSET, fields, sizeof(fields));
+    return (unsigned int)(hash ^ (hash >> 32));
+}
+
+/***********************************************************************************************************************
+ * sameResultKey()
+ *
+ * Arguments: a, b - normalized questions
+ * Returns: true if they are equal
+ * Side-Effects: none
+ *
+ * Description: field by field comparison.
+ ***********************************************************************************************************************/
+bool sameResultKey(const struct CacheKey* a, const struct CacheKey* b) {
+    return a->startCity == b->startCity && a->endCity == b->endCity && a->costFilter == b->costFilter &&
+           a->departure == b->departure && a->allowedTransports == b->allowedTransports &&
+           a->excludedTransport == b->excludedTransport && a->maxDuration == b->maxDuration &&
+           a->maxCost == b->maxCost && a->totalDuration == b->totalDuration && a->totalCost == b->totalCost;
+}
+
+/***********************************************************************************************************************
+ * unlinkRecency()
+ *
+ * Arguments: cache - result cache
+ *            entry - entry in the recency list
+ * Returns: void
+ * Side-Effects: removes the entry from the recency list
+ *
+ * Description: doubly linked list removal.
+ ***********************************************************************************************************************/
+static void unlinkRecency(struct ResultCache* cache, struct CacheEntry* entry) {
+    if (entry->newer != NULL) entry->newer->older = entry->older;
+    else cache->newest = entry->older;
+    if (entry->older != NULL) entry->older->newer = entry->newer;
+    else cache->oldest = entry->newer;
+}
+
+/***********************************************************************************************************************
+ * pushNewest()
+ *
+ * Arguments: cache - result cache
+ *            entry - entry not in the recency list
+ * Returns: void
+ * Side-Effects: puts the entry at the front of the recency list
+ *
+ * Description: the newest entry is the last one to be evicted.
+ ***********************************************************************************************************************/
+static void pushNewest(struct ResultCache* cache, struct CacheEntry* entry) {
+    entry->newer = NULL;
+    entry->older = cache->newest;
+    if (cache->newest != NULL) cache->newest->newer = entry;
+    else cache->oldest = entry;
+    cache->newest = entry;
+}
+
+/***********************************************************************************************************************
+ * lookupResult()
+ *
+ * Arguments: cache - result cache
+ *            key - normalized question
+ *            length - set to the length of the text found
+ * Returns: the stored text, or NULL if the question is not in the cache
+ * Side-Effects: counts a hit or a miss, makes the entry found the most recently used
+ *
+ * Description: walks the hash chain of the key's bucket.
+ ***********************************************************************************************************************/
+const char* lookupResult(struct ResultCache* cache, const struct CacheKey* key, int* length) {
+    unsigned int hash = hashResultKey(key);
+    for (struct CacheEntry* entry = cache->buckets[hash & (cache->numBuckets - 1)]; entry != NULL; entry = entry->chain) {
+        if (entry->hash == hash && sameResultKey(&entry->key, key)) {
+            unlinkRecency(cache, entry);
+            pushNewest(cache, entry);
+            cache->hits++;
+            *length = entry->length;
+            return entry->text;
+        }
+    }
+    cache->misses++;
+    return NULL;
+}
+
+/***********************************************************************************************************************
+ * evictOldest()
+ *
+ * Arguments: cache - non-empty result cache
+ * Returns: void
+ * Side-Effects: frees the least recently used entry
+ *
+ * Description: unlinks it from its hash chain and from the recency list.
+ ***********************************************************************************************************************/
+static void evictOldest(struct ResultCache* cache) {
+    struct CacheEntry* entry = cache->oldest;
+    struct CacheEntry** link = &cache->buckets[entry->hash & (cache->numBuckets - 1)];
+    while (*link != entry) link = &(*link)->chain;
+    *link = entry->chain;
+    unlinkRecency(cache, entry);
+
+    cache->bytes -= sizeof(struct CacheEntry) + entry->length + 1;
+    cache->numEntries--;
+    cache->evictions++;
+    free(entry->text);
+    free(entry);
+}
+
+/***********************************************************************************************************************
+ * storeResult()
+ *
+ * Arguments: cache - result cache
+ *            key - normalized question, not in the cache
+ *            text - line without the client identifier
+ *            length - length of the text
+ * Returns: void
+ * Side-Effects: copies the text into a new entry, evicts entries while the cache is over its budget
+ *
+ * Description: an entry that does not fit in the budget on its own is not stored.
+ ***********************************************************************************************************************/
+void storeResult(struct ResultCache* cache, const struct CacheKey* key, const char* text, int length) {
+    size_t size = sizeof(struct CacheEntry) + length + 1;
+    while (cache->oldest != NULL && cache->bytes + size > cache->maxBytes) {
+        evictOldest(cache);
+    }
+    if (cache->bytes + size > cache->maxBytes) return;
+
+    struct CacheEntry* entry = malloc(sizeof(struct CacheEntry));
+    if (entry == NULL) exit(0);
+    entry->text = malloc(length + 1);
+    if (entry->text == NULL) exit(0);
+    memcpy(entry->text, text, length);
+    entry->text[length] = '\0';
+    entry->length = length;
+    entry->key = *key;
+    entry->hash = hashResultKey(key);
+
+    struct CacheEntry** bucket = &cache->buckets[entry->hash & (cache->numBuckets - 1)];
+    entry->chain = *bucket;
+    *bucket = entry;
+    pushNewest(cache, entry);
+    cache->bytes += size;
+    cache->numEntries++;
+}
+
+/***********************************************************************************************************************
+ * clearResultCache()
+ *
+ * Arguments: cache - result cache
+ * Returns: void
+ * Side-Effects: frees every entry
+ *
+ * Description: used when the answers stored no longer hold (the map changed).
+ ***********************************************************************************************************************/
+void clearResultCache(struct ResultCache* cache) {
+    while (cache->oldest != NULL) {
+        evictOldest(cache);
+        cache->evictions--;
+    }
+}
+
+/***********************************************************************************************************************
+ * freeResultCache()
+ *
+ * Arguments: cache - pointer to the cache
+ * Returns: void
+ * Side-Effects: frees dynamically allocated memory
+ *
+ * Description: frees the entries, the table and the structure.
+ ***********************************************************************************************************************/
+void freeResultCache(struct ResultCache* cache) {
+    if (cache == NULL) return;
+    clearResultCache(cache);
+    free(cache->buckets);
+    free(cache);
+}
@@ -0,0 +1,96 @@
+/******************************************************************************
+ * NAME
+ *   cache.h
+ *
+ * DESCRIPTION
+ *   Header file for the result cache: .sol lines of answered questions,
+ *   kept in least recently used order within a memory budget.
+ *
+ * COMMENTS
+ *   Two clients asking the same question get the same line apart from the
+ *   client identifier, so only the text after it is stored. The key keeps
+ *   what can change that text: the cities, the filter, the edge filters,
+ *   the budgets the engines check and the departure time. Waiting times only
+ *   depend on the minute of the day, so the departure is stored modulo 1440
+ *   except where the default B1 check compares the absolute arrival time.
+ *   The cache is tied to one map and to one set of engines.
+ *
+ ******************************************************************************/
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "dijkstra.h"
+
+// Smallest hash table (buckets)
+#define CACHE_MIN_BUCKETS 1024
+// Bytes of budget per bucket: the table is sized for lines of about this length
+#define CACHE_BYTES_PER_BUCKET 256
+
+// Question asked by a client, normalized (absent restrictions are INF)
+struct CacheKey {
+    int startCity;
+    int endCity;
+    int costFilter;
+    int departure;              // minute of the day, or the departure time when it matters as a whole
+    uint64_t allowedTransports;
+    int excludedTransport;
+    int maxDuration;
+    int maxCost;
+    int totalDuration;
+    int totalCost;
+};
+
+// Stored answer, in a hash chain and in the recency list
+struct CacheEntry {
+    struct CacheKey key;
+    unsigned int hash;
+    char* text;                 // line without the client identifier: " ...\n"
+    int length;
+    struct CacheEntry* chain;
+    struct CacheEntry* newer;
+    struct CacheEntry* older;
+};
+
+// Result cache
+struct ResultCache {
+    size_t maxBytes;
+    size_t bytes;               // table, entries and texts
+    int numBuckets;             // power of two
+    struct CacheEntry** buckets;
+    struct CacheEntry* newest;
+    struct CacheEntry* oldest;
+    int numEntries;
+    long long hits;
+    long long misses;
+    long long evictions;
+};
+
+// Creates an empty cache using at most maxBytes
+struct ResultCache* createResultCache(size_t maxBytes);
+
+// Normalizes a valid client's question; budgetAware is set when -e rcsp answers clients with B1 or B2
+void resultKey(const struct Client* client, bool budgetAware, struct CacheKey* key);
+
+// Hash of a key
+unsigned int hashResultKey(const struct CacheKey* key);
+
+// True if both keys ask the same question
+bool sameResultKey(const struct CacheKey* a, const struct CacheKey* b);
+
+// Returns the stored text (and its length) and counts a hit, or returns NULL and counts a miss
+const char* lookupResult(struct ResultCache* cache, const struct CacheKey* key, int* length);
+
+// Stores the text of a line, evicting the least recently used entries to stay within the budget
+void storeResult(struct ResultCache* cache, const struct CacheKey* key, const char* text, int length);
+
+// Removes every entry, keeping the counters
+void clearResultCache(struct ResultCache* cache);
+
+// Frees the cache
+void freeResultCache(struct ResultCache* cache);
+
+#endif
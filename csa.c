@@ -0,0 +1,523 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: csa.c
+* Description: Connection Scan Algorithm for duration queries: the periodic schedules are unrolled into one day of
+*              departures sorted by time, and earliest arrival times are found with a linear scan.
+*/
+
+#include "csa.h"
+#include <string.h>
+#include <stdlib.h>
+
+/***********************************************************************************************************************
+ * countDepartures()
+ *
+ * Arguments: edge - CSR edge
+ * Returns: number of departures of the edge in a day
+ * Side-Effects: none
+ *
+ * Description: the departures waiting_time() allows: firstDeparture, then every departurePeriodicity minutes up to
+ *              lastDeparture (only firstDeparture if lastDeparture is earlier).
+ ***********************************************************************************************************************/
+static int countDepartures(const struct Edge* edge) {
+    if (edge->lastDeparture < edge->firstDeparture) return 1;
+    return (edge->lastDeparture - edge->firstDeparture) / edge->departurePeriodicity + 1;
+}
+
+/***********************************************************************************************************************
+ * supportedSchedule()
+ *
+ * Arguments: edge - CSR edge
+ * Returns: true if its departures can be unrolled into one day
+ * Side-Effects: none
+ *
+ * Description: departures within 0..1439 and a periodicity of at least 1.
+ ***********************************************************************************************************************/
+static bool supportedSchedule(const struct Edge* edge) {
+    return edge->firstDeparture >= 0 && edge->firstDeparture < 1440 && edge->lastDeparture >= 0 &&
+           edge->lastDeparture < 1440 && edge->departurePeriodicity >= 1;
+}
+
+/***********************************************************************************************************************
+ * buildTimetable()
+ *
+ * Arguments: graph - map graph in CSR layout
+ * Returns: pointer to the timetable, or NULL if a schedule is outside 0..1439, has a periodicity below 1, or the
+ *          day has more than CSA_MAX_CONNECTIONS departures (reported on stderr)
+ * Side-Effects: allocates dynamic memory, exits if memory runs out
+ *
+ * Description: counts the departures of every edge per minute of the day, then places them with a counting sort
+ *              (stable, so departures in the same minute keep the CSR edge order).
+ ***********************************************************************************************************************/
+struct Timetable* buildTimetable(const struct Graph* graph) {
+    long long total = 0;
+
+    struct Timetable* timetable = malloc(sizeof(struct Timetable));
+    if (timetable == NULL) exit(0);
+    timetable->minuteStart = calloc(1441, sizeof(int));
+    if (timetable->minuteStart == NULL) exit(0);
+    timetable->departures = NULL;
+
+    for (int e = 0; e < graph->numEdges; e++) {
+        const struct Edge* edge = &graph->edges[e];
+        if (!supportedSchedule(edge)) {
+            fprintf(stderr, "csa: connection with an unsupported schedule, searching with Dijkstra\n");
+            freeTimetable(timetable);
+            return NULL;
+        }
+        total += countDepartures(edge);
+    }
+    if (total > CSA_MAX_CONNECTIONS) {
+        fprintf(stderr, "csa: %lld departures per day is too many, searching with Dijkstra\n", total);
+        freeTimetable(timetable);
+        return NULL;
+    }
+
+    // minuteStart[m + 1] counts the departures at minute m, then the prefix sum gives the start of each minute
+    for (int e = 0; e < graph->numEdges; e++) {
+        const struct Edge* edge = &graph->edges[e];
+        int count = countDepartures(edge);
+        for (int k = 0; k < count; k++) {
+            timetable->minuteStart[edge->firstDeparture + k * edge->departurePeriodicity + 1]++;
+        }
+    }
+    for (int m = 0; m < 1440; m++) {
+        timetable->minuteStart[m + 1] += timetable->minuteStart[m];
+    }
+
+    timetable->numDepartures = (int)total;
+    timetable->departures = malloc((total > 0 ? total : 1) * sizeof(struct Departure));
+    int* cursor = malloc(1440 * sizeof(int));
+    if (timetable->departures == NULL || cursor == NULL) exit(0);
+    memcpy(cursor, timetable->minuteStart, 1440 * sizeof(int));
+
+    for (int u = 0; u < graph->numCities; u++) {
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            const struct Edge* edge = &graph->edges[e];
+            int count = countDepartures(edge);
+            for (int k = 0; k < count; k++) {
+                int minute = edge->firstDeparture + k * edge->departurePeriodicity;
+                struct Departure* departure = &timetable->departures[cursor[minute]++];
+                departure->departure = minute;
+                departure->from = u;
+                departure->edge = e;
+            }
+        }
+    }
+
+    free(cursor);
+    return timetable;
+}
+
+/***********************************************************************************************************************
+ * compareEdges()
+ *
+ * Arguments: a, b - pointers to two edge indices
+ * Returns: negative, zero or positive as for qsort
+ * Side-Effects: none
+ *
+ * Description: ascending order of edge indices.
+ ***********************************************************************************************************************/
+static int compareEdges(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/***********************************************************************************************************************
+ * ownerOf()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            e - edge index
+ * Returns: 0-based city whose range holds the edge
+ * Side-Effects: none
+ *
+ * Description: binary search on the offsets (the last city whose range starts at or before e and is not empty).
+ ***********************************************************************************************************************/
+static int ownerOf(const struct Graph* graph, int e) {
+    int low = 0, high = graph->numCities - 1;
+    while (low < high) {
+        int middle = low + (high - low + 1) / 2;
+        if (graph->offsets[middle] <= e) low = middle;
+        else high = middle - 1;
+    }
+    return low;
+}
+
+/***********************************************************************************************************************
+ * isChanged()
+ *
+ * Arguments: edges - changed edges in ascending order
+ *            numEdges - number of entries
+ *            e - edge index
+ * Returns: true if e is one of them
+ * Side-Effects: none
+ *
+ * Description: binary search.
+ ***********************************************************************************************************************/
+static bool isChanged(const int* edges, int numEdges, int e) {
+    int low = 0, high = numEdges - 1;
+    while (low <= high) {
+        int middle = low + (high - low) / 2;
+        if (edges[middle] == e) return true;
+        if (edges[middle] < e) low = middle + 1;
+        else high = middle - 1;
+    }
+    return false;
+}
+
+/***********************************************************************************************************************
+ * markMinutes()
+ *
+ * Arguments: edge - CSR edge
+ *            dirty - one flag per minute of the day
+ * Returns: void
+ * Side-Effects: sets the flags of the minutes the edge departs at
+ *
+ * Description: schedules the timetable cannot hold have no departures in it.
+ ***********************************************************************************************************************/
+static void markMinutes(const struct Edge* edge, char* dirty) {
+    if (!supportedSchedule(edge)) return;
+    int count = countDepartures(edge);
+    for (int k = 0; k < count; k++) {
+        dirty[edge->firstDeparture + k * edge->departurePeriodicity] = 1;
+    }
+}
+
+/***********************************************************************************************************************
+ * repairTimetable()
+ *
+ * Arguments: timetable - timetable built on the graph before it changed
+ *            graph - changed graph
+ *            remap - remap[e] = index now of the edge that was edges[e] when the timetable was built (-1 if it is
+ *                    gone), or NULL if no edge moved
+ *            changed - indices (now) of the edges whose departures changed, were added or were removed (-1 for
+ *                      removed edges that are gone; duplicates allowed)
+ *            before - before[c] = edge changed[c] as the timetable may hold it
+ *            numChanged - number of entries in changed
+ * Returns: the repaired timetable, or NULL (after freeing it and reporting why) if a changed edge has a schedule the
+ *          engine does not support or the day gets too many departures
+ * Side-Effects: replaces the departure arrays, exits if memory runs out
+ *
+ * Description: only the minutes where a changed edge departed or departs now are looked at one departure at a time:
+ *              the departures of changed edges are dropped there, and the new departures of the changed edges that
+ *              are not removed (unrolled and counted by minute, in edge order) are merged in, aside. The other
+ *              minutes are moved in place as blocks, with their edges renumbered if edges moved, and the merged
+ *              minutes are copied between them. The result is the timetable buildTimetable() makes on the changed
+ *              graph, without sorting it again; a retime that keeps the number of departures moves nothing.
+ ***********************************************************************************************************************/
+struct Timetable* repairTimetable(struct Timetable* timetable, const struct Graph* graph, const int* remap, const int* changed, const struct Edge* before, int numChanged) {
+    int* edges = malloc((numChanged > 0 ? numChanged : 1) * sizeof(int));
+    int* current = malloc((numChanged > 0 ? numChanged : 1) * sizeof(int));
+    int* addedStart = calloc(1441, sizeof(int));
+    char* dirty = calloc(1440, 1);
+    if (edges == NULL || current == NULL || addedStart == NULL || dirty == NULL) exit(0);
+
+    // Changed edges still in the graph (sorted, once each), and those of them that are not removed
+    int numDirty = 0, numEdges = 0;
+    for (int c = 0; c < numChanged; c++) {
+        markMinutes(&before[c], dirty);
+        if (changed[c] >= 0) edges[numDirty++] = changed[c];
+    }
+    qsort(edges, numDirty, sizeof(int), compareEdges);
+    int unique = 0;
+    for (int i = 0; i < numDirty; i++) {
+        if (unique > 0 && edges[unique - 1] == edges[i]) continue;
+        edges[unique++] = edges[i];
+        int e = edges[i];
+        if (graph->removed == NULL || !((graph->removed[e >> 6] >> (e & 63)) & 1)) current[numEdges++] = e;
+    }
+    numDirty = unique;
+
+    long long total = 0;
+    const char* problem = NULL;
+    for (int i = 0; i < numEdges && problem == NULL; i++) {
+        const struct Edge* edge = &graph->edges[current[i]];
+        if (!supportedSchedule(edge)) problem = "csa: connection with an unsupported schedule, searching with Dijkstra\n";
+        else total += countDepartures(edge);
+    }
+    int numAdded = (int)(problem == NULL && total <= CSA_MAX_CONNECTIONS ? total : 0);
+    for (int i = 0; i < numEdges && problem == NULL; i++) {
+        markMinutes(&graph->edges[current[i]], dirty);
+    }
+
+    // New size of every minute: a clean minute keeps its departures, a dirty one its unchanged ones plus the new ones
+    int* newStart = malloc(1441 * sizeof(int));
+    if (newStart == NULL) exit(0);
+    long long scratchSize = 0;
+    for (int m = 0; m < 1440; m++) {
+        int count = timetable->minuteStart[m + 1] - timetable->minuteStart[m];
+        if (dirty[m]) {
+            count = 0;
+            for (int d = timetable->minuteStart[m]; d < timetable->minuteStart[m + 1]; d++) {
+                int e = remap != NULL ? remap[timetable->departures[d].edge] : timetable->departures[d].edge;
+                if (e >= 0 && !isChanged(edges, numDirty, e)) count++;
+            }
+        }
+        newStart[m] = count;
+        total += count;
+    }
+    if (problem == NULL && total > CSA_MAX_CONNECTIONS) problem = "csa: too many departures per day, searching with Dijkstra\n";
+    if (problem != NULL) {
+        fputs(problem, stderr);
+        free(edges);
+        free(current);
+        free(addedStart);
+        free(dirty);
+        free(newStart);
+        freeTimetable(timetable);
+        return NULL;
+    }
+
+    // Departures of the changed edges, counting sorted by minute
+    struct Departure* added = malloc((numAdded > 0 ? numAdded : 1) * sizeof(struct Departure));
+    int* cursor = malloc(1440 * sizeof(int));
+    if (added == NULL || cursor == NULL) exit(0);
+    for (int i = 0; i < numEdges; i++) {
+        const struct Edge* edge = &graph->edges[current[i]];
+        int count = countDepartures(edge);
+        for (int k = 0; k < count; k++) {
+            addedStart[edge->firstDeparture + k * edge->departurePeriodicity + 1]++;
+        }
+    }
+    for (int m = 0; m < 1440; m++) {
+        addedStart[m + 1] += addedStart[m];
+    }
+    memcpy(cursor, addedStart, 1440 * sizeof(int));
+    for (int i = 0; i < numEdges; i++) {
+        const struct Edge* edge = &graph->edges[current[i]];
+        int from = ownerOf(graph, current[i]);
+        int count = countDepartures(edge);
+        for (int k = 0; k < count; k++) {
+            int minute = edge->firstDeparture + k * edge->departurePeriodicity;
+            struct Departure* departure = &added[cursor[minute]++];
+            departure->departure = minute;
+            departure->from = from;
+            departure->edge = current[i];
+        }
+    }
+
+    // The dirty minutes are merged aside (within a minute both lists are in edge order)
+    for (int m = 0; m < 1440; m++) {
+        if (dirty[m]) {
+            newStart[m] += addedStart[m + 1] - addedStart[m];
+            scratchSize += newStart[m];
+        }
+    }
+    struct Departure* scratch = malloc((scratchSize > 0 ? scratchSize : 1) * sizeof(struct Departure));
+    if (scratch == NULL) exit(0);
+    int k = 0;
+    for (int m = 0; m < 1440; m++) {
+        if (!dirty[m]) continue;
+        int d = timetable->minuteStart[m], dEnd = timetable->minuteStart[m + 1];
+        int a = addedStart[m], aEnd = addedStart[m + 1];
+        for (;;) {
+            int e = -1;
+            while (d < dEnd) {
+                e = remap != NULL ? remap[timetable->departures[d].edge] : timetable->departures[d].edge;
+                if (e >= 0 && !isChanged(edges, numDirty, e)) break;
+                d++;
+            }
+            if (d < dEnd && (a == aEnd || e < added[a].edge)) {
+                scratch[k] = timetable->departures[d++];
+                scratch[k++].edge = e;
+            } else if (a < aEnd) {
+                scratch[k++] = added[a++];
+            } else {
+                break;
+            }
+        }
+    }
+
+    // Clean minutes move in place: those moving left in ascending order, then those moving right in descending order,
+    // so none overwrites one not moved yet
+    int sum = 0;
+    for (int m = 0; m <= 1440; m++) {
+        int count = m < 1440 ? newStart[m] : 0;
+        newStart[m] = sum;
+        sum += count;
+    }
+    if (total > timetable->numDepartures) {
+        timetable->departures = realloc(timetable->departures, total * sizeof(struct Departure));
+        if (timetable->departures == NULL) exit(0);
+    }
+    struct Departure* departures = timetable->departures;
+    for (int m = 0; m < 1440; m++) {
+        int from = timetable->minuteStart[m];
+        if (!dirty[m] && newStart[m] < from) {
+            memmove(&departures[newStart[m]], &departures[from], (size_t)(timetable->minuteStart[m + 1] - from) * sizeof(struct Departure));
+        }
+    }
+    for (int m = 1439; m >= 0; m--) {
+        int from = timetable->minuteStart[m];
+        if (!dirty[m] && newStart[m] > from) {
+            memmove(&departures[newStart[m]], &departures[from], (size_t)(timetable->minuteStart[m + 1] - from) * sizeof(struct Departure));
+        }
+    }
+    k = 0;
+    for (int m = 0; m < 1440; m++) {
+        int count = newStart[m + 1] - newStart[m];
+        if (dirty[m]) {
+            memcpy(&departures[newStart[m]], &scratch[k], (size_t)count * sizeof(struct Departure));
+            k += count;
+        } else if (remap != NULL) {
+            for (int i = newStart[m]; i < newStart[m + 1]; i++) departures[i].edge = remap[departures[i].edge];
+        }
+    }
+
+    memcpy(timetable->minuteStart, newStart, 1441 * sizeof(int));
+    timetable->numDepartures = (int)total;
+    free(scratch);
+    free(newStart);
+    free(cursor);
+    free(added);
+    free(edges);
+    free(current);
+    free(addedStart);
+    free(dirty);
+    return timetable;
+}
+
+/***********************************************************************************************************************
+ * freeTimetable()
+ *
+ * Arguments: timetable - pointer to the timetable
+ * Returns: void
+ * Side-Effects: frees dynamically allocated memory
+ *
+ * Description: frees the departures and the structure.
+ ***********************************************************************************************************************/
+void freeTimetable(struct Timetable* timetable) {
+    if (timetable == NULL) return;
+    free(timetable->departures);
+    free(timetable->minuteStart);
+    free(timetable);
+}
+
+/***********************************************************************************************************************
+ * targetBound()
+ *
+ * Arguments: ws - workspace of the search
+ *            targets - cities whose arrival times are wanted (1-based)
+ *            numTargets - number of entries in targets
+ * Returns: latest earliest-arrival time among the targets, INF while one of them is unreached
+ * Side-Effects: none
+ *
+ * Description: departures at or after this time cannot improve any target.
+ ***********************************************************************************************************************/
+static int targetBound(const struct Workspace* ws, const int* targets, int numTargets) {
+    int bound = 0;
+    for (int i = 0; i < numTargets; i++) {
+        int arrival = ws->weight[targets[i] - 1];
+        if (arrival > bound) bound = arrival;
+    }
+    return numTargets > 0 ? bound : INF;
+}
+
+/***********************************************************************************************************************
+ * scanDepartures()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            ws - query workspace
+ *            timetable - departures of a day, sorted by minute
+ *            restrictions - structure containing travel restrictions
+ *            startCity - source city
+ *            departureTime - departure time from the source city (not negative)
+ *            targets - cities whose paths are wanted
+ *            numTargets - number of entries in targets
+ * Returns: void
+ * Side-Effects: overwrites the search state kept in the workspace
+ *
+ * Description: scans the departures in time order, day after day, starting at the departure time. A departure can
+ *              be taken if its city has been reached by then, and improves the arrival time of its destination.
+ *              The scan stops once the next departure leaves after every target's arrival time, or after a whole
+ *              day without improvement when no arrival is still on its way (the next days would repeat it). The
+ *              weights and predecessors left in the workspace are laid out as those of dijkstra_search().
+ ***********************************************************************************************************************/
+static void scanDepartures(const struct Graph* graph, struct Workspace* ws, const struct Timetable* timetable, struct Restrictions restrictions, int startCity, int departureTime, const int* targets, int numTargets) {
+    int* weight = ws->weight;
+    unsigned int* targetStamp = ws->targetStamp;
+    bool filtered = restrictions.A1 || restrictions.A2 || restrictions.A3;
+
+    // Every city is touched up front so the scan only has to compare arrival times
+    resetWorkspace(ws);
+    unsigned int epoch = ws->epoch;
+    for (int city = 0; city < graph->numCities; city++) {
+        touchCity(ws, city);
+    }
+    weight[startCity - 1] = departureTime;
+    for (int i = 0; i < numTargets; i++) {
+        targetStamp[targets[i] - 1] = epoch;
+    }
+
+    int bound = targetBound(ws, targets, numTargets);
+    int latest = departureTime;
+    const struct Departure* end = timetable->departures + timetable->numDepartures;
+
+    int firstDay = departureTime - departureTime % 1440;
+    for (int dayStart = firstDay; ; dayStart += 1440) {
+        const struct Departure* c = timetable->departures;
+        if (dayStart == firstDay) c += timetable->minuteStart[departureTime - dayStart];
+        bool improved = false;
+
+        for (; c < end; c++) {
+            int time = dayStart + c->departure;
+            if (time >= bound) return;
+
+            int from = c->from;
+            STAT(ws->counters.scanned++);
+            if (weight[from] > time) continue;
+            const struct Edge* edge = &graph->edges[c->edge];
+            if (filtered && !check_restrictions(restrictions, edge)) {
+                STAT(ws->counters.filtered++);
+                continue;
+            }
+            STAT(ws->counters.settled++);
+
+            int to = edge->destination;
+            int arrival = time + edge->travelDuration;
+            if (arrival < weight[to]) {
+                weight[to] = arrival;
+                ws->prevCity[to] = from;
+                ws->prevEdge[to] = c->edge;
+                improved = true;
+                if (arrival > latest) latest = arrival;
+                if (targetStamp[to] == epoch) bound = targetBound(ws, targets, numTargets);
+            }
+        }
+
+        if (!improved && latest <= dayStart && dayStart > firstDay) break;
+    }
+}
+
+/***********************************************************************************************************************
+ * csa_search()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            ws - query workspace
+ *            timetable - departures of a day, sorted by minute
+ *            restrictions - structure containing travel restrictions
+ *            startCity - source city
+ *            departureTime - departure time from the source city (not negative)
+ *            targets - cities whose paths are wanted
+ *            numTargets - number of entries in targets
+ * Returns: true if the paths to the targets are those dijkstra_search() finds, false if they must be searched again
+ *          with it
+ * Side-Effects: overwrites the search state kept in the workspace
+ *
+ * Description: the arrival times of the scan are the earliest ones, but when two connections reach a city at the same
+ *              minute the scan keeps the one that departs first, and Dijkstra the one relaxed first from the heap.
+ *              Every city on the path to a target is therefore checked to have a single connection arriving at its
+ *              time (see unique_path()): then Dijkstra has no choice either and write_result() extracts the same
+ *              path from the workspace. Cities reached before a city of the path are settled when the scan stops,
+ *              because their connections left before it. Unreached targets have no path to check.
+ ***********************************************************************************************************************/
+bool csa_search(const struct Graph* graph, struct Workspace* ws, const struct Timetable* timetable, struct Restrictions restrictions, int startCity, int departureTime, const int* targets, int numTargets) {
+    scanDepartures(graph, ws, timetable, restrictions, startCity, departureTime, targets, numTargets);
+
+    for (int i = 0; i < numTargets; i++) {
+        if (ws->weight[targets[i] - 1] != INF && !unique_path(graph, ws, restrictions, startCity, targets[i])) return false;
+    }
+    return true;
+}
@@ -0,0 +1,55 @@
+/******************************************************************************
+ * NAME
+ *   csa.h
+ *
+ * DESCRIPTION
+ *   Header file for the Connection Scan Algorithm (CSA) engine used by
+ *   duration (earliest arrival) queries.
+ *
+ * COMMENTS
+ *   Every connection runs on the same schedule each day, so one day of
+ *   elementary departures (one per connection, direction and departure
+ *   minute) sorted by departure time describes the whole timetable. A query
+ *   scans that array in order from its departure minute, wrapping around to
+ *   the next day as many times as needed, and keeps the earliest arrival
+ *   time of every city.
+ *
+ ******************************************************************************/
+
+#ifndef CSA_H
+#define CSA_H
+
+#include "dijkstra.h"
+
+// Largest timetable the engine builds (elementary departures per day)
+#define CSA_MAX_CONNECTIONS (1 << 26)
+
+// One departure of a connection in one direction, within a day (kept small: the scan streams through all of them)
+struct Departure {
+    int departure;              // minute of the day, 0 .. 1439
+    int from;                   // 0-based city
+    int edge;                   // index in graph->edges, read only when the departure is taken
+};
+
+// A day of departures sorted by departure minute
+struct Timetable {
+    int numDepartures;
+    struct Departure* departures;
+    int* minuteStart;           // minuteStart[m] = first departure at minute m or later (1441 entries)
+};
+
+// Unrolls the schedules of the graph; returns NULL (after reporting why) if they cannot be unrolled
+struct Timetable* buildTimetable(const struct Graph* graph);
+
+// Updates a timetable for changed edges of its graph (see repairTimetable()); returns NULL (after freeing it and
+// reporting why) if the changes cannot be unrolled
+struct Timetable* repairTimetable(struct Timetable* timetable, const struct Graph* graph, const int* remap, const int* changed, const struct Edge* before, int numChanged);
+
+// Frees the timetable
+void freeTimetable(struct Timetable* timetable);
+
+// Earliest arrival search from startCity (1-based) leaving at departureTime (>= 0) until every target is reached;
+// returns false if a path to a target could differ from dijkstra_search()'s, which must then answer the targets
+bool csa_search(const struct Graph* graph, struct Workspace* ws, const struct Timetable* timetable, struct Restrictions restrictions, int startCity, int departureTime, const int* targets, int numTargets);
+
+#endif
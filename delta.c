@@ -0,0 +1,451 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: delta.c
+* Description: Incremental map updates: connections added, removed or retimed on the loaded CSR graph, and the repair
+*              of the engines' data and the caches afterwards.
+*/
+
+#include "delta.h"
+#include "scanner.h"
+#include "schedule.h"
+#include "batch.h"
+#include "processFiles.h"
+#include "landmarks.h"
+#include "hierarchy.h"
+#include "csa.h"
+#include "cache.h"
+#include "subgraph.h"
+#include "allpairs.h"
+#include <string.h>
+#include <stdlib.h>
+
+/***********************************************************************************************************************
+ * startUpdate()
+ *
+ * Arguments: update - update to start
+ *            graph - loaded graph the changes apply to
+ * Returns: void
+ * Side-Effects: copies a graph mapped from a snapshot to dynamic memory
+ *
+ * Description: nothing is changed until the first readChange().
+ ***********************************************************************************************************************/
+void startUpdate(struct Update* update, struct Graph* graph) {
+    detachGraph(graph);
+    update->graph = graph;
+    update->adds = NULL;
+    update->addTransports = NULL;
+    update->numAdds = 0;
+    update->addCapacity = 0;
+    update->originalEdges = graph->numEdges;
+    update->remap = NULL;
+    update->changed = NULL;
+    update->before = NULL;
+    update->numChanged = 0;
+    update->changedCapacity = 0;
+    update->applied = 0;
+    update->cheaper = 0;
+    update->costs = 0;
+    update->maxStep = 0;
+}
+
+/***********************************************************************************************************************
+ * markChanged()
+ *
+ * Arguments: update - update in progress
+ *            e - current index of an edge
+ *            before - the edge before the change
+ *            edge - the edge after the change
+ * Returns: void
+ * Side-Effects: appends e to the changed edges, exits if memory runs out
+ *
+ * Description: also keeps the largest step of the changed edges, which may outgrow a bucket queue.
+ ***********************************************************************************************************************/
+static void markChanged(struct Update* update, int e, const struct Edge* before, const struct Edge* edge) {
+    if (update->numChanged == update->changedCapacity) {
+        update->changedCapacity = update->changedCapacity > 0 ? 2 * update->changedCapacity : 64;
+        update->changed = realloc(update->changed, update->changedCapacity * sizeof(int));
+        update->before = realloc(update->before, update->changedCapacity * sizeof(struct Edge));
+        if (update->changed == NULL || update->before == NULL) exit(0);
+    }
+    update->changed[update->numChanged] = e;
+    update->before[update->numChanged] = *before;
+    update->numChanged++;
+    if (edge->travelCost > update->maxStep) update->maxStep = edge->travelCost;
+    if (edge->travelDuration > update->maxStep - 1439) update->maxStep = edge->travelDuration + 1439;
+}
+
+/***********************************************************************************************************************
+ * isRemoved()
+ *
+ * Arguments: graph - map graph
+ *            e - edge index
+ * Returns: 1 if the edge belongs to a removed connection
+ * Side-Effects: none
+ *
+ * Description: a graph without removals has no bit set.
+ ***********************************************************************************************************************/
+static int isRemoved(const struct Graph* graph, int e) {
+    return graph->removed != NULL && ((graph->removed[e >> 6] >> (e & 63)) & 1);
+}
+
+/***********************************************************************************************************************
+ * removeEdge()
+ *
+ * Arguments: graph - map graph
+ *            e - edge index
+ *            city - 0-based city whose range holds the edge
+ * Returns: void
+ * Side-Effects: allocates the removal bits the first time, exits if memory runs out
+ *
+ * Description: the edge becomes a loop on its own city and is marked, so no later change matches it and the next
+ *              pass over the arrays drops it.
+ ***********************************************************************************************************************/
+static void removeEdge(struct Graph* graph, int e, int city) {
+    if (graph->removed == NULL) {
+        graph->removed = calloc(((size_t)graph->numEdges + 63) / 64 + 1, sizeof(uint64_t));
+        if (graph->removed == NULL) exit(0);
+    }
+    graph->removed[e >> 6] |= (uint64_t)1 << (e & 63);
+    graph->edges[e].destination = city;
+}
+
+/***********************************************************************************************************************
+ * findEdge()
+ *
+ * Arguments: graph - map graph
+ *            from - 0-based city whose edges are searched
+ *            to - 0-based destination
+ *            transport - transport id
+ *            skip - edge index to pass over, or -1
+ * Returns: index of the first edge of the range that matches and is not removed, or -1
+ * Side-Effects: none
+ *
+ * Description: the first edge of a range belongs to the connection read (or added) last.
+ ***********************************************************************************************************************/
+static int findEdge(const struct Graph* graph, int from, int to, int transport, int skip) {
+    for (int e = graph->offsets[from]; e < graph->offsets[from + 1]; e++) {
+        const struct Edge* edge = &graph->edges[e];
+        if (edge->destination == to && edge->transport == transport && e != skip && !isRemoved(graph, e)) return e;
+    }
+    return -1;
+}
+
+/***********************************************************************************************************************
+ * findConnection()
+ *
+ * Arguments: graph - map graph
+ *            a, b - 1-based cities of the connection
+ *            transport - transport name
+ *            edges - filled with the edge from a and the edge from b
+ * Returns: 1 if the connection exists, 0 otherwise
+ * Side-Effects: none
+ *
+ * Description: both directions of a connection sit at the same rank among the matching edges of their city, since
+ *              connections are placed and removed in pairs; the first of each range is taken. A loop has both edges
+ *              in one range, next to each other.
+ ***********************************************************************************************************************/
+static int findConnection(const struct Graph* graph, int a, int b, const char* transport, int edges[2]) {
+    int id = findTransport(graph, transport);
+    if (id < 0) return 0;
+    edges[0] = findEdge(graph, a - 1, b - 1, id, -1);
+    if (edges[0] < 0) return 0;
+    edges[1] = findEdge(graph, b - 1, a - 1, id, a == b ? edges[0] : -1);
+    return edges[1] >= 0;
+}
+
+/***********************************************************************************************************************
+ * placeAdds()
+ *
+ * Arguments: update - update with pending additions
+ * Returns: void
+ * Side-Effects: replaces the CSR arrays and the schedules, frees the removal bits, exits if memory runs out
+ *
+ * Description: one pass over the cities builds the new arrays: in each range the added connections come first (the
+ *              last one added first, as if they had been appended to the map file) and then the edges that were
+ *              there, in their order, without the removed ones. The changed edges and the remapping from the start
+ *              of the update follow the edges to their new places.
+ ***********************************************************************************************************************/
+static void placeAdds(struct Update* update) {
+    struct Graph* graph = update->graph;
+    int n = graph->numCities;
+    int oldEdges = graph->numEdges;
+
+    int* offsets = calloc((size_t)n + 1, sizeof(int));
+    int* moved = malloc((oldEdges > 0 ? oldEdges : 1) * sizeof(int));
+    int* cursor = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (offsets == NULL || moved == NULL || cursor == NULL) exit(0);
+
+    for (int u = 0; u < n; u++) {
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            if (!isRemoved(graph, e)) offsets[u + 1]++;
+        }
+    }
+    for (int i = 0; i < update->numAdds; i++) {
+        offsets[update->adds[i].originCity]++;
+        offsets[update->adds[i].destinationCity]++;
+    }
+    for (int u = 0; u < n; u++) {
+        offsets[u + 1] += offsets[u];
+    }
+
+    int numEdges = offsets[n];
+    struct Edge* edges = malloc((numEdges > 0 ? numEdges : 1) * sizeof(struct Edge));
+    if (edges == NULL) exit(0);
+
+    // Edges already there fill the end of each range
+    for (int u = 0; u < n; u++) {
+        int k = offsets[u + 1];
+        for (int e = graph->offsets[u + 1] - 1; e >= graph->offsets[u]; e--) {
+            if (isRemoved(graph, e)) {
+                moved[e] = -1;
+            } else {
+                edges[--k] = graph->edges[e];
+                moved[e] = k;
+            }
+        }
+        cursor[u] = k;
+    }
+
+    // Then the additions, backwards from there, in the order loadGraph() would place them
+    for (int c = 0; c < update->numChanged; c++) {
+        if (update->changed[c] >= 0) update->changed[c] = moved[update->changed[c]];
+    }
+    for (int i = 0; i < update->numAdds; i++) {
+        const struct Path* path = &update->adds[i];
+        for (int side = 0; side < 2; side++) {
+            int from = (side == 0 ? path->originCity : path->destinationCity) - 1;
+            int to = (side == 0 ? path->destinationCity : path->originCity) - 1;
+            int e = --cursor[from];
+            edges[e].destination = to;
+            edges[e].transport = update->addTransports[i];
+            edges[e].travelDuration = path->travelDuration;
+            edges[e].travelCost = path->travelCost;
+            edges[e].firstDeparture = path->firstDeparture;
+            edges[e].lastDeparture = path->lastDeparture;
+            edges[e].departurePeriodicity = path->departurePeriodicity;
+            markChanged(update, e, &edges[e], &edges[e]);
+        }
+    }
+
+    if (update->remap == NULL) {
+        update->remap = moved;
+    } else {
+        for (int e = 0; e < update->originalEdges; e++) {
+            if (update->remap[e] >= 0) update->remap[e] = moved[update->remap[e]];
+        }
+        free(moved);
+    }
+
+    free(graph->offsets);
+    free(graph->edges);
+    free(graph->schedules.first);
+    free(graph->removed);
+    graph->removed = NULL;
+    graph->offsets = offsets;
+    graph->edges = edges;
+    graph->numEdges = numEdges;
+    if (!buildSchedules(graph)) exit(0);
+    free(cursor);
+    update->numAdds = 0;
+}
+
+/***********************************************************************************************************************
+ * finishUpdate()
+ *
+ * Arguments: update - update in progress
+ * Returns: void
+ * Side-Effects: places the pending additions
+ *
+ * Description: after this the graph is complete and may be searched; more changes may still follow.
+ ***********************************************************************************************************************/
+void finishUpdate(struct Update* update) {
+    if (update->numAdds > 0) placeAdds(update);
+}
+
+/***********************************************************************************************************************
+ * readAdd()
+ *
+ * Arguments: scanner - scanner over the change
+ *            update - update in progress
+ * Returns: 1 if the connection is queued, 0 (after reporting) if it is malformed
+ * Side-Effects: may add the transport name to the dictionary, exits if memory runs out
+ *
+ * Description: the connection is read like a line of the map file.
+ ***********************************************************************************************************************/
+static int readAdd(struct Scanner* scanner, struct Update* update) {
+    struct Path path;
+    if (!readConnection(scanner, &path, update->graph->numCities)) return 0;
+    int transport = internTransport(update->graph, path.transport);
+    if (update->numAdds == update->addCapacity) {
+        update->addCapacity = update->addCapacity > 0 ? 2 * update->addCapacity : 64;
+        update->adds = realloc(update->adds, update->addCapacity * sizeof(struct Path));
+        update->addTransports = realloc(update->addTransports, update->addCapacity * sizeof(int));
+        if (update->adds == NULL || update->addTransports == NULL) exit(0);
+    }
+    update->adds[update->numAdds] = path;
+    update->addTransports[update->numAdds] = transport;
+    update->numAdds++;
+    update->cheaper = 1;
+    update->costs = 1;
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * readRemove()
+ *
+ * Arguments: scanner - scanner over the change
+ *            update - update in progress
+ * Returns: 1 if the connection was removed, 0 (after reporting) if it is malformed or does not exist
+ * Side-Effects: turns the connection's two edges into removed loops
+ *
+ * Description: reads "origin destination transport".
+ ***********************************************************************************************************************/
+static int readRemove(struct Scanner* scanner, struct Update* update) {
+    struct Graph* graph = update->graph;
+    int a, b, edges[2];
+    char transport[TRANSPORT_NAME_LEN];
+
+    if (!expectInt(scanner, &a, "origin city") || !expectInt(scanner, &b, "destination city")) return 0;
+    if (a < 1 || a > graph->numCities || b < 1 || b > graph->numCities) {
+        scanError(scanner, "city out of range", "connection");
+        return 0;
+    }
+    if (!expectWord(scanner, transport, sizeof(transport), "transport")) return 0;
+    finishUpdate(update);
+    if (!findConnection(graph, a, b, transport, edges)) {
+        scanError(scanner, "no such connection", "connection");
+        return 0;
+    }
+    markChanged(update, edges[0], &graph->edges[edges[0]], &graph->edges[edges[0]]);
+    markChanged(update, edges[1], &graph->edges[edges[1]], &graph->edges[edges[1]]);
+    removeEdge(graph, edges[0], a - 1);
+    removeEdge(graph, edges[1], b - 1);
+    update->costs = 1;
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * readRetime()
+ *
+ * Arguments: scanner - scanner over the change
+ *            update - update in progress
+ * Returns: 1 if the connection was changed, 0 (after reporting) if it is malformed or does not exist
+ * Side-Effects: rewrites the connection's two edges and their schedules
+ *
+ * Description: the connection keeps its place; a schedule outside SCHEDULE_LIMIT turns the vector kernels off.
+ ***********************************************************************************************************************/
+static int readRetime(struct Scanner* scanner, struct Update* update) {
+    struct Graph* graph = update->graph;
+    struct Path path;
+    int edges[2];
+
+    if (!readConnection(scanner, &path, graph->numCities)) return 0;
+    finishUpdate(update);
+    if (!findConnection(graph, path.originCity, path.destinationCity, path.transport, edges)) {
+        scanError(scanner, "no such connection", "connection");
+        return 0;
+    }
+    for (int side = 0; side < 2; side++) {
+        struct Edge* edge = &graph->edges[edges[side]];
+        struct Edge before = *edge;
+        if (path.travelCost < edge->travelCost) update->cheaper = 1;
+        if (path.travelCost != edge->travelCost) update->costs = 1;
+        edge->travelDuration = path.travelDuration;
+        edge->travelCost = path.travelCost;
+        edge->firstDeparture = path.firstDeparture;
+        edge->lastDeparture = path.lastDeparture;
+        edge->departurePeriodicity = path.departurePeriodicity;
+        if (!setSchedule(&graph->schedules, edges[side], edge)) graph->schedules.regular = 0;
+        markChanged(update, edges[side], &before, edge);
+    }
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * readChange()
+ *
+ * Arguments: scanner - scanner over the delta
+ *            update - update in progress
+ * Returns: 1 if a change was applied, 0 at the end of the input or (after reporting the line) if it cannot be
+ * Side-Effects: changes the graph (additions wait for finishUpdate() or the next removal or retime)
+ *
+ * Description: reads the keyword and the fields of one change. A change that fails leaves the graph as it was.
+ ***********************************************************************************************************************/
+int readChange(struct Scanner* scanner, struct Update* update) {
+    char keyword[10];
+    int applied;
+
+    if (scanWord(scanner, keyword, sizeof(keyword), "change") != 1) return 0;
+    if (strcmp(keyword, "add") == 0) applied = readAdd(scanner, update);
+    else if (strcmp(keyword, "remove") == 0) applied = readRemove(scanner, update);
+    else if (strcmp(keyword, "retime") == 0) applied = readRetime(scanner, update);
+    else {
+        scanError(scanner, "expected add, remove or retime", "change");
+        return 0;
+    }
+    if (applied) update->applied++;
+    return applied;
+}
+
+/***********************************************************************************************************************
+ * repairIndexes()
+ *
+ * Arguments: update - finished update
+ *            indexes - preprocessed data of the enabled engines
+ *            caches - caches and workspaces kept across batches
+ *            options - run options (map name, priority queue)
+ * Returns: void
+ * Side-Effects: clears the caches and the cost table, may recompute the landmark tables, repair the timetable, drop
+ *               the hierarchy and replace the workspaces
+ *
+ * Description: the cached answers, subgraph views and cost table rows are copies of the old map and are thrown away.
+ *              Landmark bounds stay valid while costs only go up or connections go away, so the tables are only
+ *              recomputed (for the same landmarks) when something got cheaper. The timetable drops and inserts the departures of the
+ *              changed edges. A hierarchy cannot be repaired in place: it is dropped when a cost changes, and cost
+ *              queries use the other engines until "contract" is run on the new map. Workspaces whose bucket queue
+ *              is too narrow for a new connection are made again.
+ ***********************************************************************************************************************/
+void repairIndexes(const struct Update* update, struct Indexes* indexes, struct Caches* caches, const struct RunOptions* options) {
+    const struct Graph* graph = update->graph;
+    if (update->applied == 0) return;
+
+    if (caches->results != NULL) clearResultCache(caches->results);
+    if (caches->subgraphs != NULL) clearSubgraphCache(caches->subgraphs);
+    if (caches->costs != NULL) clearCostTable(caches->costs, graph);
+    if (caches->workspaces != NULL && options->queue != QUEUE_BINARY && update->maxStep > caches->workspaces[0]->maxStep) {
+        freeWorkspaces(caches->workspaces, options);
+        caches->workspaces = createWorkspaces(graph, options);
+    }
+
+    if (indexes->landmarks != NULL && update->cheaper) {
+        struct Workspace* ws = caches->workspaces != NULL ? caches->workspaces[0] : createWorkspace(graph->numCities);
+        refreshLandmarks(indexes->landmarks, graph, ws);
+        if (caches->workspaces == NULL) freeWorkspace(ws);
+    }
+    if (indexes->hierarchy != NULL && update->costs) {
+        fprintf(stderr, "%s: the map changed, searching without the contraction hierarchy (run \"contract\" again)\n", options->mapsName);
+        freeHierarchy(indexes->hierarchy);
+        indexes->hierarchy = NULL;
+    }
+    if (indexes->timetable != NULL) {
+        indexes->timetable = repairTimetable(indexes->timetable, graph, update->remap, update->changed, update->before, update->numChanged);
+    }
+}
+
+/***********************************************************************************************************************
+ * freeUpdate()
+ *
+ * Arguments: update - update to free
+ * Returns: void
+ * Side-Effects: frees dynamically allocated memory
+ *
+ * Description: pending additions are dropped; call finishUpdate() first to keep them.
+ ***********************************************************************************************************************/
+void freeUpdate(struct Update* update) {
+    free(update->adds);
+    free(update->addTransports);
+    free(update->remap);
+    free(update->changed);
+    free(update->before);
+}
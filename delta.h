@@ -0,0 +1,76 @@
+/******************************************************************************
+ * NAME
+ *   delta.h
+ *
+ * DESCRIPTION
+ *   Header file for incremental map updates: connections added, removed or
+ *   retimed on a loaded graph, and the repair of the engines' data and the
+ *   caches that depend on it.
+ *
+ * COMMENTS
+ *   A delta has one change per line (blank lines are ignored):
+ *     add <origin> <destination> <transport> <duration> <cost> <first> <last> <period>
+ *     remove <origin> <destination> <transport>
+ *     retime <origin> <destination> <transport> <duration> <cost> <first> <last> <period>
+ *   remove and retime act on the connection between the two cities (in either
+ *   order) with that transport that was read last, and the answers are the
+ *   same as with the map file edited the same way: the line deleted, the line
+ *   changed in place, or the line appended at the end of the file.
+ *   A retime rewrites the connection's two edges where they are. A removal
+ *   turns them into loops on their own city, which no search can improve
+ *   on, and marks them in graph->removed. Added connections are kept until
+ *   the update is finished (or a removal or retime follows them) and then
+ *   placed in one pass over the CSR arrays, which also drops the removed
+ *   edges, so an update costs O(changes x degree) plus at most one O(E) pass
+ *   per group of additions.
+ *   The cities of the map cannot change.
+ *
+ ******************************************************************************/
+
+#ifndef DELTA_H
+#define DELTA_H
+
+#include "graph.h"
+
+struct Scanner;
+struct Indexes;
+struct Caches;
+struct RunOptions;
+
+// Changes being applied to a graph, and what they affect
+struct Update {
+    struct Graph* graph;
+    struct Path* adds;          // connections waiting for the next pass
+    int* addTransports;         // their interned transport ids
+    int numAdds;
+    int addCapacity;
+    int originalEdges;          // numEdges when the update started
+    int* remap;                 // remap[e] = current index of what was edges[e] at the start, -1 once removed; NULL
+                                // while no pass has moved the edges
+    int* changed;               // current indices of the edges whose timetable changed or that were added or removed
+                                // (-1 once a pass drops a removed edge)
+    struct Edge* before;        // before[c] = edge changed[c] as it was, so its old departures can be found
+    int numChanged;
+    int changedCapacity;
+    int applied;                // number of changes
+    int cheaper;                // 1 if a connection was added or a cost went down (landmark bounds may be too high)
+    int costs;                  // 1 if a cost changed or a connection was added or removed (contraction hierarchy)
+    int maxStep;                // largest step of the added and retimed connections (see graphMaxStep())
+};
+
+// Starts an update of a loaded graph (copying it first if it is mapped from a snapshot)
+void startUpdate(struct Update* update, struct Graph* graph);
+
+// Reads and applies one change; returns 1 if applied, 0 at the end of the input or (after reporting) if it fails
+int readChange(struct Scanner* scanner, struct Update* update);
+
+// Places the pending additions
+void finishUpdate(struct Update* update);
+
+// Repairs or drops what depends on the map after finishUpdate(): engines' data, caches and workspaces
+void repairIndexes(const struct Update* update, struct Indexes* indexes, struct Caches* caches, const struct RunOptions* options);
+
+// Frees the bookkeeping of the update (the graph keeps its changes)
+void freeUpdate(struct Update* update);
+
+#endif
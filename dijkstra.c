@@ -1,205 +1,456 @@
 #include "dijkstra.h"
 #include "heap.h"
+#include "subgraph.h"
+#include "schedule.h"
 
 #include <limits.h>
 #include <string.h>
 
-#define INF INT_MAX
+/*
+ * SEARCH_KERNEL() generates the main loop of dijkstra_search() for one combination of optimization mode and edge
+ * filters. The flags are constants in each copy, so the compiler drops the filters a query does not use and the
+ * choice between cost and duration: the loop itself has no string compare, no copy of the restrictions and no
+ * branch on a restriction that is not set.
+ *   COST      - 1 to minimize cost, 0 to minimize arrival time
+ *   TRANSPORT - 1 if A1 excludes a transport of the map (bit test), 2 if it does on a map with more transports than
+ *               the mask covers (id compare)
+ *   DURATION  - 1 if A2 limits the duration of each connection
+ *   PRICE     - 1 if A3 limits the cost of each connection
+ *   VIEW      - 1 if the edges are those of a subgraph view, already filtered, whose edgeIds give the map's indices
+ * Duration kernels given the map's schedules compute the arrivals through all the edges of a city with edgeArrivals()
+ * before relaxing them, when the city has at least ARRIVALS_MIN_DEGREE edges.
+ */
+#define SEARCH_KERNEL(name, COST, TRANSPORT, DURATION, PRICE, VIEW)                                                  \
+static int name(struct Workspace* ws, const struct Restrictions* restrictions, const int* offsets,                  \
+                const struct Edge* edges, const int* edgeIds, const struct Schedules* schedules, int pending) {    \
+    int* weight = ws->weight;                                                                                      \
+    int* heapIndex = ws->heapIndex;                                                                                \
+    int* prevCity = ws->prevCity;                                                                                  \
+    int* prevEdge = ws->prevEdge;                                                                                  \
+    unsigned int* targetStamp = ws->targetStamp;                                                                   \
+    unsigned int epoch = ws->epoch;                                                                                \
+    struct minHeap* heap = ws->heap;                                                                               \
+    uint64_t allowedTransports = restrictions->allowedTransports;                                                  \
+    int excludedTransport = restrictions->excludedTransport;                                                       \
+    int maxDuration = restrictions->maxDuration;                                                                   \
+    int maxCost = restrictions->maxCost;                                                                           \
+    (void)allowedTransports; (void)excludedTransport; (void)maxDuration; (void)maxCost; (void)edgeIds;            \
+    (void)schedules;                                                                                               \
+                                                                                                                   \
+    int settled = 0;                                                                                               \
+    while (!isEmpty(heap)) {                                                                                       \
+        int u = extractMin(heap, heapIndex).city;                                                                  \
+                                                                                                                   \
+        heapIndex[u] = -2;                                                                                         \
+        settled++;                                                                                                 \
+        STAT(ws->counters.settled++);                                                                              \
+        if (targetStamp[u] == epoch) {                                                                             \
+            targetStamp[u] = 0;                                                                                    \
+            if (--pending == 0) break;                                                                             \
+        }                                                                                                          \
+                                                                                                                   \
+        int weightU = weight[u];                                                                                   \
+        const struct Edge* edge = edges + offsets[u];                                                              \
+        const struct Edge* lastEdge = edges + offsets[u + 1];                                                      \
+        const struct Edge* firstEdge = edge;                                                                       \
+        const int* arrival = NULL;                                                                                 \
+        if (!COST && schedules != NULL && weightU >= 0 && lastEdge - firstEdge >= ARRIVALS_MIN_DEGREE) {          \
+            edgeArrivals(schedules, offsets[u], offsets[u + 1], weightU, ws->arrivals);                            \
+            arrival = ws->arrivals;                                                                                \
+        }                                                                                                          \
+        for (; edge < lastEdge; edge++) {                                                                          \
+            STAT(ws->counters.scanned++);                                                                          \
+            if ((TRANSPORT == 1 && !((allowedTransports >> edge->transport) & 1)) ||                               \
+                (TRANSPORT == 2 && edge->transport == excludedTransport) ||                                        \
+                (DURATION && edge->travelDuration > maxDuration) || (PRICE && edge->travelCost > maxCost)) {        \
+                STAT(ws->counters.filtered++);                                                                     \
+                continue;                                                                                          \
+            }                                                                                                      \
+            int v = edge->destination;                                                                             \
+            touchCity(ws, v);                                                                                      \
+            if (heapIndex[v] == -2) continue;                                                                      \
+                                                                                                                   \
+            int newWeight = COST ? weightU + edge->travelCost                                                      \
+                                 : arrival != NULL ? arrival[edge - firstEdge]                                     \
+                                 : weightU + waiting_time(weightU, edge) + edge->travelDuration;                   \
+            if (weight[v] > newWeight) {                                                                           \
+                weight[v] = newWeight;                                                                             \
+                prevCity[v] = u;                                                                                   \
+                prevEdge[v] = VIEW ? edgeIds[edge - edges] : (int)(edge - edges);                                  \
+                if (heapIndex[v] == -1) insertMinHeap(heap, v, newWeight, heapIndex);                              \
+                else decreaseKey(heap, v, newWeight, heapIndex);                                                   \
+            }                                                                                                      \
+        }                                                                                                          \
+    }                                                                                                              \
+    return settled;                                                                                                \
+}
+
+SEARCH_KERNEL(searchDuration, 0, 0, 0, 0, 0)
+SEARCH_KERNEL(searchDurationT, 0, 1, 0, 0, 0)
+SEARCH_KERNEL(searchDurationI, 0, 2, 0, 0, 0)
+SEARCH_KERNEL(searchDurationD, 0, 0, 1, 0, 0)
+SEARCH_KERNEL(searchDurationTD, 0, 1, 1, 0, 0)
+SEARCH_KERNEL(searchDurationID, 0, 2, 1, 0, 0)
+SEARCH_KERNEL(searchDurationP, 0, 0, 0, 1, 0)
+SEARCH_KERNEL(searchDurationTP, 0, 1, 0, 1, 0)
+SEARCH_KERNEL(searchDurationIP, 0, 2, 0, 1, 0)
+SEARCH_KERNEL(searchDurationDP, 0, 0, 1, 1, 0)
+SEARCH_KERNEL(searchDurationTDP, 0, 1, 1, 1, 0)
+SEARCH_KERNEL(searchDurationIDP, 0, 2, 1, 1, 0)
+SEARCH_KERNEL(searchCost, 1, 0, 0, 0, 0)
+SEARCH_KERNEL(searchCostT, 1, 1, 0, 0, 0)
+SEARCH_KERNEL(searchCostI, 1, 2, 0, 0, 0)
+SEARCH_KERNEL(searchCostD, 1, 0, 1, 0, 0)
+SEARCH_KERNEL(searchCostTD, 1, 1, 1, 0, 0)
+SEARCH_KERNEL(searchCostID, 1, 2, 1, 0, 0)
+SEARCH_KERNEL(searchCostP, 1, 0, 0, 1, 0)
+SEARCH_KERNEL(searchCostTP, 1, 1, 0, 1, 0)
+SEARCH_KERNEL(searchCostIP, 1, 2, 0, 1, 0)
+SEARCH_KERNEL(searchCostDP, 1, 0, 1, 1, 0)
+SEARCH_KERNEL(searchCostTDP, 1, 1, 1, 1, 0)
+SEARCH_KERNEL(searchCostIDP, 1, 2, 1, 1, 0)
+SEARCH_KERNEL(searchDurationView, 0, 0, 0, 0, 1)
+SEARCH_KERNEL(searchCostView, 1, 0, 0, 0, 1)
+
+// Kernels indexed by COST * 12 + PRICE * 6 + DURATION * 3 + TRANSPORT
+static int (*const searchKernels[24])(struct Workspace*, const struct Restrictions*, const int*, const struct Edge*, const int*, const struct Schedules*, int) = {
+    searchDuration, searchDurationT, searchDurationI, searchDurationD, searchDurationTD, searchDurationID,
+    searchDurationP, searchDurationTP, searchDurationIP, searchDurationDP, searchDurationTDP, searchDurationIDP,
+    searchCost, searchCostT, searchCostI, searchCostD, searchCostTD, searchCostID,
+    searchCostP, searchCostTP, searchCostIP, searchCostDP, searchCostTDP, searchCostIDP
+};
 
 /***********************************************************************************************************************
- * dijkstra()
+ * dijkstra_search()
  *
- * Arguments: adjList - adjacency list representing the graph
+ * Arguments: graph - map graph in CSR layout
+ *            ws - query workspace, reused across queries
  *            restrictions - structure containing travel restrictions
- *            numCities - total number of cities (graph vertices)
  *            startCity - source city
- *            endCity - destination city
  *            departureTime - departure time from the source city
  *            filter - string defining optimization mode ("cost" or "duration")
- *            clientID - client identifier
- *            output - file pointer for output
- * Returns: 0
- * Side-Effects: writes result to the output file:
- *                  - <clientID> -1 if path is invalid or violates restrictions;
- *                  - <clientID> ... if path is valid, including duration and cost
- *               allocates and frees dynamic memory
+ *            targets - cities whose paths are wanted
+ *            numTargets - number of entries in targets (0 searches the whole reachable map)
+ * Returns: number of cities settled
+ * Side-Effects: overwrites the search state kept in the workspace
  *
  * Description: implements Dijkstra's algorithm to minimize cost or duration considering travel restrictions.
+ *              The search stops as soon as every target has been extracted from the heap, so the predecessor tree
+ *              left in the workspace answers all of them at once. Only the cities reached by this search are
+ *              initialized (see touchCity()). The filter and the restrictions in use pick one of the kernels made
+ *              by SEARCH_KERNEL(), once per query. An A1 transport the map does not know filters nothing.
+ ***********************************************************************************************************************/
+
+int dijkstra_search(const struct Graph* graph, struct Workspace* ws, struct Restrictions restrictions, int startCity, int departureTime, char* filter, const int* targets, int numTargets){
+    return dijkstra_search_view(graph, NULL, ws, restrictions, startCity, departureTime, filter, targets, numTargets);
+}
+
+/***********************************************************************************************************************
+ * dijkstra_search_view()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            view - connections allowed by the restrictions (see findSubgraph()), or NULL to filter the map's
+ *            ws, restrictions, startCity, departureTime, filter, targets, numTargets - as in dijkstra_search()
+ * Returns: number of cities settled
+ * Side-Effects: overwrites the search state kept in the workspace
+ *
+ * Description: dijkstra_search() on a subgraph view: the view's kernels skip the filters and record the map's edge
+ *              indices, so the tree left in the workspace is the same as on the map.
  ***********************************************************************************************************************/
 
-int dijkstra(struct Adjacency** adjList, struct Restrictions restrictions, int numCities, int startCity, int endCity, int departureTime, char* filter, int clientID, FILE *output){
-    int newWeight = 0;
-    int* weight;
-    int* secondaryWeight;
-    int* heapIndex;
-    int* prevCity;
-    char** prevTransport;
-
-    weight = (int*)malloc(numCities * sizeof(int));
-    if(weight == NULL) exit(0);
-    secondaryWeight = (int*)malloc(numCities * sizeof(int));
-    if(secondaryWeight == NULL) exit(0);
-    heapIndex = (int*)malloc(numCities * sizeof(int));
-    if(heapIndex == NULL) exit(0);
-    prevCity = (int*)malloc(numCities * sizeof(int));
-    if(prevCity == NULL) exit(0);
-    prevTransport = (char**)malloc(numCities * sizeof(char*));
-    if(prevTransport == NULL) exit(0); 
-    for(int i = 0; i < numCities; i++){
-        prevTransport[i] = malloc(10 * sizeof(char));
-        if(prevTransport[i] == NULL) exit(0);
-    }
-
-    for(int i = 0; i < numCities; i++){
-        weight[i] = INF;
-        heapIndex[i] = -1;
-        prevCity[i] = i;
+int dijkstra_search_view(const struct Graph* graph, const struct Subgraph* view, struct Workspace* ws, struct Restrictions restrictions, int startCity, int departureTime, char* filter, const int* targets, int numTargets){
+    unsigned int* targetStamp = ws->targetStamp;
+    bool costFilter = strcmp(filter, "cost") == 0;
+
+    resetWorkspace(ws);
+    touchCity(ws, startCity - 1);
+
+    int pending = 0;
+    for (int i = 0; i < numTargets; i++) {
+        touchCity(ws, targets[i] - 1);
+        if (targetStamp[targets[i] - 1] != ws->epoch) {
+            targetStamp[targets[i] - 1] = ws->epoch;
+            pending++;
+        }
+    }
+
+    ws->weight[startCity - 1] = costFilter ? 0 : departureTime;
+    insertMinHeap(ws->heap, startCity - 1, ws->weight[startCity - 1], ws->heapIndex);
+
+    if (view != NULL) {
+        return (costFilter ? searchCostView : searchDurationView)(ws, &restrictions, view->offsets, view->edges, view->edgeIds, NULL, pending);
     }
+    const struct Schedules* schedules = NULL;
+    if (!costFilter && graph->schedules.regular) {
+        reserveArrivals(ws, graph->schedules.maxDegree);
+        schedules = &graph->schedules;
+    }
+    int kernel = (costFilter ? 12 : 0) + (restrictions.A3 ? 6 : 0) + (restrictions.A2 ? 3 : 0) +
+                 (restrictions.excludedTransport >= 0 ? 2 : restrictions.allowedTransports != ~(uint64_t)0 ? 1 : 0);
+    return searchKernels[kernel](ws, &restrictions, graph->offsets, graph->edges, NULL, schedules, pending);
+}
+
+/***********************************************************************************************************************
+ * check_budget()
+ *
+ * Arguments: restrictions - structure containing travel restrictions
+ *            filter - string defining optimization mode ("cost" or "duration")
+ *            primary - optimized weight at the destination (cost, or arrival time for duration queries)
+ * Returns: true - if a path was found and respects B2 (cost queries) or B1 (duration queries)
+ *          false - otherwise
+ * Side-Effects: none
+ * Description: final check applied to the destination once the search is over.
+ ***********************************************************************************************************************/
 
+bool check_budget(struct Restrictions restrictions, const char* filter, int primary){
+    if(primary == INF){
+        return false;
+    }
     if(strcmp(filter, "cost") == 0){
-        weight[startCity - 1] = 0;
-        secondaryWeight[startCity - 1] = departureTime;
+        if(restrictions.B2 && primary > restrictions.totalCost){
+            return false;
+        }
     } else {
-        weight[startCity - 1] = departureTime;
-        secondaryWeight[startCity - 1] = 0;
-    }
-
-    struct minHeap* heap = createMinHeap(numCities);
-    insertMinHeap(heap, startCity - 1, weight[startCity - 1], heapIndex);
-
-    while(!isEmpty(heap)) {
-        struct heapNode minNode = extractMin(heap, heapIndex);
-        int u = minNode.city;
-
-        heapIndex[u] = -2;
-        if (u == endCity - 1) break;
-
-        struct Adjacency* adjacency = adjList[u];
-        while (adjacency != NULL) {
-            int v = adjacency->path.destinationCity - 1;
-
-            if(!check_restrictions(restrictions, adjacency) || heapIndex[v] == -2){
-                adjacency = adjacency->next;
-                continue;
-            }
-
-            if(strcmp(filter, "cost") == 0){
-                newWeight = weight[u] + adjacency->path.travelCost;
-            } else {
-                newWeight = weight[u] + waiting_time(weight[u], adjacency->path) + adjacency->path.travelDuration;
-            }
-
-            if(weight[v] > newWeight){
-                weight[v] = newWeight;
-                prevCity[v] = u;
-                strcpy(prevTransport[v], adjacency->path.transport);
-
-                if(strcmp(filter, "cost") == 0){
-                    secondaryWeight[v] = secondaryWeight[u] + waiting_time(secondaryWeight[u], adjacency->path) + adjacency->path.travelDuration;
-                } else {
-                    secondaryWeight[v] = secondaryWeight[u] + adjacency->path.travelCost;
-                }
-
-                if(heapIndex[v] == -1){
-                    insertMinHeap(heap, v, weight[v], heapIndex);
-                } else {
-                    decreaseKey(heap, heapIndex[v], newWeight, heapIndex);
-                }
-            }
-            adjacency = adjacency->next;
+        if(restrictions.B1 && primary > restrictions.totalDuration){
+            return false;
         }
     }
+    return true;
+}
 
-    bool invalidDueToRestrictionB = false;
-    if(strcmp(filter, "cost") == 0){
-        if(restrictions.B2){
-            if(weight[endCity - 1] > restrictions.totalCost){
-                invalidDueToRestrictionB = true;
-            }
+/***********************************************************************************************************************
+ * write_path()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            ws - workspace whose trip/tripEdge arrays hold the path, hop by hop from the start city
+ *            numHops - number of hops in the path
+ *            primary - optimized weight at the destination (cost, or arrival time for duration queries)
+ *            client - client request
+ *            output - buffer receiving the .sol line
+ * Returns: void
+ * Side-Effects: appends "<clientID> startCity <transport city ...> duration cost" to the output buffer
+ *
+ * Description: writes a path found by any search engine. Hop i arrives at city trip[i] through edge tripEdge[i];
+ *              only the transport and schedule of the edge are used, so either direction of a connection will do.
+ *              The secondary criterion is replayed along the path (waiting times for cost queries, costs for
+ *              duration queries), so a cost path can be shared by clients that leave at different times.
+ ***********************************************************************************************************************/
+
+void write_path(const struct Graph* graph, const struct Workspace* ws, int numHops, int primary, const struct Client* client, struct SolBuffer* output){
+    bool costFilter = strcmp(client->filter, "cost") == 0;
+    int departureTime = client->departureTime;
+
+    solPutInt(output, client->clientID, ' ');
+    solPutInt(output, client->startCity, ' ');
+
+    int secondary = costFilter ? departureTime : 0;
+    for (int i = 0; i < numHops; i++) {
+        const struct Edge* edge = &graph->edges[ws->tripEdge[i]];
+        if(costFilter){
+            secondary += waiting_time(secondary, edge) + edge->travelDuration;
+        } else {
+            secondary += edge->travelCost;
         }
+        solPutWord(output, graph->transports[edge->transport], ' ');
+        solPutInt(output, ws->trip[i] + 1, ' ');
+    }
+
+    if(costFilter){
+        solPutInt(output, secondary - departureTime, ' ');
+        solPutInt(output, primary, '\n');
     } else {
-        if(restrictions.B1){
-            if(weight[endCity - 1] > restrictions.totalDuration){
-                invalidDueToRestrictionB = true;
-            }
-        }    
-    }
-
-    if (weight[endCity - 1] == INF || invalidDueToRestrictionB) {
-        fprintf(output, "%d -1\n", clientID);
-        freeMinHeap(heap);
-        free(weight);
-        free(secondaryWeight);
-        free(heapIndex);
-        free(prevCity);
-        for(int i = 0; i < numCities; i++){
-            free(prevTransport[i]);
-        }
-        free(prevTransport);
-        return 0;
+        solPutInt(output, primary - departureTime, ' ');
+        solPutInt(output, secondary, '\n');
+    }
+}
+
+/***********************************************************************************************************************
+ * write_tree()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            ws - workspace holding the tree of a search from the client's start city
+ *            client - client request; its end city must have been settled by the search
+ *            primary - optimized weight at the end city (cost, or arrival time for duration queries)
+ *            output - buffer receiving the .sol line
+ * Returns: void
+ * Side-Effects: appends the result to the output buffer:
+ *                  - <clientID> -1 if path is invalid or violates restrictions;
+ *                  - <clientID> ... if path is valid, including duration and cost
+ *               overwrites the tripEdge array of the workspace
+ *
+ * Description: writes the same line as write_path() in one walk of the predecessor tree back from the end city: the
+ *              hops are built backwards in the output buffer, and their edges kept (last hop first) only to replay
+ *              the waiting times of a cost query, which run forwards from the departure.
+ ***********************************************************************************************************************/
+
+void write_tree(const struct Graph* graph, struct Workspace* ws, const struct Client* client, int primary, struct SolBuffer* output){
+    int startCity = client->startCity;
+    int endCity = client->endCity;
+    int departureTime = client->departureTime;
+    const int* prevCity = ws->prevCity;
+
+    if (!check_budget(client->restrictions, client->filter, primary)) {
+        solPutInt(output, client->clientID, ' ');
+        solPutInt(output, -1, '\n');
+        return;
     }
+    bool costFilter = strcmp(client->filter, "cost") == 0;
 
-    int* trip = (int*)malloc(numCities * sizeof(int));
-    if(trip == NULL) exit(0);
-    int count = 0, storeCount = 0;
+    solPutInt(output, client->clientID, ' ');
+    solPutInt(output, startCity, ' ');
 
+    int numHops = 0, cost = 0;
+    solBeginBackward(output);
     for (int v = endCity - 1; v != startCity - 1; v = prevCity[v]) {
-        count++;
+        const struct Edge* edge = &graph->edges[ws->prevEdge[v]];
+        solPrependInt(output, v + 1, ' ');
+        solPrependWord(output, graph->transports[edge->transport], ' ');
+        ws->tripEdge[numHops++] = ws->prevEdge[v];
+        cost += edge->travelCost;
     }
-    storeCount = count;
-    for (int v = endCity - 1; v != startCity - 1; v = prevCity[v]) {
-        trip[--count] = v;
+    solEndBackward(output);
+
+    if(costFilter){
+        int time = departureTime;
+        for (int i = numHops - 1; i >= 0; i--) {
+            const struct Edge* edge = &graph->edges[ws->tripEdge[i]];
+            time += waiting_time(time, edge) + edge->travelDuration;
+        }
+        solPutInt(output, time - departureTime, ' ');
+        solPutInt(output, primary, '\n');
+    } else {
+        solPutInt(output, primary - departureTime, ' ');
+        solPutInt(output, cost, '\n');
     }
+}
+
+/***********************************************************************************************************************
+ * write_result()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            ws - workspace holding the tree of a search from the client's start city
+ *            client - client request; its end city must have been settled by the search
+ *            output - buffer receiving the .sol line
+ * Returns: void
+ * Side-Effects: appends the result to the output buffer, overwrites the tripEdge array of the workspace
+ *
+ * Description: write_tree() with the weight the search left at the end city.
+ ***********************************************************************************************************************/
+
+void write_result(const struct Graph* graph, struct Workspace* ws, const struct Client* client, struct SolBuffer* output){
+    write_tree(graph, ws, client, ws->weight[client->endCity - 1], output);
+}
+
+/***********************************************************************************************************************
+ * onlyArrival()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            ws - workspace holding the arrival times of a duration search
+ *            restrictions - structure containing travel restrictions
+ *            city - 0-based city reached by the search, other than the start city
+ * Returns: true if a single connection arrives at the city at its arrival time
+ * Side-Effects: none
+ *
+ * Description: the connections into the city are read from the edges in its own range, since each connection is
+ *              stored in both directions with the same schedule. A connection arrives as early if it is allowed and
+ *              its earliest departure after the arrival time of its other city (from waiting_time(), as Dijkstra
+ *              relaxes it) gets there at the city's arrival time; cities the search did not touch were not reached.
+ *              A connection of duration 0 could come from a city reached at the same time and not settled yet, so
+ *              it counts as a second way in.
+ ***********************************************************************************************************************/
 
-    fprintf(output, "%d %d ", clientID, startCity);
+static bool onlyArrival(const struct Graph* graph, const struct Workspace* ws, struct Restrictions restrictions, int city){
+    const int* weight = ws->weight;
+    bool filtered = restrictions.A1 || restrictions.A2 || restrictions.A3;
+    int ways = 0;
 
-    for (int i = 0; i < storeCount; i++) {
-        fprintf(output, "%s %d ", prevTransport[trip[i]], trip[i] + 1);
+    for (int e = graph->offsets[city]; e < graph->offsets[city + 1]; e++) {
+        const struct Edge* edge = &graph->edges[e];
+        if (filtered && !check_restrictions(restrictions, edge)) continue;
+        if (edge->travelDuration <= 0) return false;
+        int from = edge->destination;
+        if (ws->stamp[from] != ws->epoch || weight[from] >= weight[city]) continue;
+        if (weight[from] + waiting_time(weight[from], edge) + edge->travelDuration == weight[city] && ++ways > 1) return false;
     }
+    return true;
+}
 
-    if(strcmp(filter, "cost") == 0){
-        fprintf(output, "%d %d\n", secondaryWeight[endCity - 1] - departureTime, weight[endCity - 1]);
-    } else {
-        fprintf(output, "%d %d\n", weight[endCity - 1] - departureTime, secondaryWeight[endCity - 1]);
+/***********************************************************************************************************************
+ * unique_path()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            ws - workspace holding the tree of a duration search from startCity
+ *            restrictions - structure containing travel restrictions
+ *            startCity - 1-based source city
+ *            endCity - 1-based city reached by the search
+ * Returns: true if every city on the path of the tree to endCity has a single connection arriving at its time
+ * Side-Effects: none
+ *
+ * Description: for engines that find Dijkstra's arrival times another way. Dijkstra keeps, among the connections
+ *              arriving at a city at the same time, the one it relaxes first, which depends on its queue; when each
+ *              city of the path has only one, Dijkstra has no choice either and writes the same path. The cities
+ *              arriving before a city of the path must hold their earliest arrivals.
+ ***********************************************************************************************************************/
+
+bool unique_path(const struct Graph* graph, const struct Workspace* ws, struct Restrictions restrictions, int startCity, int endCity){
+    for (int city = endCity - 1; city != startCity - 1; city = ws->prevCity[city]) {
+        if (!onlyArrival(graph, ws, restrictions, city)) return false;
     }
+    return true;
+}
 
-    freeMinHeap(heap);
-    free(weight);
-    free(secondaryWeight);
-    free(heapIndex);
-    free(prevCity);
-    free(trip);
-    for(int i = 0; i < numCities; i++){
-        free(prevTransport[i]);
+/***********************************************************************************************************************
+ * compile_restrictions()
+ *
+ * Arguments: graph - map graph holding the transport dictionary
+ *            restrictions - client restrictions, already read from the clients file
+ * Returns: void
+ * Side-Effects: sets restrictions->allowedTransports and restrictions->excludedTransport
+ * Description: turns the A1 restriction into a bitmask over transport ids so the search never compares names.
+ *              A transport the map does not know cannot appear on any edge, so it leaves every bit set. On a map
+ *              with more than TRANSPORT_MASK_BITS transports the ids do not fit in the mask: the mask keeps every
+ *              bit set and the excluded id is kept instead.
+ ***********************************************************************************************************************/
+
+void compile_restrictions(const struct Graph* graph, struct Restrictions* restrictions){
+    restrictions->allowedTransports = ~(uint64_t)0;
+    restrictions->excludedTransport = -1;
+    if(restrictions->A1){
+        int id = findTransport(graph, restrictions->restrictedTransport);
+        if(id >= 0 && graph->numTransports > TRANSPORT_MASK_BITS){
+            restrictions->excludedTransport = id;
+        }else if(id >= 0){
+            restrictions->allowedTransports &= ~((uint64_t)1 << id);
+        }
     }
-    free(prevTransport);
-    return 0;
 }
 
 /***********************************************************************************************************************
  * check_restrictions()
  *
  * Arguments: restrictions - structure containing travel restrictions
- *            adjacency - pointer to adjacency structure to check
+ *            edge - pointer to the CSR edge to check
  * Returns: true - if the edge satisfies all restrictions
  *          false - if the edge violates any restriction
  * Side-Effects: none
  * Description: checks if a graph edge respects the defined travel restrictions.
  ***********************************************************************************************************************/
 
-bool check_restrictions(struct Restrictions restrictions, struct Adjacency* adjacency){
-    if(restrictions.A1){
-        if(strcmp(adjacency->path.transport, restrictions.restrictedTransport) == 0){
+bool check_restrictions(struct Restrictions restrictions, const struct Edge* edge){
+    if(restrictions.excludedTransport >= 0){
+        if(edge->transport == restrictions.excludedTransport){
             return false;
         }
+    }else if(edge->transport < TRANSPORT_MASK_BITS && !((restrictions.allowedTransports >> edge->transport) & 1)){
+        return false;
     }
     if(restrictions.A2){
-        if(adjacency->path.travelDuration > restrictions.maxDuration){
+        if(edge->travelDuration > restrictions.maxDuration){
             return false;
         }
     }
     if(restrictions.A3){
-        if(adjacency->path.travelCost > restrictions.maxCost){
+        if(edge->travelCost > restrictions.maxCost){
             return false;
         }
     }
@@ -210,16 +461,16 @@ bool check_restrictions(struct Restrictions restrictions, struct Adjacency* adja
  * waiting_time()
  *
  * Arguments: currentTime - current time in minutes
- *            path - structure with departure info (first, last, periodicity)
+ *            edge - edge with departure info (first, last, periodicity)
  * Returns: waiting time in minutes until the next departure
  * Side-Effects: none
- * Description: calculates the minutes until the next transport departure considering the schedule in 'path'.
+ * Description: calculates the minutes until the next transport departure considering the schedule of 'edge'.
  ***********************************************************************************************************************/
 
-int waiting_time(int currentTime, struct Path path) {
-    int first = path.firstDeparture;      
-    int last  = path.lastDeparture;        
-    int period  = path.departurePeriodicity;  
+int waiting_time(int currentTime, const struct Edge* edge) {
+    int first = edge->firstDeparture;
+    int last  = edge->lastDeparture;
+    int period  = edge->departurePeriodicity;
     
     int h = currentTime % 1440;
 
@@ -15,42 +15,62 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
-
-// Structure representing a path/edge between cities
-struct Path {
-    int originCity;
-    int destinationCity;
-    char transport[10];
-    int travelDuration;
-    int travelCost;
-    int firstDeparture;
-    int lastDeparture;
-    int departurePeriodicity;
-};
-
-// Node of adjacency list
-struct Adjacency {
-    struct Path path;
-    struct Adjacency* next;
-};
+#include <stdint.h>
+#include "graph.h"
+#include "workspace.h"
+#include "output.h"
 
 // Travel restrictions
 struct Restrictions {
     bool A1, A2, A3, B1, B2;
     char restrictedTransport[10];
+    uint64_t allowedTransports;   // bit i set if transport id i may be used (compiled from A1)
+    int excludedTransport;        // id A1 excludes on maps with more than TRANSPORT_MASK_BITS transports, -1 otherwise
     int totalDuration;
     int totalCost;
     int maxCost;
     int maxDuration;
 };
 
-// Dijkstra algorithm
-int dijkstra(struct Adjacency** adjList, struct Restrictions restrictions, int numCities, int startCity, int endCity, int departureTime, char* filter, int clientID, FILE *output);
+// Client request read from the clients file
+struct Client {
+    int clientID;
+    int startCity;
+    int endCity;
+    int departureTime;
+    char filter[10];
+    struct Restrictions restrictions;
+};
+
+struct Subgraph;
+
+// Search from startCity until every target city is settled; returns the number of settled cities
+int dijkstra_search(const struct Graph* graph, struct Workspace* ws, struct Restrictions restrictions, int startCity, int departureTime, char* filter, const int* targets, int numTargets);
+
+// Same search on the connections of a subgraph view of the restrictions (NULL searches the map)
+int dijkstra_search_view(const struct Graph* graph, const struct Subgraph* view, struct Workspace* ws, struct Restrictions restrictions, int startCity, int departureTime, char* filter, const int* targets, int numTargets);
+
+// Check that a path was found and respects the B restriction of the filter
+bool check_budget(struct Restrictions restrictions, const char* filter, int primary);
+
+// Write the .sol line of a path stored hop by hop in the workspace trip arrays
+void write_path(const struct Graph* graph, const struct Workspace* ws, int numHops, int primary, const struct Client* client, struct SolBuffer* output);
+
+// Write the .sol line of one client from the search tree in the workspace, given its weight at the end city
+void write_tree(const struct Graph* graph, struct Workspace* ws, const struct Client* client, int primary, struct SolBuffer* output);
+
+// Write the .sol line of one client from the search tree in the workspace
+void write_result(const struct Graph* graph, struct Workspace* ws, const struct Client* client, struct SolBuffer* output);
+
+// Check that no other path of a duration search tree arrives as early at each of its cities (Dijkstra would write it)
+bool unique_path(const struct Graph* graph, const struct Workspace* ws, struct Restrictions restrictions, int startCity, int endCity);
+// Compile the A1 restriction into the allowed-transport bitmask
+void compile_restrictions(const struct Graph* graph, struct Restrictions* restrictions);
 
-// Check if an adjacency satisfies restrictions
-bool check_restrictions(struct Restrictions restrictions, struct Adjacency* adjacency);
+// Check if an edge satisfies restrictions
+bool check_restrictions(struct Restrictions restrictions, const struct Edge* edge);
 
 // Calculate waiting time until next departure
-int waiting_time(int currentTime, struct Path path);
+int waiting_time(int currentTime, const struct Edge* edge);
 
 #endif
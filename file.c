@@ -19,31 +19,41 @@ FILE *openFile(char *filename) {
     return file;
 }
 
-/* Description: Creates the output .sol file corresponding to the input .cli file.
-* Arguments: filename - name of the input .cli file
-* Output: Returns a pointer to the created output file.
+/* Description: Builds a file name with the extension of another one replaced.
+* Arguments: filename - original file name
+*            extension - new extension, including the dot
+* Output: Returns the new name (allocated, to be freed by the caller).
 */
-FILE *createOutputFile(char *filename) {
+char *replaceExtension(const char *filename, const char *extension) {
 
     int filenameLength = strlen(filename);
 
-    // Allocate space for new filename (+8 for ".sol" and +1 for null terminator)
-    char* outputName = (char*)malloc(filenameLength + 8 + 1);  
-    if (outputName == NULL) {
+    // Allocate space for new filename and null terminator
+    char* newName = (char*)malloc(filenameLength + strlen(extension) + 1);
+    if (newName == NULL) {
         exit(0);
     }
 
-    strcpy(outputName, filename);
-    outputName[filenameLength] = '\0';
+    strcpy(newName, filename);
 
     // Remove the extension
-    char* lastDot = strrchr(outputName, '.');
+    char* lastDot = strrchr(newName, '.');
     if (lastDot != NULL) {
         *lastDot = '\0';
     }
 
-    // Append the new ".sol" extension
-    strcat(outputName, ".sol");
+    // Append the new extension
+    strcat(newName, extension);
+    return newName;
+}
+
+/* Description: Creates the output .sol file corresponding to the input .cli file.
+* Arguments: filename - name of the input .cli file
+* Output: Returns a pointer to the created output file.
+*/
+FILE *createOutputFile(char *filename) {
+
+    char* outputName = replaceExtension(filename, ".sol");
 
     FILE *file = fopen(outputName, "w");
     if (file == NULL) {
@@ -18,10 +18,14 @@
 // Opens an input file for reading
 FILE *openFile(char *filename);
 
+// Returns a copy of filename with its extension replaced (caller frees it)
+char *replaceExtension(const char *filename, const char *extension);
+
 // Creates an output .sol file corresponding to the input file
 FILE *createOutputFile(char *filename);
 
 // Processes input files and writes results to the output file
-int processFiles(FILE *mapsInput, FILE *clientInput, FILE *output);
+struct RunOptions;
+int processFiles(FILE *mapsInput, FILE *clientInput, FILE *output, const struct RunOptions* options);
 
 #endif
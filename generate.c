@@ -0,0 +1,441 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: generate.c
+* Description: Generator of synthetic maps and clients files for the benchmarks. The same arguments and seed always
+*              produce the same files, on any platform.
+* Arguments: <executable> map <grid|geometric|hub> <cities> <connections> <mapFile> [-s seed] [-t mix] [-d departures]
+*            <executable> clients <mapFile> <count> <clientsFile> [-s seed] [-c costFraction] [-r A1=p,...,B2=p]
+* Output: the .map or .cli file
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define MAX_TRANSPORTS 64
+#define NAME_LEN 32
+
+// Parameters of a run
+struct Settings {
+    unsigned long long seed;
+    int numTransports;
+    char transports[MAX_TRANSPORTS][NAME_LEN];
+    double transportWeight[MAX_TRANSPORTS];
+    int departures;             // -d: departures per day of each connection
+    double costFraction;        // -c: share of cost queries
+    double restriction[5];      // -r: probability of A1, A2, A3, B1, B2
+};
+
+// Connection being generated
+struct Connection {
+    int from;
+    int to;
+    double distance;
+};
+
+static unsigned long long rngState;
+
+/* Description: Prints the command line usage and exits.
+* Arguments: program - name of the executable
+*/
+static void usage(char *program) {
+    printf("Usage: %s map <grid|geometric|hub> <cities> <connections> <mapFile> [options]\n", program);
+    printf("       %s clients <mapFile> <count> <clientsFile> [options]\n", program);
+    printf("  -s seed         random seed (default 1)\n");
+    printf("  -t mix          transports and their weights, e.g. bus:5,metro:3,train:1 (maps)\n");
+    printf("  -d departures   departures per day of each connection (maps, default 24)\n");
+    printf("  -c fraction     share of cost queries, the rest are duration queries (clients, default 0.5)\n");
+    printf("  -r A1=p,...     probability of each restriction A1, A2, A3, B1, B2 (clients, default 0.1 each,\n");
+    printf("                  at most 2 per client)\n");
+    printf("  <connections> 0 picks the natural number for the kind: the grid lattice, or 3 per city\n");
+    exit(0);
+}
+
+/* Description: Draws the next pseudo-random number (splitmix64, so the files do not depend on the C library).
+* Returns: 64 random bits
+*/
+static unsigned long long nextRandom(void) {
+    unsigned long long z = (rngState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* Description: Draws an integer uniformly.
+* Arguments: low, high - bounds, both included
+*/
+static int randomInt(int low, int high) {
+    return low + (int)(nextRandom() % (unsigned long long)(high - low + 1));
+}
+
+/* Description: Draws a real number uniformly in [0, 1).
+*/
+static double randomUnit(void) {
+    return (nextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Description: Parses "name:weight,name:weight,..." into the transport mix.
+* Arguments: mix - the -t argument
+*            settings - settings to fill
+* Returns: 1 on success, 0 if the mix is malformed
+*/
+static int parseTransports(const char *mix, struct Settings *settings) {
+    settings->numTransports = 0;
+    while (*mix != '\0') {
+        if (settings->numTransports == MAX_TRANSPORTS) return 0;
+        int length = (int)strcspn(mix, ":,");
+        if (length == 0 || length >= NAME_LEN) return 0;
+        memcpy(settings->transports[settings->numTransports], mix, length);
+        settings->transports[settings->numTransports][length] = '\0';
+        mix += length;
+
+        double weight = 1.0;
+        if (*mix == ':') {
+            char *end;
+            weight = strtod(mix + 1, &end);
+            if (end == mix + 1 || weight <= 0) return 0;
+            mix = end;
+        }
+        settings->transportWeight[settings->numTransports++] = weight;
+        if (*mix == ',') mix++;
+        else if (*mix != '\0') return 0;
+    }
+    return settings->numTransports > 0;
+}
+
+/* Description: Parses "A1=p,B2=p,..." into the restriction probabilities.
+* Arguments: list - the -r argument
+*            settings - settings to fill
+* Returns: 1 on success, 0 if the list is malformed
+*/
+static int parseRestrictions(const char *list, struct Settings *settings) {
+    static const char *names[5] = { "A1", "A2", "A3", "B1", "B2" };
+    for (int k = 0; k < 5; k++) settings->restriction[k] = 0.0;
+
+    while (*list != '\0') {
+        int k = 0;
+        while (k < 5 && strncmp(list, names[k], 2) != 0) k++;
+        if (k == 5 || list[2] != '=') return 0;
+        char *end;
+        settings->restriction[k] = strtod(list + 3, &end);
+        if (end == list + 3 || settings->restriction[k] < 0 || settings->restriction[k] > 1) return 0;
+        list = end;
+        if (*list == ',') list++;
+        else if (*list != '\0') return 0;
+    }
+    return 1;
+}
+
+/* Description: Picks a transport according to the weights of the mix.
+* Arguments: settings - transport mix
+* Returns: index of the transport
+*/
+static int pickTransport(const struct Settings *settings) {
+    double total = 0.0;
+    for (int t = 0; t < settings->numTransports; t++) total += settings->transportWeight[t];
+    double x = randomUnit() * total;
+    for (int t = 0; t < settings->numTransports; t++) {
+        x -= settings->transportWeight[t];
+        if (x < 0) return t;
+    }
+    return settings->numTransports - 1;
+}
+
+/* Description: Grid: a W x W lattice of cities joined to their right and lower neighbours; connections beyond the
+*              lattice are express links to a city at most 3 rows and columns away.
+* Arguments: numCities, numConnections - sizes (numConnections 0 keeps the whole lattice)
+*            connections - array to fill, numConnections entries (or the lattice size if 0)
+* Returns: number of connections generated
+*/
+static int generateGrid(int numCities, int numConnections, struct Connection *connections) {
+    int width = (int)ceil(sqrt((double)numCities));
+    int count = 0;
+
+    for (int u = 0; u < numCities; u++) {
+        if ((u + 1) % width != 0 && u + 1 < numCities) {
+            connections[count++] = (struct Connection){ u, u + 1, 1.0 };
+        }
+        if (u + width < numCities) {
+            connections[count++] = (struct Connection){ u, u + width, 1.0 };
+        }
+    }
+    if (numConnections == 0 || numConnections == count) return count;
+
+    // Fewer connections: keep a random subset of the lattice
+    if (numConnections < count) {
+        for (int i = count - 1; i > 0; i--) {
+            int j = randomInt(0, i);
+            struct Connection swap = connections[i];
+            connections[i] = connections[j];
+            connections[j] = swap;
+        }
+        return numConnections;
+    }
+
+    while (count < numConnections) {
+        int u = randomInt(0, numCities - 1);
+        int x = u % width + randomInt(-3, 3);
+        int y = u / width + randomInt(-3, 3);
+        int v = y * width + x;
+        if (x < 0 || x >= width || y < 0 || v >= numCities || v == u) continue;
+        int dx = x - u % width, dy = y - u / width;
+        connections[count++] = (struct Connection){ u, v, sqrt((double)(dx * dx + dy * dy)) };
+    }
+    return count;
+}
+
+/* Description: Random geometric graph: cities are random points in a square and each connection joins a city to
+*              a random city of the same or a neighbouring cell (cells hold about 4 cities).
+* Arguments: numCities, numConnections - sizes
+*            connections - array to fill
+* Returns: number of connections generated
+*/
+static int generateGeometric(int numCities, int numConnections, struct Connection *connections) {
+    int cells = (int)ceil(sqrt(numCities / 4.0));
+    double *x = malloc(numCities * sizeof(double));
+    double *y = malloc(numCities * sizeof(double));
+    int *cellOf = malloc(numCities * sizeof(int));
+    int *cellStart = calloc((size_t)cells * cells + 1, sizeof(int));
+    int *byCell = malloc(numCities * sizeof(int));
+    if (x == NULL || y == NULL || cellOf == NULL || cellStart == NULL || byCell == NULL) exit(0);
+
+    for (int u = 0; u < numCities; u++) {
+        x[u] = randomUnit() * cells;
+        y[u] = randomUnit() * cells;
+        cellOf[u] = (int)y[u] * cells + (int)x[u];
+        cellStart[cellOf[u] + 1]++;
+    }
+    for (int c = 0; c < cells * cells; c++) cellStart[c + 1] += cellStart[c];
+    for (int u = 0; u < numCities; u++) byCell[--cellStart[cellOf[u] + 1]] = u;
+
+    int count = 0;
+    while (count < numConnections) {
+        int u = randomInt(0, numCities - 1);
+        int cx = cellOf[u] % cells + randomInt(-1, 1);
+        int cy = cellOf[u] / cells + randomInt(-1, 1);
+        if (cx < 0 || cx >= cells || cy < 0 || cy >= cells) continue;
+        int c = cy * cells + cx;
+        if (cellStart[c] == cellStart[c + 1]) continue;
+        int v = byCell[randomInt(cellStart[c], cellStart[c + 1] - 1)];
+        if (v == u) continue;
+        connections[count++] = (struct Connection){ u, v, 1.0 + hypot(x[u] - x[v], y[u] - y[v]) };
+    }
+
+    free(x);
+    free(y);
+    free(cellOf);
+    free(cellStart);
+    free(byCell);
+    return count;
+}
+
+/* Description: Hub-and-spoke: about sqrt(cities)/2 hubs joined in a ring, every other city joined to one hub, and
+*              the remaining connections either between hubs or from a city to another hub.
+* Arguments: numCities, numConnections - sizes
+*            connections - array to fill
+* Returns: number of connections generated
+*/
+static int generateHub(int numCities, int numConnections, struct Connection *connections) {
+    int numHubs = (int)sqrt((double)numCities) / 2;
+    if (numHubs < 2) numHubs = 2;
+    if (numHubs > numCities) numHubs = numCities;
+    int count = 0;
+
+    for (int h = 0; h < numHubs && count < numConnections && numHubs > 2; h++) {
+        connections[count++] = (struct Connection){ h, (h + 1) % numHubs, 20.0 };
+    }
+    for (int u = numHubs; u < numCities && count < numConnections; u++) {
+        connections[count++] = (struct Connection){ u, randomInt(0, numHubs - 1), 1.0 + 4.0 * randomUnit() };
+    }
+    while (count < numConnections) {
+        int h = randomInt(0, numHubs - 1);
+        int u = randomUnit() < 0.3 ? randomInt(0, numHubs - 1) : randomInt(0, numCities - 1);
+        if (u == h) continue;
+        connections[count++] = (struct Connection){ u, h, u < numHubs ? 10.0 + 20.0 * randomUnit() : 1.0 + 9.0 * randomUnit() };
+    }
+    return count;
+}
+
+/* Description: Runs "map": generates the connections of the chosen kind and writes them with their schedules.
+* Arguments: kind - grid, geometric or hub
+*            numCities, numConnections - sizes (numConnections 0 for the natural size)
+*            mapName - file to write
+*            settings - seed, transport mix and departures per day
+*/
+static void generateMap(const char *kind, int numCities, int numConnections, const char *mapName, const struct Settings *settings) {
+    int width = (int)ceil(sqrt((double)numCities));
+    int natural = strcmp(kind, "grid") == 0 ? 2 * width * width : 3 * numCities;
+    int capacity = numConnections > natural ? numConnections : natural;
+    struct Connection *connections = malloc((capacity > 0 ? capacity : 1) * sizeof(struct Connection));
+    if (connections == NULL) exit(0);
+    if (numConnections == 0 && strcmp(kind, "grid") != 0) numConnections = natural;
+
+    int count;
+    if (strcmp(kind, "grid") == 0) count = generateGrid(numCities, numConnections, connections);
+    else if (strcmp(kind, "geometric") == 0) count = generateGeometric(numCities, numConnections, connections);
+    else if (strcmp(kind, "hub") == 0) count = generateHub(numCities, numConnections, connections);
+    else {
+        fprintf(stderr, "unknown map kind \"%s\"\n", kind);
+        exit(0);
+    }
+
+    FILE *output = fopen(mapName, "w");
+    if (output == NULL) exit(0);
+
+    // Each transport gets its own speed and price per unit of distance
+    double speed[MAX_TRANSPORTS], price[MAX_TRANSPORTS];
+    for (int t = 0; t < settings->numTransports; t++) {
+        speed[t] = 2.0 + 8.0 * randomUnit();
+        price[t] = 1.0 + 9.0 * randomUnit();
+    }
+
+    fprintf(output, "%d %d\n", numCities, count);
+    for (int i = 0; i < count; i++) {
+        int t = pickTransport(settings);
+        int duration = 1 + (int)(connections[i].distance * speed[t] * (0.75 + 0.5 * randomUnit()));
+        int cost = 1 + (int)(connections[i].distance * price[t] * (0.75 + 0.5 * randomUnit()));
+
+        int first = randomInt(0, 359);
+        int last = first;
+        int period = 1440;
+        if (settings->departures > 1) {
+            last = randomInt(1080, 1439);
+            period = (last - first) / (settings->departures - 1);
+            period = period + randomInt(-period / 4, period / 4);
+            if (period < 1) period = 1;
+        }
+
+        fprintf(output, "%d %d %s %d %d %d %d %d\n", connections[i].from + 1, connections[i].to + 1,
+                settings->transports[t], duration, cost, first, last, period);
+    }
+
+    fclose(output);
+    free(connections);
+}
+
+/* Description: Runs "clients": reads a map for its size, transports and typical values, then writes random queries
+*              with the requested mix of filters and restrictions.
+* Arguments: mapName - map the clients travel on
+*            numClients - number of clients
+*            clientsName - file to write
+*            settings - seed, cost share and restriction probabilities
+*/
+static void generateClients(const char *mapName, int numClients, const char *clientsName, const struct Settings *settings) {
+    int numCities, numConnections;
+    char transports[MAX_TRANSPORTS][NAME_LEN];
+    int numTransports = 0;
+    double totalDuration = 0.0, totalCost = 0.0;
+
+    FILE *input = fopen(mapName, "r");
+    if (input == NULL) exit(0);
+    if (fscanf(input, "%d %d", &numCities, &numConnections) != 2 || numCities < 1) {
+        fprintf(stderr, "%s: not a map file\n", mapName);
+        exit(0);
+    }
+    for (int i = 0; i < numConnections; i++) {
+        int from, to, duration, cost, first, last, period;
+        char name[NAME_LEN];
+        if (fscanf(input, "%d %d %31s %d %d %d %d %d", &from, &to, name, &duration, &cost, &first, &last, &period) != 8) break;
+        totalDuration += duration;
+        totalCost += cost;
+        int t = 0;
+        while (t < numTransports && strcmp(transports[t], name) != 0) t++;
+        if (t == numTransports && numTransports < MAX_TRANSPORTS) strcpy(transports[numTransports++], name);
+    }
+    fclose(input);
+    int meanDuration = numConnections > 0 ? (int)(totalDuration / numConnections) + 1 : 1;
+    int meanCost = numConnections > 0 ? (int)(totalCost / numConnections) + 1 : 1;
+
+    FILE *output = fopen(clientsName, "w");
+    if (output == NULL) exit(0);
+
+    fprintf(output, "%d\n", numClients);
+    for (int i = 0; i < numClients; i++) {
+        int start = randomInt(1, numCities);
+        int end = randomInt(1, numCities);
+        int departure = randomInt(0, 2879);
+        const char *filter = randomUnit() < settings->costFraction ? "cost" : "duration";
+
+        // Restrictions are tried in random order; a client has at most 2 of them
+        int order[5] = { 0, 1, 2, 3, 4 };
+        for (int j = 4; j > 0; j--) {
+            int r = randomInt(0, j);
+            int swap = order[j];
+            order[j] = order[r];
+            order[r] = swap;
+        }
+        char restrictions[128] = "";
+        int numRestrictions = 0;
+        for (int j = 0; j < 5 && numRestrictions < 2; j++) {
+            int k = order[j];
+            if (randomUnit() >= settings->restriction[k]) continue;
+            char item[48];
+            switch (k) {
+                case 0:
+                    if (numTransports == 0) continue;
+                    snprintf(item, sizeof(item), " A1 %s", transports[randomInt(0, numTransports - 1)]);
+                    break;
+                case 1: snprintf(item, sizeof(item), " A2 %d", randomInt(meanDuration, 3 * meanDuration)); break;
+                case 2: snprintf(item, sizeof(item), " A3 %d", randomInt(meanCost, 3 * meanCost)); break;
+                case 3: snprintf(item, sizeof(item), " B1 %d", departure + randomInt(60, 2880)); break;
+                default: snprintf(item, sizeof(item), " B2 %d", randomInt(5 * meanCost, 100 * meanCost)); break;
+            }
+            strcat(restrictions, item);
+            numRestrictions++;
+        }
+        fprintf(output, "%d %d %d %d %s %d%s\n", i + 1, start, end, departure, filter, numRestrictions, restrictions);
+    }
+
+    fclose(output);
+}
+
+/* Description: Parses the options and the command, then generates the file.
+*/
+int main(int argc, char *argv[]) {
+    struct Settings settings;
+    settings.seed = 1;
+    settings.departures = 24;
+    settings.costFraction = 0.5;
+    parseTransports("bus:5,metro:3,train:2,plane:1", &settings);
+    parseRestrictions("A1=0.1,A2=0.1,A3=0.1,B1=0.1,B2=0.1", &settings);
+
+    char *positional[5];
+    int numPositional = 0;
+
+    for (int arg = 1; arg < argc; arg++) {
+        if (strcmp(argv[arg], "-s") == 0 && arg + 1 < argc) {
+            settings.seed = strtoull(argv[++arg], NULL, 10);
+        } else if (strcmp(argv[arg], "-t") == 0 && arg + 1 < argc) {
+            if (!parseTransports(argv[++arg], &settings)) usage(argv[0]);
+        } else if (strcmp(argv[arg], "-d") == 0 && arg + 1 < argc) {
+            settings.departures = atoi(argv[++arg]);
+            if (settings.departures < 1) usage(argv[0]);
+        } else if (strcmp(argv[arg], "-c") == 0 && arg + 1 < argc) {
+            settings.costFraction = atof(argv[++arg]);
+        } else if (strcmp(argv[arg], "-r") == 0 && arg + 1 < argc) {
+            if (!parseRestrictions(argv[++arg], &settings)) usage(argv[0]);
+        } else if (argv[arg][0] == '-' || numPositional == 5) {
+            usage(argv[0]);
+        } else {
+            positional[numPositional++] = argv[arg];
+        }
+    }
+    rngState = settings.seed;
+
+    if (numPositional == 5 && strcmp(positional[0], "map") == 0) {
+        int numCities = atoi(positional[2]);
+        int numConnections = atoi(positional[3]);
+        if (numCities < 2 || numConnections < 0) usage(argv[0]);
+        generateMap(positional[1], numCities, numConnections, positional[4], &settings);
+    } else if (numPositional == 4 && strcmp(positional[0], "clients") == 0) {
+        int numClients = atoi(positional[2]);
+        if (numClients < 0) usage(argv[0]);
+        generateClients(positional[1], numClients, positional[3], &settings);
+    } else {
+        usage(argv[0]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,349 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: graph.c
+* Description: Builds the map graph in compressed sparse row (CSR) layout.
+*/
+
+#include "graph.h"
+#include "scanner.h"
+#include "schedule.h"
+#include "arena.h"
+#include <limits.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/mman.h>
+
+/***********************************************************************************************************************
+ * setEdge()
+ *
+ * Arguments: edge - edge record to fill
+ *            path - connection read from the map file
+ *            destination - 1-based destination city of this direction
+ *            transport - interned id of the connection's transport
+ * Returns: void
+ * Side-Effects: none
+ *
+ * Description: copies the connection data into a CSR edge record.
+ ***********************************************************************************************************************/
+static void setEdge(struct Edge* edge, const struct Path* path, int destination, int transport) {
+    edge->destination = destination - 1;
+    edge->transport = transport;
+    edge->travelDuration = path->travelDuration;
+    edge->travelCost = path->travelCost;
+    edge->firstDeparture = path->firstDeparture;
+    edge->lastDeparture = path->lastDeparture;
+    edge->departurePeriodicity = path->departurePeriodicity;
+}
+
+/***********************************************************************************************************************
+ * transportSlot()
+ *
+ * Arguments: graph - pointer to the graph, with a transport index
+ *            name - transport name
+ * Returns: slot of the index holding the name's id, or the empty slot where it would go
+ * Side-Effects: none
+ *
+ * Description: open addressing with linear probing; the index is never more than half full.
+ ***********************************************************************************************************************/
+static int transportSlot(const struct Graph* graph, const char* name) {
+    int mask = 2 * graph->transportCapacity - 1;
+    int slot = (int)(fnv1a(FNV_OFFSET, name, strlen(name)) & (uint64_t)mask);
+    while (graph->transportIndex[slot] >= 0 && strcmp(graph->transports[graph->transportIndex[slot]], name) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/***********************************************************************************************************************
+ * growTransports()
+ *
+ * Arguments: graph - pointer to the graph
+ * Returns: void
+ * Side-Effects: doubles the dictionary and rebuilds its index, exits if memory runs out
+ *
+ * Description: the capacity stays a power of two, so the index mask is 2 * capacity - 1.
+ ***********************************************************************************************************************/
+static void growTransports(struct Graph* graph) {
+    graph->transportCapacity = graph->transportCapacity > 0 ? 2 * graph->transportCapacity : 16;
+    graph->transports = realloc(graph->transports, (size_t)graph->transportCapacity * TRANSPORT_NAME_LEN);
+    free(graph->transportIndex);
+    graph->transportIndex = malloc(2 * (size_t)graph->transportCapacity * sizeof(int));
+    if (graph->transports == NULL || graph->transportIndex == NULL) exit(0);
+    for (int slot = 0; slot < 2 * graph->transportCapacity; slot++) graph->transportIndex[slot] = -1;
+    for (int id = 0; id < graph->numTransports; id++) {
+        graph->transportIndex[transportSlot(graph, graph->transports[id])] = id;
+    }
+}
+
+/***********************************************************************************************************************
+ * findTransport()
+ *
+ * Arguments: graph - pointer to the graph
+ *            name - transport name
+ * Returns: id of the transport, or -1 if the map has no connection using it
+ * Side-Effects: none
+ *
+ * Description: looks a transport name up in the graph's dictionary.
+ ***********************************************************************************************************************/
+int findTransport(const struct Graph* graph, const char* name) {
+    if (graph->transportCapacity == 0) return -1;
+    return graph->transportIndex[transportSlot(graph, name)];
+}
+
+/***********************************************************************************************************************
+ * internTransport()
+ *
+ * Arguments: graph - pointer to the graph
+ *            name - transport name read from the map
+ * Returns: id of the transport
+ * Side-Effects: may add the name to the dictionary, growing it; exits if memory runs out
+ *
+ * Description: returns the id of a transport name, adding it to the dictionary the first time it is seen. Ids are
+ *              given in order of first appearance and never change. Names are stored zero padded, as the snapshot
+ *              writes them.
+ ***********************************************************************************************************************/
+int internTransport(struct Graph* graph, const char* name) {
+    int id = findTransport(graph, name);
+    if (id >= 0) return id;
+    if (graph->numTransports == graph->transportCapacity) growTransports(graph);
+    strncpy(graph->transports[graph->numTransports], name, TRANSPORT_NAME_LEN);
+    graph->transportIndex[transportSlot(graph, name)] = graph->numTransports;
+    return graph->numTransports++;
+}
+
+/***********************************************************************************************************************
+ * readConnection()
+ *
+ * Arguments: scanner - scanner over the map file
+ *            path - structure filled with the connection
+ *            cities - number of cities in the map
+ * Returns: 1 if the connection was read, 0 (after reporting the line) if it is malformed
+ * Side-Effects: consumes the eight fields of the connection
+ *
+ * Description: reads "origin destination transport duration cost firstDeparture lastDeparture periodicity".
+ ***********************************************************************************************************************/
+int readConnection(struct Scanner* scanner, struct Path* path, int cities) {
+    if (!expectInt(scanner, &path->originCity, "origin city")) return 0;
+    if (path->originCity < 1 || path->originCity > cities) {
+        scanError(scanner, "city out of range", "origin city");
+        return 0;
+    }
+    if (!expectInt(scanner, &path->destinationCity, "destination city")) return 0;
+    if (path->destinationCity < 1 || path->destinationCity > cities) {
+        scanError(scanner, "city out of range", "destination city");
+        return 0;
+    }
+    return expectWord(scanner, path->transport, sizeof(path->transport), "transport") &&
+           expectInt(scanner, &path->travelDuration, "duration") &&
+           expectInt(scanner, &path->travelCost, "cost") &&
+           expectInt(scanner, &path->firstDeparture, "first departure") &&
+           expectInt(scanner, &path->lastDeparture, "last departure") &&
+           expectInt(scanner, &path->departurePeriodicity, "periodicity");
+}
+
+/***********************************************************************************************************************
+ * loadGraph()
+ *
+ * Arguments: scanner - scanner over the map file
+ * Returns: pointer to the built graph, or NULL if the map is malformed or memory runs out (malformed input is
+ *          reported on stderr with its line number)
+ * Side-Effects: reads the whole map file
+ *               allocates dynamic memory
+ *
+ * Description: reads every connection and builds the CSR graph with a counting pass over the degrees and a prefix
+ *              sum. Each connection is stored twice (origin -> destination and destination -> origin). Edges are
+ *              placed from the end of each city's range so the neighbour order matches the linked lists the
+ *              program used before (last connection read comes first). The connections read and the cursors of
+ *              the filling pass come from one arena block sized from the header and are released with one free.
+ ***********************************************************************************************************************/
+struct Graph* loadGraph(struct Scanner* scanner) {
+    int cities, connections;
+
+    if (!expectInt(scanner, &cities, "number of cities")) return NULL;
+    if (!expectInt(scanner, &connections, "number of connections")) return NULL;
+    if (cities < 0 || cities == INT_MAX || connections < 0 || connections > INT_MAX / 2) {
+        scanError(scanner, "invalid map size", "header");
+        return NULL;
+    }
+
+    struct Arena arena;
+    if (!initArena(&arena, arenaBytes(connections, sizeof(struct Path)) + arenaBytes(connections, sizeof(int)) +
+                           arenaBytes(cities, sizeof(int)))) {
+        return NULL;
+    }
+    struct Path* paths = arenaAlloc(&arena, (size_t)connections * sizeof(struct Path));
+    int* transportIds = arenaAlloc(&arena, (size_t)connections * sizeof(int));
+    int* cursor = arenaAlloc(&arena, (size_t)cities * sizeof(int));
+
+    struct Graph* graph = malloc(sizeof(struct Graph));
+    if (!graph) {
+        freeArena(&arena);
+        return NULL;
+    }
+    graph->numCities = cities;
+    graph->numTransports = 0;
+    graph->transportCapacity = 0;
+    graph->transports = NULL;
+    graph->transportIndex = NULL;
+    graph->mapping = NULL;
+    graph->mappingLength = 0;
+    graph->removed = NULL;
+    graph->numEdges = 2 * connections;
+    graph->schedules.first = NULL;
+    graph->offsets = calloc(cities + 1, sizeof(int));
+    graph->edges = malloc((connections > 0 ? 2 * connections : 1) * sizeof(struct Edge));
+    if (!graph->offsets || !graph->edges) {
+        freeArena(&arena);
+        freeGraph(graph);
+        return NULL;
+    }
+
+    // Counting pass: offsets[u + 1] holds the degree of city u
+    for (int i = 0; i < connections; i++) {
+        struct Path* p = &paths[i];
+        if (!readConnection(scanner, p, cities)) {
+            freeArena(&arena);
+            freeGraph(graph);
+            return NULL;
+        }
+        transportIds[i] = internTransport(graph, p->transport);
+        graph->offsets[p->originCity]++;
+        graph->offsets[p->destinationCity]++;
+    }
+
+    // Prefix sum: offsets[u] becomes the first edge of city u
+    for (int u = 0; u < cities; u++) {
+        graph->offsets[u + 1] += graph->offsets[u];
+    }
+
+    // Fill each range backwards, using a cursor that starts at the end of the range
+    memcpy(cursor, graph->offsets + 1, cities * sizeof(int));
+
+    for (int i = 0; i < connections; i++) {
+        struct Path* p = &paths[i];
+        setEdge(&graph->edges[--cursor[p->originCity - 1]], p, p->destinationCity, transportIds[i]);
+        setEdge(&graph->edges[--cursor[p->destinationCity - 1]], p, p->originCity, transportIds[i]);
+    }
+
+    freeArena(&arena);
+    if (!buildSchedules(graph)) {
+        freeGraph(graph);
+        return NULL;
+    }
+    return graph;
+}
+
+/***********************************************************************************************************************
+ * fnv1a()
+ *
+ * Arguments: hash - running hash (FNV_OFFSET to start)
+ *            data - bytes to add
+ *            length - number of bytes
+ * Returns: updated hash
+ * Side-Effects: none
+ *
+ * Description: 64-bit FNV-1a hash.
+ ***********************************************************************************************************************/
+uint64_t fnv1a(uint64_t hash, const void* data, size_t length) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/***********************************************************************************************************************
+ * graphFingerprint()
+ *
+ * Arguments: graph - pointer to the graph
+ * Returns: hash of the city count, offsets and edges
+ * Side-Effects: none
+ *
+ * Description: a text map and the snapshot compiled from it have the same fingerprint, so files derived from either
+ *              (such as landmark tables) can be used with both.
+ ***********************************************************************************************************************/
+uint64_t graphFingerprint(const struct Graph* graph) {
+    uint64_t hash = fnv1a(FNV_OFFSET, &graph->numCities, sizeof(int));
+    hash = fnv1a(hash, graph->offsets, ((size_t)graph->numCities + 1) * sizeof(int));
+    return fnv1a(hash, graph->edges, (size_t)graph->numEdges * sizeof(struct Edge));
+}
+
+/***********************************************************************************************************************
+ * graphMaxStep()
+ *
+ * Arguments: graph - pointer to the graph
+ * Returns: largest travelCost or travelDuration + 1439 over all connections
+ * Side-Effects: none
+ *
+ * Description: a departure is never more than 1439 minutes away, so this bounds how much a relaxation can raise a
+ *              key above the key of the city being settled. It sizes the bucket queue.
+ ***********************************************************************************************************************/
+int graphMaxStep(const struct Graph* graph) {
+    int maxStep = 0;
+    for (int e = 0; e < graph->numEdges; e++) {
+        const struct Edge* edge = &graph->edges[e];
+        if (edge->travelCost > maxStep) maxStep = edge->travelCost;
+        if (edge->travelDuration > maxStep - 1439) maxStep = edge->travelDuration + 1439;
+    }
+    return maxStep;
+}
+
+/***********************************************************************************************************************
+ * detachGraph()
+ *
+ * Arguments: graph - pointer to the graph
+ * Returns: void
+ * Side-Effects: allocates the CSR arrays and the schedules, unmaps the snapshot, exits if memory runs out
+ *
+ * Description: a snapshot is mapped read only and shared with the file; a graph that is going to be edited first
+ *              gets its own copy. Graphs read from a text map are left as they are.
+ ***********************************************************************************************************************/
+void detachGraph(struct Graph* graph) {
+    if (graph->mapping == NULL) return;
+    size_t offsetsBytes = ((size_t)graph->numCities + 1) * sizeof(int);
+    size_t edgesBytes = (size_t)graph->numEdges * sizeof(struct Edge);
+    size_t schedulesBytes = 5 * scheduleStride(graph->numEdges);
+
+    int* offsets = malloc(offsetsBytes);
+    struct Edge* edges = malloc(edgesBytes > 0 ? edgesBytes : 1);
+    void* schedules = malloc(schedulesBytes > 0 ? schedulesBytes : 1);
+    if (offsets == NULL || edges == NULL || schedules == NULL) exit(0);
+    memcpy(offsets, graph->offsets, offsetsBytes);
+    memcpy(edges, graph->edges, edgesBytes);
+    memcpy(schedules, graph->schedules.first, schedulesBytes);
+
+    munmap(graph->mapping, graph->mappingLength);
+    graph->mapping = NULL;
+    graph->mappingLength = 0;
+    graph->offsets = offsets;
+    graph->edges = edges;
+    attachSchedules(graph, schedules, graph->schedules.maxDegree, graph->schedules.regular);
+}
+
+/***********************************************************************************************************************
+ * freeGraph()
+ *
+ * Arguments: graph - pointer to the graph
+ * Returns: void
+ * Side-Effects: frees dynamically allocated memory
+ *
+ * Description: frees the CSR arrays (or unmaps the snapshot they live in), the transport dictionary and the graph
+ *              structure.
+ ***********************************************************************************************************************/
+void freeGraph(struct Graph* graph) {
+    if (graph == NULL) return;
+    if (graph->mapping != NULL) {
+        munmap(graph->mapping, graph->mappingLength);
+    } else {
+        free(graph->offsets);
+        free(graph->edges);
+        free(graph->schedules.first);
+    }
+    free(graph->transports);
+    free(graph->transportIndex);
+    free(graph->removed);
+    free(graph);
+}
@@ -0,0 +1,113 @@
+/******************************************************************************
+ * NAME
+ *   graph.h
+ *
+ * DESCRIPTION
+ *   Header file for the compressed sparse row (CSR) representation of the map.
+ *
+ * COMMENTS
+ *   The outgoing edges of city u are edges[offsets[u]] .. edges[offsets[u+1]-1]
+ *   and are kept in the same order the old linked adjacency lists used
+ *   (most recently read connection first).
+ *   Transport names are interned into a per-graph dictionary when the map is
+ *   loaded; edges only carry the small integer id. The dictionary grows with
+ *   the map and is looked up through a hash index of its names.
+ *
+ ******************************************************************************/
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// Transport ids a 64-bit mask covers; A1 on maps with more transports compares ids instead
+#define TRANSPORT_MASK_BITS 64
+#define TRANSPORT_NAME_LEN 10
+
+// 64-bit FNV-1a parameters
+#define FNV_OFFSET 0xcbf29ce484222325ull
+#define FNV_PRIME 0x100000001b3ull
+
+// Connection as read from the map file
+struct Path {
+    int originCity;
+    int destinationCity;
+    char transport[10];
+    int travelDuration;
+    int travelCost;
+    int firstDeparture;
+    int lastDeparture;
+    int departurePeriodicity;
+};
+
+// Outgoing edge record stored contiguously per city
+struct Edge {
+    int destination;            // 0-based destination city
+    int transport;              // id in the graph's transport dictionary
+    int travelDuration;
+    int travelCost;
+    int firstDeparture;
+    int lastDeparture;
+    int departurePeriodicity;
+};
+
+// Departure schedules of the edges as a structure of arrays: entry e describes edges[e] (see schedule.h)
+struct Schedules {
+    int* first;                 // one block: first, last, period, duration and reciprocal, scheduleStride() bytes each
+    int* last;
+    int* period;
+    int* duration;
+    float* reciprocal;          // 1.0f / period
+    int maxDegree;              // most edges leaving one city
+    int regular;                // 1 if every schedule is within SCHEDULE_LIMIT, so edgeArrivals() may be used
+    int kernel;                 // ARRIVALS_* implementation picked for this machine
+};
+
+// Map graph in CSR layout
+struct Graph {
+    int numCities;
+    int numEdges;
+    int* offsets;               // numCities + 1 entries
+    struct Edge* edges;         // numEdges entries
+    struct Schedules schedules; // copy of the edges' timetables, laid out for vectorized waiting times
+    int numTransports;
+    int transportCapacity;
+    char (*transports)[TRANSPORT_NAME_LEN]; // transportCapacity names, the first numTransports in use
+    int* transportIndex;        // 2 * transportCapacity slots of ids by hash of the name (-1 if empty)
+    uint64_t* removed;          // bit e set if edges[e] is a removed connection left in place (see delta.h), NULL if none
+    void* mapping;              // snapshot mapping the arrays point into, NULL if they were allocated
+    size_t mappingLength;
+};
+
+struct Scanner;
+
+// Reads the map file and builds the CSR graph
+struct Graph* loadGraph(struct Scanner* scanner);
+
+// Reads "origin destination transport duration cost first last period"; returns 0 (after reporting) if malformed
+int readConnection(struct Scanner* scanner, struct Path* path, int cities);
+
+// Returns the id of a transport name, or -1 if no edge uses it
+int findTransport(const struct Graph* graph, const char* name);
+
+// Returns the id of a transport name, adding it to the dictionary if needed; exits if memory runs out
+int internTransport(struct Graph* graph, const char* name);
+
+// Copies the arrays of a graph mapped from a snapshot to dynamic memory, so they can be changed
+void detachGraph(struct Graph* graph);
+
+// 64-bit FNV-1a hash of a block of bytes, continuing from hash (FNV_OFFSET to start)
+uint64_t fnv1a(uint64_t hash, const void* data, size_t length);
+
+// Hash of the CSR arrays, used to tell whether precomputed data belongs to this map
+uint64_t graphFingerprint(const struct Graph* graph);
+
+// Largest amount one connection adds to a search key: its cost, or its duration plus the longest possible wait
+int graphMaxStep(const struct Graph* graph);
+
+// Frees the graph
+void freeGraph(struct Graph* graph);
+
+#endif
@@ -2,67 +2,106 @@
 * AED Project 2025/2026
 * Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
 * File: heap.c
-* Description: Implements functions for a min-heap, used by Dijkstra's algorithm.
+* Description: Implements the priority queues used by Dijkstra's algorithm and the other searches: d-ary min-heaps,
+*              a radix heap and a bucket queue (Dial).
 */
 
 #include "heap.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
 
 /***********************************************************************************************************************
  * parent()
  *
- * Arguments: i - index of a node in the heap
+ * Arguments: heap - pointer to the minHeap
+ *            i - index of a node in the heap
  * Returns: index of the parent node of i
  * Side-Effects: none
  *
- * Description: calculates the index of a parent node in a binary heap.
+ * Description: calculates the index of a parent node in a d-ary heap.
  ***********************************************************************************************************************/
-int parent(int i) {
-    return (i - 1) / 2;
+static int parent(const struct minHeap* heap, int i) {
+    return (i - 1) / heap->arity;
 }
 
 /***********************************************************************************************************************
- * left()
+ * createMinHeap()
  *
- * Arguments: i - index of a node in the heap
- * Returns: index of the left child node
- * Side-Effects: none
+ * Arguments: capacity - maximum capacity of the heap
+ * Returns: pointer to the created minHeap structure
+ * Side-Effects: allocates dynamic memory
  *
- * Description: calculates the index of a left child node in a binary heap.
+ * Description: creates and initializes a binary min-heap used in Dijkstra's algorithm to manage the vertex with
+ *              minimum weight.
  ***********************************************************************************************************************/
-int left(int i) {
-    return 2 * i + 1;
+struct minHeap* createMinHeap(int capacity) {
+    return createQueue(QUEUE_BINARY, capacity, 0);
 }
 
 /***********************************************************************************************************************
- * right()
+ * createQueue()
  *
- * Arguments: i - index of a node in the heap
- * Returns: index of the right child node
- * Side-Effects: none
+ * Arguments: kind - QUEUE_BINARY, QUEUE_QUATERNARY, QUEUE_RADIX or QUEUE_DIAL
+ *            capacity - number of cities (keys of the lists are city numbers 0 .. capacity-1)
+ *            maxStep - largest amount a key can exceed the last key extracted (sizes the bucket queue's window)
+ * Returns: pointer to the created queue
+ * Side-Effects: allocates dynamic memory, exits if memory runs out
  *
- * Description: calculates the index of a right child node in a binary heap.
+ * Description: heaps get an array of nodes; the radix heap and the bucket queue get their bucket heads and the
+ *              per-city links and keys. The bucket queue's window is the smallest power of two above maxStep, up
+ *              to DIAL_MAX_BUCKETS.
  ***********************************************************************************************************************/
-int right(int i) {
-    return 2 * i + 2;
+struct minHeap* createQueue(int kind, int capacity, int maxStep) {
+    struct minHeap* heap = (struct minHeap*)malloc(sizeof(struct minHeap));
+    if (heap == NULL) exit(0);
+    heap->kind = kind;
+    heap->size = 0;
+    heap->capacity = capacity;
+    heap->arity = kind == QUEUE_QUATERNARY ? 4 : 2;
+    heap->arr = NULL;
+    heap->head = heap->next = heap->prev = heap->key = NULL;
+    heap->numBuckets = 0;
+    heap->last = 0;
+    heap->limit = 0;
+    heap->inserts = heap->decreases = heap->extracts = 0;
+
+    if (kind == QUEUE_BINARY || kind == QUEUE_QUATERNARY) {
+        heap->arr = malloc(capacity * sizeof(struct heapNode));
+        if (heap->arr == NULL) exit(0);
+        return heap;
+    }
+
+    if (kind == QUEUE_RADIX) {
+        heap->numBuckets = 33;
+    } else {
+        heap->numBuckets = 1;
+        while (heap->numBuckets <= maxStep && heap->numBuckets < DIAL_MAX_BUCKETS) heap->numBuckets <<= 1;
+        heap->limit = heap->numBuckets;
+    }
+    heap->head = malloc((heap->numBuckets + 1) * sizeof(int));
+    heap->next = malloc(capacity * sizeof(int));
+    heap->prev = malloc(capacity * sizeof(int));
+    heap->key = malloc(capacity * sizeof(int));
+    if (heap->head == NULL || heap->next == NULL || heap->prev == NULL || heap->key == NULL) exit(0);
+    for (int b = 0; b <= heap->numBuckets; b++) heap->head[b] = -1;
+    return heap;
 }
 
 /***********************************************************************************************************************
- * createMinHeap()
+ * chooseQueue()
  *
- * Arguments: capacity - maximum capacity of the heap
- * Returns: pointer to the created minHeap structure
- * Side-Effects: allocates dynamic memory
+ * Arguments: kind - queue asked for on the command line
+ *            maxStep - largest step of a search on the map (see graphMaxStep())
+ * Returns: the queue to create
+ * Side-Effects: none
  *
- * Description: creates and initializes a min-heap used in Dijkstra's algorithm to manage the vertex with minimum weight.
+ * Description: resolves QUEUE_AUTO: the bucket queue when its window covers every step, so no key ever overflows
+ *              in Dijkstra, and the radix heap otherwise.
  ***********************************************************************************************************************/
-struct minHeap* createMinHeap(int capacity) {
-    struct minHeap* heap = (struct minHeap*)malloc(sizeof(struct minHeap));
-    heap->arr = malloc(capacity * sizeof(struct heapNode));
-    heap->size = 0;
-    heap->capacity = capacity;
-    return heap;
+int chooseQueue(int kind, int maxStep) {
+    if (kind != QUEUE_AUTO) return kind;
+    return maxStep < DIAL_MAX_BUCKETS ? QUEUE_DIAL : QUEUE_RADIX;
 }
 
 /***********************************************************************************************************************
@@ -89,15 +128,15 @@ void swap(struct heapNode* x, struct heapNode* y) {
  *            heapIndex - auxiliary array with each city's index in the heap
  * Returns: void
  * Side-Effects: updates heap positions and index array
- * 
+ *
  * Description: adjusts the heap to maintain the min-heap property after insertion or update.
  ***********************************************************************************************************************/
 void heapifyUp(struct minHeap* heap, int i, int* heapIndex) {
-    while (i != 0 && heap->arr[parent(i)].weight > heap->arr[i].weight) {
-        swap(&heap->arr[i], &heap->arr[parent(i)]);
+    while (i != 0 && heap->arr[parent(heap, i)].weight > heap->arr[i].weight) {
+        swap(&heap->arr[i], &heap->arr[parent(heap, i)]);
         heapIndex[heap->arr[i].city] = i;
-        heapIndex[heap->arr[parent(i)].city] = parent(i);
-        i = parent(i);
+        heapIndex[heap->arr[parent(heap, i)].city] = parent(heap, i);
+        i = parent(heap, i);
     }
 }
 
@@ -109,25 +148,146 @@ void heapifyUp(struct minHeap* heap, int i, int* heapIndex) {
  *            heapIndex - auxiliary array with each city's index in the heap
  * Returns: void
  * Side-Effects: updates heap positions and index array
- * 
- * Description: adjusts the heap to maintain the min-heap property after removing the minimum node or swapping the root.
+ *
+ * Description: adjusts the heap to maintain the min-heap property after removing the minimum node or swapping the
+ *              root. The first of several equally small children is chosen.
  ***********************************************************************************************************************/
 void heapifyDown(struct minHeap* heap, int i, int* heapIndex) {
-    int smallest = i;
-    int l = left(i);
-    int r = right(i);
+    while (1) {
+        int smallest = i;
+        int first = heap->arity * i + 1;
+        int end = first + heap->arity < heap->size ? first + heap->arity : heap->size;
 
-    if (l < heap->size && heap->arr[l].weight < heap->arr[smallest].weight)
-        smallest = l;
-    if (r < heap->size && heap->arr[r].weight < heap->arr[smallest].weight)
-        smallest = r;
+        for (int c = first; c < end; c++) {
+            if (heap->arr[c].weight < heap->arr[smallest].weight)
+                smallest = c;
+        }
+        if (smallest == i) return;
 
-    if (smallest != i) {
         swap(&heap->arr[i], &heap->arr[smallest]);
         heapIndex[heap->arr[i].city] = i;
         heapIndex[heap->arr[smallest].city] = smallest;
-        heapifyDown(heap, smallest, heapIndex);
+        i = smallest;
+    }
+}
+
+/***********************************************************************************************************************
+ * linkCity()
+ *
+ * Arguments: heap - radix heap or bucket queue
+ *            bucket - bucket to put the city in
+ *            city - queued city
+ *            heapIndex - auxiliary array with each city's bucket
+ * Returns: void
+ * Side-Effects: pushes the city at the front of the bucket's list
+ *
+ * Description: constant time insertion in a bucket.
+ ***********************************************************************************************************************/
+static void linkCity(struct minHeap* heap, int bucket, int city, int* heapIndex) {
+    int first = heap->head[bucket];
+    heap->next[city] = first;
+    heap->prev[city] = -1;
+    if (first != -1) heap->prev[first] = city;
+    heap->head[bucket] = city;
+    heapIndex[city] = bucket;
+}
+
+/***********************************************************************************************************************
+ * unlinkCity()
+ *
+ * Arguments: heap - radix heap or bucket queue
+ *            city - queued city
+ *            heapIndex - auxiliary array with each city's bucket
+ * Returns: void
+ * Side-Effects: removes the city from its bucket's list
+ *
+ * Description: constant time removal from a bucket.
+ ***********************************************************************************************************************/
+static void unlinkCity(struct minHeap* heap, int city, const int* heapIndex) {
+    int before = heap->prev[city];
+    int after = heap->next[city];
+    if (before != -1) heap->next[before] = after;
+    else heap->head[heapIndex[city]] = after;
+    if (after != -1) heap->prev[after] = before;
+}
+
+/***********************************************************************************************************************
+ * bucketOf()
+ *
+ * Arguments: heap - radix heap or bucket queue
+ *            key - key of a city, not below heap->last
+ * Returns: bucket the key belongs to
+ * Side-Effects: none
+ *
+ * Description: radix heap: 0 for the last key extracted, otherwise one plus the highest bit in which the key differs
+ *              from it. Bucket queue: the key modulo the window inside the window, the overflow list after it.
+ ***********************************************************************************************************************/
+static int bucketOf(const struct minHeap* heap, int key) {
+    if (heap->kind == QUEUE_DIAL) {
+        return key < heap->limit ? (key & (heap->numBuckets - 1)) : heap->numBuckets;
+    }
+    unsigned int diff = (unsigned int)key ^ (unsigned int)heap->last;
+    if (diff == 0) return 0;
+#if defined(__GNUC__)
+    return 32 - __builtin_clz(diff);
+#else
+    int bucket = 0;
+    while (diff != 0) {
+        diff >>= 1;
+        bucket++;
+    }
+    return bucket;
+#endif
+}
+
+/***********************************************************************************************************************
+ * settle()
+ *
+ * Arguments: heap - radix heap or bucket queue, not empty
+ *            heapIndex - auxiliary array with each city's bucket
+ * Returns: bucket holding the cities with the smallest key, which is now heap->last, or -1 if no bucket holds a city
+ * Side-Effects: may move cities between buckets
+ *
+ * Description: radix heap: if bucket 0 is empty, the smallest key of the first non-empty bucket becomes the last
+ *              key and that bucket's cities are spread over the lower buckets. Bucket queue: the window is walked
+ *              from the last key; once it is empty, the window restarts at the smallest overflowing key and the
+ *              overflowing keys that fit move into it.
+ ***********************************************************************************************************************/
+static int settle(struct minHeap* heap, int* heapIndex) {
+    int bucket = 0;
+
+    if (heap->kind == QUEUE_DIAL) {
+        int mask = heap->numBuckets - 1;
+        for (int k = heap->last; k < heap->limit; k++) {
+            if (heap->head[k & mask] != -1) {
+                heap->last = k;
+                return k & mask;
+            }
+        }
+        bucket = heap->numBuckets;
+    } else {
+        if (heap->head[0] != -1) return 0;
+        while (bucket < heap->numBuckets && heap->head[bucket] == -1) bucket++;
     }
+    if (heap->head[bucket] == -1) return -1;
+
+    int smallest = INT_MAX;
+    for (int city = heap->head[bucket]; city != -1; city = heap->next[city]) {
+        if (heap->key[city] < smallest) smallest = heap->key[city];
+    }
+    heap->last = smallest;
+    if (heap->kind == QUEUE_DIAL) {
+        heap->limit = smallest > INT_MAX - heap->numBuckets ? INT_MAX : smallest + heap->numBuckets;
+    }
+
+    int city = heap->head[bucket];
+    heap->head[bucket] = -1;
+    while (city != -1) {
+        int next = heap->next[city];
+        linkCity(heap, bucketOf(heap, heap->key[city]), city, heapIndex);
+        city = next;
+    }
+    return bucketOf(heap, smallest);
 }
 
 /***********************************************************************************************************************
@@ -139,13 +299,28 @@ void heapifyDown(struct minHeap* heap, int i, int* heapIndex) {
  *            heapIndex - auxiliary array with each city's index in the heap
  * Returns: void
  * Side-Effects: updates heap and index array, increases heap size
- * 
- * Description: inserts a new node and readjusts the heap to maintain the min-heap property.
+ *
+ * Description: inserts a new node and readjusts the heap to maintain the min-heap property. A monotone queue that is
+ *              empty restarts from the key when it is below the last one extracted (the first key of a search, such
+ *              as a negative departure time), so every key it holds is at least heap->last.
  ***********************************************************************************************************************/
 void insertMinHeap(struct minHeap* heap, int city, int weight, int* heapIndex) {
     if (heap == NULL || heap->size == heap->capacity) {
         return;
     }
+    STAT(heap->inserts++);
+    if (heap->arr == NULL) {
+        if (heap->size == 0 && weight < heap->last) {
+            heap->last = weight;
+            if (heap->kind == QUEUE_DIAL) {
+                heap->limit = weight > INT_MAX - heap->numBuckets ? INT_MAX : weight + heap->numBuckets;
+            }
+        }
+        heap->key[city] = weight;
+        linkCity(heap, bucketOf(heap, weight), city, heapIndex);
+        heap->size++;
+        return;
+    }
     int i = heap->size++;
     heapIndex[city] = i;
     heap->arr[i].city = city;
@@ -158,16 +333,32 @@ void insertMinHeap(struct minHeap* heap, int city, int weight, int* heapIndex) {
  *
  * Arguments: heap - pointer to the minHeap
  *            heapIndex - auxiliary array with each city's index in the heap
- * Returns: heapNode structure with minimum city and weight
+ * Returns: heapNode structure with minimum city and weight, city -1 if the queue is empty
  * Side-Effects: reduces heap size and updates indices
- * 
- * Description: removes and returns the node with minimum weight and readjusts the heap.
+ *
+ * Description: removes and returns the node with minimum weight and readjusts the heap. A monotone queue whose
+ *              buckets hold no city although its size says otherwise is emptied, so no empty bucket is read.
  ***********************************************************************************************************************/
 struct heapNode extractMin(struct minHeap* heap, int* heapIndex) {
     struct heapNode minNode = { -1, -1 };
     if (heap->size <= 0) {
         return minNode;
     }
+    STAT(heap->extracts++);
+
+    if (heap->arr == NULL) {
+        int bucket = settle(heap, heapIndex);
+        if (bucket < 0) {
+            clearMinHeap(heap);
+            return minNode;
+        }
+        minNode.city = heap->head[bucket];
+        minNode.weight = heap->key[minNode.city];
+        unlinkCity(heap, minNode.city, heapIndex);
+        heapIndex[minNode.city] = -2;
+        heap->size--;
+        return minNode;
+    }
 
     minNode = heap->arr[0];
     struct heapNode lastNode = heap->arr[heap->size - 1];
@@ -187,28 +378,77 @@ struct heapNode extractMin(struct minHeap* heap, int* heapIndex) {
  * decreaseKey()
  *
  * Arguments: heap - pointer to the minHeap
- *            index - node index in the heap
+ *            city - queued city
  *            newWeight - new weight value
  *            heapIndex - auxiliary array with each city's index in the heap
  * Returns: void
  * Side-Effects: updates node weight and reorganizes the heap if necessary
- * 
- * Description: updates the weight of a node and moves it up if the min-heap property is violated.
+ *
+ * Description: updates the weight of a node and moves it up (or to its new bucket) if it decreased.
  ***********************************************************************************************************************/
-void decreaseKey(struct minHeap* heap, int index, int newWeight, int* heapIndex) {
+void decreaseKey(struct minHeap* heap, int city, int newWeight, int* heapIndex) {
+    STAT(heap->decreases++);
+    if (heap->arr == NULL) {
+        if (heap->key[city] > newWeight) {
+            unlinkCity(heap, city, heapIndex);
+            heap->key[city] = newWeight;
+            linkCity(heap, bucketOf(heap, newWeight), city, heapIndex);
+        }
+        return;
+    }
+    int index = heapIndex[city];
     if(heap->arr[index].weight > newWeight) {
         heap->arr[index].weight = newWeight;
         heapifyUp(heap, index, heapIndex);
     }
 }
 
+/***********************************************************************************************************************
+ * minKey()
+ *
+ * Arguments: heap - pointer to the minHeap, not empty
+ *            heapIndex - auxiliary array with each city's index in the heap
+ * Returns: smallest weight in the queue
+ * Side-Effects: the radix heap and the bucket queue may move cities between buckets
+ *
+ * Description: looks at the minimum without removing it.
+ ***********************************************************************************************************************/
+int minKey(struct minHeap* heap, int* heapIndex) {
+    if (heap->arr == NULL) {
+        settle(heap, heapIndex);
+        return heap->last;
+    }
+    return heap->arr[0].weight;
+}
+
+/***********************************************************************************************************************
+ * clearMinHeap()
+ *
+ * Arguments: heap - pointer to the minHeap
+ * Returns: void
+ * Side-Effects: empties the queue
+ *
+ * Description: drops every queued city (their heapIndex entries are left as they are) and restarts the monotone
+ *              queues from key 0.
+ ***********************************************************************************************************************/
+void clearMinHeap(struct minHeap* heap) {
+    if (heap->arr == NULL) {
+        if (heap->size > 0) {
+            for (int b = 0; b <= heap->numBuckets; b++) heap->head[b] = -1;
+        }
+        heap->last = 0;
+        if (heap->kind == QUEUE_DIAL) heap->limit = heap->numBuckets;
+    }
+    heap->size = 0;
+}
+
 /***********************************************************************************************************************
  * isEmpty()
  *
  * Arguments: heap - pointer to the minHeap
  * Returns: 1 if the heap is empty, 0 otherwise
  * Side-Effects: none
- * 
+ *
  * Description: checks if the heap is empty
  ***********************************************************************************************************************/
 int isEmpty(struct minHeap* heap) {
@@ -221,10 +461,14 @@ int isEmpty(struct minHeap* heap) {
  * Arguments: heap - pointer to the minHeap
  * Returns: void
  * Side-Effects: frees dynamically allocated memory for the heap
- * 
+ *
  * Description: frees all memory allocated by the heap.
  ***********************************************************************************************************************/
 void freeMinHeap(struct minHeap* heap) {
     free(heap->arr);
+    free(heap->head);
+    free(heap->next);
+    free(heap->prev);
+    free(heap->key);
     free(heap);
 }
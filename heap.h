@@ -3,41 +3,76 @@
  *   heap.h
  *
  * DESCRIPTION
- *   Header file for the min-heap implementation used in Dijkstra's algorithm.
+ *   Header file for the priority queues used by the searches: binary and
+ *   4-ary min-heaps, a radix heap and a bucket queue (Dial).
  *
  * COMMENTS
+ *   All queues share one interface and keep each queued city's position in
+ *   the caller's heapIndex array (-1 never queued, -2 extracted, >= 0
+ *   queued). The radix heap and the bucket queue are monotone: a key must
+ *   never be smaller than the last key extracted, which holds for Dijkstra,
+ *   A* with consistent bounds and the hierarchy searches. An empty one
+ *   restarts at the first key it is given, which may be negative (duration
+ *   searches leaving before time 0). The binary heap is the default because
+ *   the order in which it extracts equal keys decides which of several
+ *   optimal paths is written.
  *
  ******************************************************************************/
 
 #ifndef HEAP_H
 #define HEAP_H
 
+#include "stats.h"
+
+// Queue implementations
+#define QUEUE_BINARY 0          // binary heap
+#define QUEUE_QUATERNARY 1      // 4-ary heap: half the depth, the children of a node are adjacent
+#define QUEUE_RADIX 2           // radix heap: 33 buckets by highest bit differing from the last key extracted
+#define QUEUE_DIAL 3            // bucket queue: one bucket per key in a sliding window, larger keys overflow
+#define QUEUE_AUTO 4            // Dial if the largest step of a search fits in DIAL_MAX_BUCKETS, radix otherwise
+
+// Largest window of the bucket queue
+#define DIAL_MAX_BUCKETS (1 << 16)
+
 // Heap node structure
 struct heapNode {
     int city;
     int weight;
 };
 
-// Min-heap structure
+// Priority queue structure
 struct minHeap {
+    int kind;                   // QUEUE_*
     int size;
     int capacity;
-    struct heapNode* arr;
+    struct heapNode* arr;       // binary and 4-ary heaps
+    int arity;
+    int numBuckets;             // radix heap and bucket queue: lists of cities chained through next/prev
+    int* head;                  // first city of each bucket (the bucket queue's overflow list is the last one)
+    int* next;
+    int* prev;
+    int* key;
+    int last;                   // last key extracted (lower bound on every key)
+    int limit;                  // bucket queue: keys from limit on go to the overflow list
+    long long inserts;          // operations counted in STATS=1 builds
+    long long decreases;
+    long long extracts;
 };
 
-// Heap utility functions
-int parent(int i);
-int left(int i);
-int right(int i);
-
-// Min-heap operations
+// Queue creation
 struct minHeap* createMinHeap(int capacity);
+struct minHeap* createQueue(int kind, int capacity, int maxStep);
+int chooseQueue(int kind, int maxStep);
+
+// Queue operations
 void swap(struct heapNode* x, struct heapNode* y);
 void heapifyUp(struct minHeap* heap, int i, int* heapIndex);
 void heapifyDown(struct minHeap* heap, int i, int* heapIndex);
 void insertMinHeap(struct minHeap* heap, int city, int weight, int* heapIndex);
 struct heapNode extractMin(struct minHeap* heap, int* heapIndex);
-void decreaseKey(struct minHeap* heap, int index, int newWeight, int* heapIndex);
+void decreaseKey(struct minHeap* heap, int city, int newWeight, int* heapIndex);
+int minKey(struct minHeap* heap, int* heapIndex);
+void clearMinHeap(struct minHeap* heap);
 int isEmpty(struct minHeap* heap);
 void freeMinHeap(struct minHeap* heap);
 
@@ -0,0 +1,736 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: hierarchy.c
+* Description: Contraction hierarchy for cost queries without filters: node contraction with witness searches,
+*              the .ch file format, and the bidirectional upward query with shortcut unpacking.
+*/
+
+#include "hierarchy.h"
+#include "heap.h"
+#include <string.h>
+#include <stdlib.h>
+
+// Cities settled by one witness search before it gives up (a missed witness only adds a redundant shortcut)
+#define WITNESS_SETTLED 256
+// Smaller limit used when a contraction is only simulated to compute a priority
+#define SIMULATE_SETTLED 32
+// A city with more remaining neighbours than this is not contracted: it and every city left form the core
+#define CORE_DEGREE 64
+// Contraction also stops once the cities left have more than this many neighbours on average
+#define CORE_AVERAGE_DEGREE 24
+
+// Neighbour of a city in the graph being contracted
+struct Neighbour {
+    int city;
+    int weight;
+    int arc;                    // arc from the owner of the list to city
+};
+
+struct NeighbourList {
+    struct Neighbour* items;
+    int size;
+    int capacity;
+};
+
+// State of the contraction
+struct Builder {
+    int numCities;
+    struct NeighbourList* lists;
+    struct HierarchyArc* arcs;
+    int* weights;               // weight of each arc
+    int numArcs;
+    int arcCapacity;
+    char* contracted;
+    int* deleted;               // number of contracted neighbours, used in the priority
+    long long remainingArcs;    // total size of the neighbour lists of the cities not yet contracted
+    struct Workspace* ws;       // witness searches
+};
+
+/***********************************************************************************************************************
+ * addArc()
+ *
+ * Arguments: builder - contraction state
+ *            from, to - cities joined by the arc
+ *            weight - cost of the arc
+ *            first, second - edge index and -1 for a connection, or the two arcs a shortcut is made of
+ * Returns: index of the new arc
+ * Side-Effects: may grow the arc arrays, exits if memory runs out
+ *
+ * Description: appends an arc.
+ ***********************************************************************************************************************/
+static int addArc(struct Builder* builder, int from, int to, int weight, int first, int second) {
+    if (builder->numArcs == builder->arcCapacity) {
+        builder->arcCapacity = builder->arcCapacity > 0 ? 2 * builder->arcCapacity : 1024;
+        builder->arcs = realloc(builder->arcs, builder->arcCapacity * sizeof(struct HierarchyArc));
+        builder->weights = realloc(builder->weights, builder->arcCapacity * sizeof(int));
+        if (builder->arcs == NULL || builder->weights == NULL) exit(0);
+    }
+    struct HierarchyArc* arc = &builder->arcs[builder->numArcs];
+    arc->from = from;
+    arc->to = to;
+    arc->first = first;
+    arc->second = second;
+    builder->weights[builder->numArcs] = weight;
+    return builder->numArcs++;
+}
+
+/***********************************************************************************************************************
+ * findNeighbour()
+ *
+ * Arguments: list - neighbour list
+ *            city - city to look for
+ * Returns: position of city in the list, -1 if absent
+ * Side-Effects: none
+ *
+ * Description: linear search; the lists of the cities being contracted are short.
+ ***********************************************************************************************************************/
+static int findNeighbour(const struct NeighbourList* list, int city) {
+    for (int i = 0; i < list->size; i++) {
+        if (list->items[i].city == city) return i;
+    }
+    return -1;
+}
+
+/***********************************************************************************************************************
+ * setNeighbour()
+ *
+ * Arguments: list - neighbour list
+ *            city - neighbour city
+ *            weight - cost of the arc
+ *            arc - arc index
+ *            position - position of city in the list, or -1 to append it
+ * Returns: void
+ * Side-Effects: may grow the list, exits if memory runs out
+ *
+ * Description: appends a neighbour or replaces the arc to an existing one.
+ ***********************************************************************************************************************/
+static void setNeighbour(struct NeighbourList* list, int city, int weight, int arc, int position) {
+    if (position < 0) {
+        if (list->size == list->capacity) {
+            list->capacity = list->capacity > 0 ? 2 * list->capacity : 4;
+            list->items = realloc(list->items, list->capacity * sizeof(struct Neighbour));
+            if (list->items == NULL) exit(0);
+        }
+        position = list->size++;
+    }
+    list->items[position].city = city;
+    list->items[position].weight = weight;
+    list->items[position].arc = arc;
+}
+
+/***********************************************************************************************************************
+ * witnessSearch()
+ *
+ * Arguments: builder - contraction state
+ *            source - city the search starts from
+ *            skip - city being contracted, ignored by the search
+ *            limit - the search stops once the next city is farther than this
+ *            maxSettled - or once it has settled this many cities
+ * Returns: void
+ * Side-Effects: overwrites the builder's workspace
+ *
+ * Description: bounded Dijkstra over the cities not yet contracted. Tentative costs are costs of real paths, so
+ *              they can serve as witnesses too.
+ ***********************************************************************************************************************/
+static void witnessSearch(struct Builder* builder, int source, int skip, int limit, int maxSettled) {
+    struct Workspace* ws = builder->ws;
+    int settled = 0;
+
+    resetWorkspace(ws);
+    touchCity(ws, source);
+    ws->weight[source] = 0;
+    insertMinHeap(ws->heap, source, 0, ws->heapIndex);
+
+    while (!isEmpty(ws->heap)) {
+        struct heapNode minNode = extractMin(ws->heap, ws->heapIndex);
+        int u = minNode.city;
+        if (minNode.weight > limit || ++settled > maxSettled) break;
+
+        const struct NeighbourList* list = &builder->lists[u];
+        for (int i = 0; i < list->size; i++) {
+            int v = list->items[i].city;
+            if (v == skip) continue;
+            touchCity(ws, v);
+            if (ws->heapIndex[v] == -2) continue;
+
+            int newWeight = ws->weight[u] + list->items[i].weight;
+            if (newWeight < ws->weight[v]) {
+                ws->weight[v] = newWeight;
+                if (ws->heapIndex[v] == -1) {
+                    insertMinHeap(ws->heap, v, newWeight, ws->heapIndex);
+                } else {
+                    decreaseKey(ws->heap, v, newWeight, ws->heapIndex);
+                }
+            }
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ * contract()
+ *
+ * Arguments: builder - contraction state
+ *            v - city to contract (or to simulate)
+ *            apply - 0 only counts the shortcuts, 1 adds them and removes v from the graph
+ * Returns: number of shortcuts needed
+ * Side-Effects: if apply, adds shortcut arcs and updates the neighbour lists
+ *
+ * Description: for every pair of neighbours u, w of v, a shortcut u - w is needed unless a witness search from u
+ *              that avoids v finds a path no more expensive than u - v - w. Both directions get their own arc so
+ *              each can be unpacked in order. v's list is left untouched: it becomes its upward arcs.
+ ***********************************************************************************************************************/
+static int contract(struct Builder* builder, int v, int apply) {
+    struct NeighbourList* list = &builder->lists[v];
+    int shortcuts = 0;
+
+    for (int i = 0; i < list->size; i++) {
+        int u = list->items[i].city;
+        int maxVia = 0;
+        for (int j = i + 1; j < list->size; j++) {
+            int via = list->items[i].weight + list->items[j].weight;
+            if (via > maxVia) maxVia = via;
+        }
+        if (i + 1 == list->size) break;
+        witnessSearch(builder, u, v, maxVia, apply ? WITNESS_SETTLED : SIMULATE_SETTLED);
+
+        for (int j = i + 1; j < list->size; j++) {
+            int w = list->items[j].city;
+            int via = list->items[i].weight + list->items[j].weight;
+            int witness = builder->ws->stamp[w] == builder->ws->epoch ? builder->ws->weight[w] : INF;
+            if (witness <= via) continue;
+
+            shortcuts++;
+            if (!apply) continue;
+
+            int uv = builder->lists[u].items[findNeighbour(&builder->lists[u], v)].arc;
+            int wv = builder->lists[w].items[findNeighbour(&builder->lists[w], v)].arc;
+            int uw = addArc(builder, u, w, via, uv, list->items[j].arc);
+            int wu = addArc(builder, w, u, via, wv, list->items[i].arc);
+            int position = findNeighbour(&builder->lists[u], w);
+            if (position < 0) builder->remainingArcs += 2;
+            setNeighbour(&builder->lists[u], w, via, uw, position);
+            setNeighbour(&builder->lists[w], u, via, wu, findNeighbour(&builder->lists[w], u));
+        }
+    }
+
+    if (apply) {
+        for (int i = 0; i < list->size; i++) {
+            struct NeighbourList* other = &builder->lists[list->items[i].city];
+            int position = findNeighbour(other, v);
+            other->items[position] = other->items[--other->size];
+            builder->deleted[list->items[i].city]++;
+        }
+        builder->contracted[v] = 1;
+        builder->remainingArcs -= 2 * list->size;
+    }
+    return shortcuts;
+}
+
+/***********************************************************************************************************************
+ * priority()
+ *
+ * Arguments: builder - contraction state
+ *            v - city not yet contracted
+ * Returns: contraction priority (lower is contracted first)
+ * Side-Effects: runs the witness searches of a simulated contraction
+ *
+ * Description: twice the edge difference (shortcuts added minus arcs removed) plus the number of contracted
+ *              neighbours, which spreads the contraction evenly over the map.
+ ***********************************************************************************************************************/
+static int priority(struct Builder* builder, int v) {
+    return 2 * (contract(builder, v, 0) - builder->lists[v].size) + builder->deleted[v];
+}
+
+/***********************************************************************************************************************
+ * initBuilder()
+ *
+ * Arguments: builder - contraction state to fill
+ *            graph - map graph in CSR layout
+ * Returns: void
+ * Side-Effects: allocates dynamic memory, exits if memory runs out
+ *
+ * Description: one arc per ordered pair of neighbouring cities, using the cheapest of their parallel connections
+ *              (the first one in CSR order on ties). Loops are dropped: they are never on a cheapest path.
+ ***********************************************************************************************************************/
+static void initBuilder(struct Builder* builder, const struct Graph* graph) {
+    int n = graph->numCities;
+    memset(builder, 0, sizeof(*builder));
+    builder->numCities = n;
+    builder->lists = calloc(n > 0 ? n : 1, sizeof(struct NeighbourList));
+    builder->contracted = calloc(n > 0 ? n : 1, 1);
+    builder->deleted = calloc(n > 0 ? n : 1, sizeof(int));
+    int* position = malloc((n > 0 ? n : 1) * sizeof(int));
+    int* owner = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (builder->lists == NULL || builder->contracted == NULL || builder->deleted == NULL || position == NULL || owner == NULL) exit(0);
+    builder->ws = createWorkspace(n);
+
+    for (int v = 0; v < n; v++) {
+        owner[v] = -1;
+    }
+    for (int u = 0; u < n; u++) {
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            int v = graph->edges[e].destination;
+            int cost = graph->edges[e].travelCost;
+            if (v == u) continue;
+            if (owner[v] != u) {
+                owner[v] = u;
+                position[v] = builder->lists[u].size;
+                setNeighbour(&builder->lists[u], v, cost, addArc(builder, u, v, cost, e, -1), -1);
+                builder->remainingArcs++;
+            } else if (cost < builder->lists[u].items[position[v]].weight) {
+                int arc = builder->lists[u].items[position[v]].arc;
+                builder->arcs[arc].first = e;
+                builder->weights[arc] = cost;
+                builder->lists[u].items[position[v]].weight = cost;
+            }
+        }
+    }
+    free(position);
+    free(owner);
+}
+
+/***********************************************************************************************************************
+ * buildHierarchy()
+ *
+ * Arguments: graph - map graph in CSR layout
+ * Returns: pointer to the hierarchy
+ * Side-Effects: allocates dynamic memory, exits if memory runs out
+ *
+ * Description: contracts cities in order of priority with lazy updates: the city at the top of the queue is
+ *              re-evaluated and only contracted if it is still the best, otherwise it goes back with its new
+ *              priority. Contraction stops at the first city with more than CORE_DEGREE neighbours left; the
+ *              remaining cities keep all their arcs between them. The neighbour list of every city at that point
+ *              is its list of upward arcs.
+ ***********************************************************************************************************************/
+struct Hierarchy* buildHierarchy(const struct Graph* graph) {
+    struct Builder builder;
+    int n = graph->numCities;
+
+    initBuilder(&builder, graph);
+
+    struct minHeap* queue = createMinHeap(n > 0 ? n : 1);
+    int* queueIndex = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (queue == NULL || queueIndex == NULL) exit(0);
+    for (int v = 0; v < n; v++) {
+        insertMinHeap(queue, v, priority(&builder, v), queueIndex);
+    }
+
+    int remaining = n;
+    while (!isEmpty(queue)) {
+        struct heapNode top = extractMin(queue, queueIndex);
+        int v = top.city;
+        int current = priority(&builder, v);
+        if (!isEmpty(queue) && current > minKey(queue, queueIndex)) {
+            insertMinHeap(queue, v, current, queueIndex);
+            continue;
+        }
+        if (builder.lists[v].size > CORE_DEGREE || builder.remainingArcs > (long long)CORE_AVERAGE_DEGREE * remaining) break;
+        contract(&builder, v, 1);
+        remaining--;
+    }
+    freeMinHeap(queue);
+    free(queueIndex);
+
+    struct Hierarchy* hierarchy = malloc(sizeof(struct Hierarchy));
+    if (hierarchy == NULL) exit(0);
+    hierarchy->numCities = n;
+    hierarchy->numArcs = builder.numArcs;
+    hierarchy->coreSize = remaining;
+    hierarchy->arcs = builder.arcs;
+    hierarchy->upOffsets = malloc((n + 1) * sizeof(int));
+    hierarchy->core = malloc(n > 0 ? n : 1);
+    if (hierarchy->upOffsets == NULL || hierarchy->core == NULL) exit(0);
+    for (int v = 0; v < n; v++) {
+        hierarchy->core[v] = !builder.contracted[v];
+    }
+
+    hierarchy->upOffsets[0] = 0;
+    for (int v = 0; v < n; v++) {
+        hierarchy->upOffsets[v + 1] = hierarchy->upOffsets[v] + builder.lists[v].size;
+    }
+    hierarchy->numUpward = hierarchy->upOffsets[n];
+    hierarchy->upward = malloc((hierarchy->numUpward > 0 ? hierarchy->numUpward : 1) * sizeof(struct UpwardArc));
+    if (hierarchy->upward == NULL) exit(0);
+    for (int v = 0; v < n; v++) {
+        struct UpwardArc* upward = hierarchy->upward + hierarchy->upOffsets[v];
+        for (int i = 0; i < builder.lists[v].size; i++) {
+            upward[i].to = builder.lists[v].items[i].city;
+            upward[i].weight = builder.lists[v].items[i].weight;
+            upward[i].arc = builder.lists[v].items[i].arc;
+        }
+        free(builder.lists[v].items);
+    }
+
+    free(builder.lists);
+    free(builder.weights);
+    free(builder.contracted);
+    free(builder.deleted);
+    freeWorkspace(builder.ws);
+    return hierarchy;
+}
+
+/***********************************************************************************************************************
+ * writeHierarchy()
+ *
+ * Arguments: hierarchy - hierarchy to store
+ *            graph - graph it was built from
+ *            output - binary output file
+ * Returns: 1 on success, 0 if a write failed
+ * Side-Effects: writes the file
+ *
+ * Description: writes the header, the arcs, the upward offsets, the upward arcs and the core flags.
+ ***********************************************************************************************************************/
+int writeHierarchy(const struct Hierarchy* hierarchy, const struct Graph* graph, FILE* output) {
+    struct HierarchyHeader header;
+    int n = hierarchy->numCities;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HIERARCHY_MAGIC, sizeof(header.magic));
+    header.version = HIERARCHY_VERSION;
+    header.numCities = graph->numCities;
+    header.numEdges = graph->numEdges;
+    header.numArcs = hierarchy->numArcs;
+    header.numUpward = hierarchy->numUpward;
+    header.coreSize = hierarchy->coreSize;
+    header.fingerprint = graphFingerprint(graph);
+
+    if (fwrite(&header, sizeof(header), 1, output) != 1) return 0;
+    if (fwrite(hierarchy->arcs, sizeof(struct HierarchyArc), hierarchy->numArcs, output) != (size_t)hierarchy->numArcs) return 0;
+    if (fwrite(hierarchy->upOffsets, sizeof(int), n + 1, output) != (size_t)n + 1) return 0;
+    if (fwrite(hierarchy->upward, sizeof(struct UpwardArc), hierarchy->numUpward, output) != (size_t)hierarchy->numUpward) return 0;
+    if (fwrite(hierarchy->core, 1, n, output) != (size_t)n) return 0;
+    return fflush(output) == 0;
+}
+
+/***********************************************************************************************************************
+ * readHierarchy()
+ *
+ * Arguments: input - binary .ch file
+ *            graph - graph the queries will run on
+ *            name - file name, used in error messages
+ * Returns: pointer to the hierarchy, or NULL if the file cannot be used
+ * Side-Effects: allocates dynamic memory, reports problems on stderr
+ *
+ * Description: the hierarchy is only accepted if it was built from exactly this map (same fingerprint).
+ ***********************************************************************************************************************/
+struct Hierarchy* readHierarchy(FILE* input, const struct Graph* graph, const char* name) {
+    struct HierarchyHeader header;
+    const char* problem = NULL;
+
+    if (fread(&header, sizeof(header), 1, input) != 1) problem = "truncated hierarchy file";
+    else if (memcmp(header.magic, HIERARCHY_MAGIC, sizeof(header.magic)) != 0) problem = "not a hierarchy file";
+    else if (header.version != HIERARCHY_VERSION) problem = "unsupported hierarchy version";
+    else if (header.numArcs < 0 || header.numUpward < 0) problem = "invalid hierarchy header";
+    else if (header.numCities != graph->numCities || header.numEdges != graph->numEdges ||
+             header.fingerprint != graphFingerprint(graph)) problem = "hierarchy was built for another map";
+    if (problem) {
+        fprintf(stderr, "%s: %s, searching without it\n", name, problem);
+        return NULL;
+    }
+
+    int n = header.numCities;
+    struct Hierarchy* hierarchy = malloc(sizeof(struct Hierarchy));
+    if (hierarchy == NULL) exit(0);
+    hierarchy->numCities = n;
+    hierarchy->numArcs = header.numArcs;
+    hierarchy->numUpward = header.numUpward;
+    hierarchy->coreSize = header.coreSize;
+    hierarchy->arcs = malloc((header.numArcs > 0 ? header.numArcs : 1) * sizeof(struct HierarchyArc));
+    hierarchy->upOffsets = malloc((n + 1) * sizeof(int));
+    hierarchy->upward = malloc((header.numUpward > 0 ? header.numUpward : 1) * sizeof(struct UpwardArc));
+    hierarchy->core = malloc(n > 0 ? n : 1);
+    if (hierarchy->arcs == NULL || hierarchy->upOffsets == NULL || hierarchy->upward == NULL || hierarchy->core == NULL) exit(0);
+
+    if (fread(hierarchy->arcs, sizeof(struct HierarchyArc), header.numArcs, input) != (size_t)header.numArcs ||
+        fread(hierarchy->upOffsets, sizeof(int), n + 1, input) != (size_t)n + 1 ||
+        fread(hierarchy->upward, sizeof(struct UpwardArc), header.numUpward, input) != (size_t)header.numUpward ||
+        fread(hierarchy->core, 1, n, input) != (size_t)n ||
+        hierarchy->upOffsets[0] != 0 || hierarchy->upOffsets[n] != header.numUpward) {
+        fprintf(stderr, "%s: truncated hierarchy file, searching without it\n", name);
+        freeHierarchy(hierarchy);
+        return NULL;
+    }
+    return hierarchy;
+}
+
+/***********************************************************************************************************************
+ * freeHierarchy()
+ *
+ * Arguments: hierarchy - pointer to the hierarchy
+ * Returns: void
+ * Side-Effects: frees dynamically allocated memory
+ *
+ * Description: frees the arrays and the structure.
+ ***********************************************************************************************************************/
+void freeHierarchy(struct Hierarchy* hierarchy) {
+    if (hierarchy == NULL) return;
+    free(hierarchy->arcs);
+    free(hierarchy->upOffsets);
+    free(hierarchy->upward);
+    free(hierarchy->core);
+    free(hierarchy);
+}
+
+/***********************************************************************************************************************
+ * hierarchyEligible()
+ *
+ * Arguments: graph - map graph
+ *            client - client request with valid cities
+ * Returns: true if the client is a cost query and no filter removes a connection
+ * Side-Effects: none
+ *
+ * Description: the hierarchy is built on the whole map, so it cannot answer A1/A2/A3 queries. B2 is checked on
+ *              the result as usual. An A1 on a transport the map does not use removes nothing.
+ ***********************************************************************************************************************/
+bool hierarchyEligible(const struct Graph* graph, const struct Client* client) {
+    uint64_t all = graph->numTransports >= TRANSPORT_MASK_BITS ? ~(uint64_t)0 : ((uint64_t)1 << graph->numTransports) - 1;
+    return strcmp(client->filter, "cost") == 0 && !client->restrictions.A2 && !client->restrictions.A3 &&
+           (client->restrictions.allowedTransports & all) == all && client->restrictions.excludedTransport < 0;
+}
+
+/***********************************************************************************************************************
+ * label()
+ *
+ * Arguments: ws - search state
+ *            city - city index
+ * Returns: tentative cost of the city in this search, INF if the search has not reached it
+ * Side-Effects: none
+ *
+ * Description: reads a label without initializing the city.
+ ***********************************************************************************************************************/
+static inline int label(const struct Workspace* ws, int city) {
+    return ws->stamp[city] == ws->epoch ? ws->weight[city] : INF;
+}
+
+/***********************************************************************************************************************
+ * relax()
+ *
+ * Arguments: side - search state being expanded
+ *            other - search state of the opposite direction
+ *            u - city being settled
+ *            arc - arc leaving u
+ *            queue - 0 to only label the arc's city (core cities reached by the upward search), 1 to queue it
+ *            best - cost of the best meeting found so far, updated
+ *            meet - city of that meeting, updated
+ * Returns: 1 if the city got its first label, 0 otherwise
+ * Side-Effects: may update the label and predecessor of the arc's city
+ *
+ * Description: relaxes one arc and checks whether the improved label meets the other search.
+ ***********************************************************************************************************************/
+static int relax(struct Workspace* side, const struct Workspace* other, int u, const struct UpwardArc* arc, int queue, int* best, int* meet) {
+    int v = arc->to;
+
+    touchCity(side, v);
+    STAT(side->counters.scanned++);
+    if (side->heapIndex[v] == -2) return 0;
+
+    int newWeight = side->weight[u] + arc->weight;
+    if (newWeight >= side->weight[v]) return 0;
+    int first = side->weight[v] == INF;
+    side->weight[v] = newWeight;
+    side->prevCity[v] = u;
+    side->prevEdge[v] = arc->arc;
+
+    if (queue) {
+        if (side->heapIndex[v] == -1) {
+            insertMinHeap(side->heap, v, newWeight, side->heapIndex);
+        } else {
+            decreaseKey(side->heap, v, newWeight, side->heapIndex);
+        }
+    }
+
+    int otherWeight = label(other, v);
+    if (otherWeight != INF && newWeight + otherWeight < *best) {
+        *best = newWeight + otherWeight;
+        *meet = v;
+    }
+    return first;
+}
+
+/***********************************************************************************************************************
+ * settleUpward()
+ *
+ * Arguments: hierarchy - contracted graph
+ *            side - search state being expanded
+ *            other - search state of the opposite direction
+ *            best - cost of the best meeting found so far, updated
+ *            meet - city of that meeting, updated
+ *            numEntries - number of core cities this search has reached, updated
+ * Returns: void
+ * Side-Effects: settles one contracted city of side and relaxes its upward arcs; core cities reached for the first
+ *               time are appended to side->trip (unused until the path is written)
+ *
+ * Description: one step of either upward search; the arcs are symmetric, so both directions use the same lists.
+ *              A city whose label can be improved through one of its upward arcs (read backwards) is stalled: its
+ *              arcs are not relaxed, since no shortest path of this search goes through it. Core cities are
+ *              labelled but not queued; they seed the search inside the core.
+ ***********************************************************************************************************************/
+static void settleUpward(const struct Hierarchy* hierarchy, struct Workspace* side, const struct Workspace* other, int* best, int* meet, int* numEntries) {
+    struct heapNode minNode = extractMin(side->heap, side->heapIndex);
+    int u = minNode.city;
+    STAT(side->counters.settled++);
+    const struct UpwardArc* arc = hierarchy->upward + hierarchy->upOffsets[u];
+    const struct UpwardArc* lastArc = hierarchy->upward + hierarchy->upOffsets[u + 1];
+
+    // Stall on demand
+    for (const struct UpwardArc* down = arc; down < lastArc; down++) {
+        int above = label(side, down->to);
+        if (above != INF && above + down->weight < side->weight[u]) return;
+    }
+
+    for (; arc < lastArc; arc++) {
+        int core = hierarchy->core[arc->to];
+        if (relax(side, other, u, arc, !core, best, meet) && core) {
+            side->trip[(*numEntries)++] = arc->to;
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ * settleCore()
+ *
+ * Arguments: hierarchy - contracted graph
+ *            side - search state being expanded
+ *            other - search state of the opposite direction
+ *            best - cost of the best meeting found so far, updated
+ *            meet - city of that meeting, updated
+ * Returns: void
+ * Side-Effects: settles one core city of side and relaxes its arcs
+ *
+ * Description: one step of the bidirectional Dijkstra inside the core, where every arc is kept.
+ ***********************************************************************************************************************/
+static void settleCore(const struct Hierarchy* hierarchy, struct Workspace* side, const struct Workspace* other, int* best, int* meet) {
+    struct heapNode minNode = extractMin(side->heap, side->heapIndex);
+    int u = minNode.city;
+    STAT(side->counters.settled++);
+    const struct UpwardArc* lastArc = hierarchy->upward + hierarchy->upOffsets[u + 1];
+
+    for (const struct UpwardArc* arc = hierarchy->upward + hierarchy->upOffsets[u]; arc < lastArc; arc++) {
+        relax(side, other, u, arc, 1, best, meet);
+    }
+}
+
+/***********************************************************************************************************************
+ * unpack()
+ *
+ * Arguments: hierarchy - contracted graph
+ *            arc - arc to unpack
+ *            reverse - 1 to walk the arc from its end to its start
+ *            ws - workspace whose trip arrays receive the hops
+ *            numHops - number of hops written so far, updated
+ * Returns: void
+ * Side-Effects: appends the connections of the arc to the trip arrays
+ *
+ * Description: a shortcut is its first arc followed by its second; walked in reverse, it is the second reversed
+ *              followed by the first reversed.
+ ***********************************************************************************************************************/
+static void unpack(const struct Hierarchy* hierarchy, int arc, int reverse, struct Workspace* ws, int* numHops) {
+    const struct HierarchyArc* a = &hierarchy->arcs[arc];
+    if (a->second < 0) {
+        if (*numHops == ws->numCities) return;
+        ws->trip[*numHops] = reverse ? a->from : a->to;
+        ws->tripEdge[*numHops] = a->first;
+        (*numHops)++;
+    } else if (!reverse) {
+        unpack(hierarchy, a->first, 0, ws, numHops);
+        unpack(hierarchy, a->second, 0, ws, numHops);
+    } else {
+        unpack(hierarchy, a->second, 1, ws, numHops);
+        unpack(hierarchy, a->first, 1, ws, numHops);
+    }
+}
+
+/***********************************************************************************************************************
+ * hierarchy_query()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            ws - query workspace; its reverse state holds the backward search
+ *            hierarchy - contracted graph of this map
+ *            client - eligible cost query with valid cities
+ *            output - buffer receiving the .sol line
+ * Returns: void
+ * Side-Effects: appends the result to the output buffer, overwrites both search states of the workspace
+ *
+ * Description: first the upward searches from both ends, always expanding the one with the smaller key, each of
+ *              them stopped once its next key reaches the best meeting cost. A cheapest path that stays outside
+ *              the core goes up from the start and down to the end, so it is found at its highest city. Then the
+ *              core cities the upward searches labelled are queued and a bidirectional Dijkstra runs inside the
+ *              core until the two smallest keys add up to the best cost. The arcs of the forward half are
+ *              collected in the potential array (used as scratch here), then every arc is unpacked into
+ *              connections and the path is written by write_path().
+ ***********************************************************************************************************************/
+void hierarchy_query(const struct Graph* graph, struct Workspace* ws, const struct Hierarchy* hierarchy, const struct Client* client, struct SolBuffer* output) {
+    struct Workspace* forward = ws;
+    struct Workspace* backward = reverseWorkspace(ws);
+    int s = client->startCity - 1;
+    int t = client->endCity - 1;
+    int forwardEntries = 0, backwardEntries = 0;
+
+    resetWorkspace(forward);
+    resetWorkspace(backward);
+    touchCity(forward, s);
+    touchCity(backward, t);
+    forward->weight[s] = 0;
+    backward->weight[t] = 0;
+    if (hierarchy->core[s]) forward->trip[forwardEntries++] = s;
+    else insertMinHeap(forward->heap, s, 0, forward->heapIndex);
+    if (hierarchy->core[t]) backward->trip[backwardEntries++] = t;
+    else insertMinHeap(backward->heap, t, 0, backward->heapIndex);
+
+    int best = s == t ? 0 : INF;
+    int meet = s;
+
+    while (1) {
+        int forwardTop = isEmpty(forward->heap) ? INF : minKey(forward->heap, forward->heapIndex);
+        int backwardTop = isEmpty(backward->heap) ? INF : minKey(backward->heap, backward->heapIndex);
+        if (forwardTop >= best && backwardTop >= best) break;
+
+        if (forwardTop <= backwardTop) {
+            settleUpward(hierarchy, forward, backward, &best, &meet, &forwardEntries);
+        } else {
+            settleUpward(hierarchy, backward, forward, &best, &meet, &backwardEntries);
+        }
+    }
+
+    // Core phase: cities left in the upward heaps are not expanded any more
+    clearMinHeap(forward->heap);
+    clearMinHeap(backward->heap);
+    for (int i = 0; i < forwardEntries; i++) {
+        insertMinHeap(forward->heap, forward->trip[i], forward->weight[forward->trip[i]], forward->heapIndex);
+    }
+    for (int i = 0; i < backwardEntries; i++) {
+        insertMinHeap(backward->heap, backward->trip[i], backward->weight[backward->trip[i]], backward->heapIndex);
+    }
+    while (!isEmpty(forward->heap) && !isEmpty(backward->heap)) {
+        int forwardTop = minKey(forward->heap, forward->heapIndex);
+        int backwardTop = minKey(backward->heap, backward->heapIndex);
+        if (best != INF && (long long)forwardTop + backwardTop >= best) break;
+
+        if (forwardTop <= backwardTop) {
+            settleCore(hierarchy, forward, backward, &best, &meet);
+        } else {
+            settleCore(hierarchy, backward, forward, &best, &meet);
+        }
+    }
+
+    if (!check_budget(client->restrictions, client->filter, best)) {
+        solPutInt(output, client->clientID, ' ');
+        solPutInt(output, -1, '\n');
+        return;
+    }
+
+    int numArcs = 0;
+    for (int v = meet; v != s; v = forward->prevCity[v]) {
+        ws->potential[numArcs++] = forward->prevEdge[v];
+    }
+    int numHops = 0;
+    while (numArcs > 0) {
+        unpack(hierarchy, ws->potential[--numArcs], 0, ws, &numHops);
+    }
+    for (int v = meet; v != t; v = backward->prevCity[v]) {
+        unpack(hierarchy, backward->prevEdge[v], 1, ws, &numHops);
+    }
+
+    write_path(graph, ws, numHops, best, client, output);
+}
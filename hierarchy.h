@@ -0,0 +1,88 @@
+/******************************************************************************
+ * NAME
+ *   hierarchy.h
+ *
+ * DESCRIPTION
+ *   Header file for the contraction hierarchy (CH) engine used by cost
+ *   queries without connection filters.
+ *
+ * COMMENTS
+ *   Cities are contracted one by one; whenever the only cheapest path between
+ *   two neighbours of a contracted city went through it, a shortcut arc is
+ *   added. Every arc is either a map connection or the concatenation of two
+ *   lower arcs, so a path found in the hierarchy unpacks into connections.
+ *   Contraction stops when the remaining cities get too densely connected;
+ *   they form a core whose arcs are all kept. A query searches upwards from
+ *   both ends, then runs a bidirectional Dijkstra inside the core from the
+ *   core cities those searches reached.
+ *
+ ******************************************************************************/
+
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "dijkstra.h"
+
+#define HIERARCHY_MAGIC "TOURCHIE"
+#define HIERARCHY_VERSION 1
+
+// Arc of the hierarchy: a map connection (second == -1, first = edge index) or a shortcut made of two arcs
+struct HierarchyArc {
+    int from;
+    int to;
+    int first;
+    int second;
+};
+
+// Arc leaving a city towards a more important city (or another core city)
+struct UpwardArc {
+    int to;
+    int weight;
+    int arc;                    // index in arcs
+};
+
+// Contracted graph
+struct Hierarchy {
+    int numCities;
+    int numArcs;
+    int numUpward;
+    int coreSize;               // cities left uncontracted
+    struct HierarchyArc* arcs;
+    int* upOffsets;             // upward arcs of city u are upward[upOffsets[u]] .. upward[upOffsets[u+1]-1]
+    struct UpwardArc* upward;
+    unsigned char* core;        // 1 for the cities left uncontracted
+};
+
+// On-disk header of a .ch file, followed by the arcs, the upward offsets, the upward arcs and the core flags
+struct HierarchyHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t numCities;
+    int32_t numEdges;
+    int32_t numArcs;
+    int32_t numUpward;
+    int32_t coreSize;
+    uint64_t fingerprint;       // graphFingerprint() of the map the hierarchy was built from
+};
+
+// Contracts the graph (cost metric, every connection allowed)
+struct Hierarchy* buildHierarchy(const struct Graph* graph);
+
+// Writes the hierarchy as a .ch file; returns 1 on success
+int writeHierarchy(const struct Hierarchy* hierarchy, const struct Graph* graph, FILE* output);
+
+// Reads a .ch file; returns NULL (after reporting why) if it is unreadable or belongs to another map
+struct Hierarchy* readHierarchy(FILE* input, const struct Graph* graph, const char* name);
+
+// Frees the hierarchy
+void freeHierarchy(struct Hierarchy* hierarchy);
+
+// Returns true if the client is a cost query the hierarchy can answer (no A1/A2/A3 filter removes a connection)
+bool hierarchyEligible(const struct Graph* graph, const struct Client* client);
+
+// Answers one eligible cost query and writes its .sol line
+void hierarchy_query(const struct Graph* graph, struct Workspace* ws, const struct Hierarchy* hierarchy, const struct Client* client, struct SolBuffer* output);
+
+#endif
@@ -0,0 +1,364 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: landmarks.c
+* Description: Landmark selection and distance tables for ALT (A*, landmarks, triangle inequality) cost searches.
+*/
+
+#include "landmarks.h"
+#include "heap.h"
+#include <string.h>
+#include <stdlib.h>
+
+/***********************************************************************************************************************
+ * unrestricted()
+ *
+ * Arguments: none
+ * Returns: restrictions that allow every connection
+ * Side-Effects: none
+ *
+ * Description: landmark distances are computed on the whole map so they are lower bounds for every filter.
+ ***********************************************************************************************************************/
+static struct Restrictions unrestricted(void) {
+    struct Restrictions restrictions;
+    memset(&restrictions, 0, sizeof(restrictions));
+    restrictions.allowedTransports = ~(uint64_t)0;
+    restrictions.excludedTransport = -1;
+    return restrictions;
+}
+
+/***********************************************************************************************************************
+ * computeLandmarks()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            numLandmarks - number of landmarks wanted (capped at the number of cities and LANDMARKS_MAX)
+ *            ws - workspace used for the searches
+ * Returns: pointer to the landmarks
+ * Side-Effects: allocates dynamic memory, exits if memory runs out
+ *
+ * Description: farthest-point selection: the first landmark is the city farthest from city 1, and each next one
+ *              is the city farthest from every landmark chosen so far. Cities no landmark reaches count as
+ *              infinitely far (the one with most connections is taken), so every component of the map gets a
+ *              landmark while there are landmarks left. One full cost search per landmark fills its column.
+ ***********************************************************************************************************************/
+struct Landmarks* computeLandmarks(const struct Graph* graph, int numLandmarks, struct Workspace* ws) {
+    int n = graph->numCities;
+    char filter[10] = "cost";
+    struct Restrictions restrictions = unrestricted();
+
+    if (numLandmarks > n) numLandmarks = n;
+    if (numLandmarks > LANDMARKS_MAX) numLandmarks = LANDMARKS_MAX;
+    if (numLandmarks < 0) numLandmarks = 0;
+
+    struct Landmarks* landmarks = malloc(sizeof(struct Landmarks));
+    if (landmarks == NULL) exit(0);
+    landmarks->numLandmarks = numLandmarks;
+    landmarks->numCities = n;
+    landmarks->cities = malloc((numLandmarks > 0 ? numLandmarks : 1) * sizeof(int));
+    landmarks->distance = malloc(((size_t)n * numLandmarks > 0 ? (size_t)n * numLandmarks : 1) * sizeof(int));
+    int* nearest = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (landmarks->cities == NULL || landmarks->distance == NULL || nearest == NULL) exit(0);
+
+    // Seed: the city farthest from city 1
+    int next = 0;
+    if (n > 0) {
+        dijkstra_search(graph, ws, restrictions, 1, 0, filter, NULL, 0);
+        for (int v = 0; v < n; v++) {
+            int d = ws->stamp[v] == ws->epoch ? ws->weight[v] : INF;
+            if (d != INF && d > ws->weight[next]) next = v;
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        nearest[v] = INF;
+    }
+
+    for (int k = 0; k < numLandmarks; k++) {
+        landmarks->cities[k] = next;
+        nearest[next] = 0;
+        dijkstra_search(graph, ws, restrictions, next + 1, 0, filter, NULL, 0);
+
+        int bestDegree = -1;
+        for (int v = 0; v < n; v++) {
+            int d = ws->stamp[v] == ws->epoch ? ws->weight[v] : INF;
+            landmarks->distance[(size_t)v * numLandmarks + k] = d;
+            if (d < nearest[v]) nearest[v] = d;
+
+            // Farthest from the landmarks so far; among unreached cities, the best connected one
+            int degree = graph->offsets[v + 1] - graph->offsets[v];
+            if (nearest[v] > nearest[next] || (nearest[v] == INF && nearest[next] == INF && degree > bestDegree)) {
+                next = v;
+                bestDegree = nearest[v] == INF ? degree : -1;
+            }
+        }
+    }
+
+    free(nearest);
+    return landmarks;
+}
+
+/***********************************************************************************************************************
+ * refreshLandmarks()
+ *
+ * Arguments: landmarks - landmarks computed on the map before it changed
+ *            graph - changed map
+ *            ws - workspace used for the searches
+ * Returns: void
+ * Side-Effects: overwrites the distance table
+ *
+ * Description: one full cost search per landmark, as in computeLandmarks(), without choosing the landmarks again.
+ ***********************************************************************************************************************/
+void refreshLandmarks(struct Landmarks* landmarks, const struct Graph* graph, struct Workspace* ws) {
+    char filter[10] = "cost";
+    struct Restrictions restrictions = unrestricted();
+    int numLandmarks = landmarks->numLandmarks;
+
+    for (int k = 0; k < numLandmarks; k++) {
+        dijkstra_search(graph, ws, restrictions, landmarks->cities[k] + 1, 0, filter, NULL, 0);
+        for (int v = 0; v < graph->numCities; v++) {
+            landmarks->distance[(size_t)v * numLandmarks + k] = ws->stamp[v] == ws->epoch ? ws->weight[v] : INF;
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ * writeLandmarks()
+ *
+ * Arguments: landmarks - landmarks to store
+ *            graph - graph they were computed on
+ *            output - binary output file
+ * Returns: 1 on success, 0 if a write failed
+ * Side-Effects: writes the file
+ *
+ * Description: writes the header, the landmark cities and the distance table.
+ ***********************************************************************************************************************/
+int writeLandmarks(const struct Landmarks* landmarks, const struct Graph* graph, FILE* output) {
+    struct LandmarksHeader header;
+    size_t entries = (size_t)landmarks->numCities * landmarks->numLandmarks;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LANDMARKS_MAGIC, sizeof(header.magic));
+    header.version = LANDMARKS_VERSION;
+    header.numLandmarks = landmarks->numLandmarks;
+    header.numCities = graph->numCities;
+    header.numEdges = graph->numEdges;
+    header.fingerprint = graphFingerprint(graph);
+
+    if (fwrite(&header, sizeof(header), 1, output) != 1) return 0;
+    if (fwrite(landmarks->cities, sizeof(int), landmarks->numLandmarks, output) != (size_t)landmarks->numLandmarks) return 0;
+    if (fwrite(landmarks->distance, sizeof(int), entries, output) != entries) return 0;
+    return fflush(output) == 0;
+}
+
+/***********************************************************************************************************************
+ * readLandmarks()
+ *
+ * Arguments: input - binary .lmk file
+ *            graph - graph the queries will run on
+ *            name - file name, used in error messages
+ * Returns: pointer to the landmarks, or NULL if the file cannot be used
+ * Side-Effects: allocates dynamic memory, reports problems on stderr
+ *
+ * Description: the table is only accepted if it was computed on exactly this map (same fingerprint), since stale
+ *              distances would no longer be lower bounds.
+ ***********************************************************************************************************************/
+struct Landmarks* readLandmarks(FILE* input, const struct Graph* graph, const char* name) {
+    struct LandmarksHeader header;
+    const char* problem = NULL;
+
+    if (fread(&header, sizeof(header), 1, input) != 1) problem = "truncated landmarks file";
+    else if (memcmp(header.magic, LANDMARKS_MAGIC, sizeof(header.magic)) != 0) problem = "not a landmarks file";
+    else if (header.version != LANDMARKS_VERSION) problem = "unsupported landmarks version";
+    else if (header.numLandmarks < 0 || header.numLandmarks > LANDMARKS_MAX) problem = "invalid landmarks header";
+    else if (header.numCities != graph->numCities || header.numEdges != graph->numEdges ||
+             header.fingerprint != graphFingerprint(graph)) problem = "landmarks were computed for another map";
+    if (problem) {
+        fprintf(stderr, "%s: %s, searching without them\n", name, problem);
+        return NULL;
+    }
+
+    size_t entries = (size_t)header.numCities * header.numLandmarks;
+    struct Landmarks* landmarks = malloc(sizeof(struct Landmarks));
+    if (landmarks == NULL) exit(0);
+    landmarks->numLandmarks = header.numLandmarks;
+    landmarks->numCities = header.numCities;
+    landmarks->cities = malloc((header.numLandmarks > 0 ? header.numLandmarks : 1) * sizeof(int));
+    landmarks->distance = malloc((entries > 0 ? entries : 1) * sizeof(int));
+    if (landmarks->cities == NULL || landmarks->distance == NULL) exit(0);
+
+    if (fread(landmarks->cities, sizeof(int), header.numLandmarks, input) != (size_t)header.numLandmarks ||
+        fread(landmarks->distance, sizeof(int), entries, input) != entries) {
+        fprintf(stderr, "%s: truncated landmarks file, searching without them\n", name);
+        freeLandmarks(landmarks);
+        return NULL;
+    }
+    return landmarks;
+}
+
+/***********************************************************************************************************************
+ * freeLandmarks()
+ *
+ * Arguments: landmarks - pointer to the landmarks
+ * Returns: void
+ * Side-Effects: frees dynamically allocated memory
+ *
+ * Description: frees the tables and the structure.
+ ***********************************************************************************************************************/
+void freeLandmarks(struct Landmarks* landmarks) {
+    if (landmarks == NULL) return;
+    free(landmarks->cities);
+    free(landmarks->distance);
+    free(landmarks);
+}
+
+/***********************************************************************************************************************
+ * lowerBound()
+ *
+ * Arguments: landmarks - landmark distance tables
+ *            toTarget - distances from every landmark to the target city
+ *            city - 0-based city
+ * Returns: lower bound on the cost from city to the target, INF if the target cannot be reached from city
+ * Side-Effects: none
+ *
+ * Description: max over the landmarks of |d(L,target) - d(L,city)|. If a landmark reaches exactly one of the two
+ *              cities they are in different components of the map, and no filter can connect them.
+ ***********************************************************************************************************************/
+static inline int lowerBound(const struct Landmarks* landmarks, const int* toTarget, int city) {
+    const int* fromLandmark = landmarks->distance + (size_t)city * landmarks->numLandmarks;
+    int bound = 0;
+
+    for (int k = 0; k < landmarks->numLandmarks; k++) {
+        int a = fromLandmark[k];
+        int b = toTarget[k];
+        if (a == INF || b == INF) {
+            if (a != b) return INF;
+            continue;
+        }
+        int difference = a > b ? a - b : b - a;
+        if (difference > bound) bound = difference;
+    }
+    return bound;
+}
+
+/***********************************************************************************************************************
+ * alt_search()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            ws - query workspace
+ *            landmarks - landmark distance tables of this graph
+ *            restrictions - structure containing travel restrictions
+ *            startCity, endCity - 1-based cities of the query
+ * Returns: number of cities settled
+ * Side-Effects: overwrites the search state kept in the workspace
+ *
+ * Description: Dijkstra on cost with every key raised by the lower bound of its city (A*). The landmark bounds are
+ *              consistent, so a city is final when extracted and the search stops at the end city with its exact
+ *              cost; write_result() reads the path from the predecessor tree as usual. Cities that cannot reach
+ *              the end city are never queued.
+ ***********************************************************************************************************************/
+int alt_search(const struct Graph* graph, struct Workspace* ws, const struct Landmarks* landmarks, struct Restrictions restrictions, int startCity, int endCity) {
+    int* weight = ws->weight;
+    int* heapIndex = ws->heapIndex;
+    int* potential = ws->potential;
+    struct minHeap* heap = ws->heap;
+    int s = startCity - 1;
+    int t = endCity - 1;
+    const int* toTarget = landmarks->distance + (size_t)t * landmarks->numLandmarks;
+
+    resetWorkspace(ws);
+    touchCity(ws, s);
+    touchCity(ws, t);
+
+    potential[s] = lowerBound(landmarks, toTarget, s);
+    if (potential[s] == INF) return 0;
+    weight[s] = 0;
+    insertMinHeap(heap, s, potential[s], heapIndex);
+
+    int settled = 0;
+    while(!isEmpty(heap)) {
+        struct heapNode minNode = extractMin(heap, heapIndex);
+        int u = minNode.city;
+
+        heapIndex[u] = -2;
+        settled++;
+        STAT(ws->counters.settled++);
+        if (u == t) break;
+
+        const struct Edge* edge = graph->edges + graph->offsets[u];
+        const struct Edge* lastEdge = graph->edges + graph->offsets[u + 1];
+        for (; edge < lastEdge; edge++) {
+            int v = edge->destination;
+
+            touchCity(ws, v);
+            STAT(ws->counters.scanned++);
+            if(!check_restrictions(restrictions, edge)){
+                STAT(ws->counters.filtered++);
+                continue;
+            }
+            if(heapIndex[v] == -2){
+                continue;
+            }
+
+            int newWeight = weight[u] + edge->travelCost;
+            if(weight[v] > newWeight){
+                if(weight[v] == INF){
+                    potential[v] = lowerBound(landmarks, toTarget, v);
+                    if(potential[v] == INF){
+                        heapIndex[v] = -2;
+                        continue;
+                    }
+                }
+                weight[v] = newWeight;
+                ws->prevCity[v] = u;
+                ws->prevEdge[v] = (int)(edge - graph->edges);
+
+                if(heapIndex[v] == -1){
+                    insertMinHeap(heap, v, newWeight + potential[v], heapIndex);
+                } else {
+                    decreaseKey(heap, v, newWeight + potential[v], heapIndex);
+                }
+            }
+        }
+    }
+    return settled;
+}
+
+/***********************************************************************************************************************
+ * reportLandmarks()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            landmarks - landmark distance tables of this graph
+ *            ws - workspace used for the searches
+ *            numQueries - number of random queries to run
+ *            output - where the report is printed
+ * Returns: void
+ * Side-Effects: runs 2 * numQueries searches, prints one line
+ *
+ * Description: runs the same pseudo-random unrestricted cost queries (fixed seed) with plain Dijkstra and with A*
+ *              and prints the average number of settled cities of each, which is what the landmarks save.
+ ***********************************************************************************************************************/
+void reportLandmarks(const struct Graph* graph, const struct Landmarks* landmarks, struct Workspace* ws, int numQueries, FILE* output) {
+    int n = graph->numCities;
+    char filter[10] = "cost";
+    struct Restrictions restrictions = unrestricted();
+    long long plain = 0, guided = 0;
+    int mismatches = 0;
+    uint64_t seed = 0x9e3779b97f4a7c15ull;
+
+    if (n == 0 || numQueries <= 0) return;
+    for (int q = 0; q < numQueries; q++) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        int s = (int)((seed >> 33) % (uint64_t)n) + 1;
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        int t = (int)((seed >> 33) % (uint64_t)n) + 1;
+
+        plain += dijkstra_search(graph, ws, restrictions, s, 0, filter, &t, 1);
+        int cost = ws->weight[t - 1];
+        guided += alt_search(graph, ws, landmarks, restrictions, s, t);
+        if (ws->weight[t - 1] != cost) mismatches++;
+    }
+
+    fprintf(output, "%d landmarks, %d random cost queries: Dijkstra settles %.0f cities per query, A* %.0f (%.1fx fewer)\n",
+            landmarks->numLandmarks, numQueries, (double)plain / numQueries, (double)guided / numQueries,
+            guided > 0 ? (double)plain / guided : 0.0);
+    if (mismatches > 0) fprintf(output, "warning: %d queries disagree on the optimal cost\n", mismatches);
+}
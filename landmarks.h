@@ -0,0 +1,69 @@
+/******************************************************************************
+ * NAME
+ *   landmarks.h
+ *
+ * DESCRIPTION
+ *   Header file for the landmark (ALT) lower bounds used by A* on cost queries.
+ *
+ * COMMENTS
+ *   A few landmark cities are chosen far apart and the exact cost from each
+ *   of them to every city is stored in a .lmk file next to the map. Costs are
+ *   symmetric, so by the triangle inequality |d(L,t) - d(L,v)| is a lower
+ *   bound on the cost from v to t for every landmark L. Filters (A1/A2/A3)
+ *   only remove connections, which can only make paths more expensive, so
+ *   the bounds stay valid (just less tight) for restricted queries.
+ *
+ ******************************************************************************/
+
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "dijkstra.h"
+
+#define LANDMARKS_MAGIC "TOURLMRK"
+#define LANDMARKS_VERSION 1
+#define LANDMARKS_DEFAULT 16
+#define LANDMARKS_MAX 64
+
+// On-disk header of a .lmk file, followed by the landmark cities and the distance table
+struct LandmarksHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t numLandmarks;
+    int32_t numCities;
+    int32_t numEdges;
+    uint64_t fingerprint;       // graphFingerprint() of the map the table was computed on
+};
+
+// Cost distances from every landmark, stored per city (numLandmarks consecutive entries, INF if unreachable)
+struct Landmarks {
+    int numLandmarks;
+    int numCities;
+    int* cities;                // 0-based landmark cities
+    int* distance;              // distance[city * numLandmarks + k] = cost from landmark k to city
+};
+
+// Picks numLandmarks landmarks with the farthest-point heuristic and computes their distance tables
+struct Landmarks* computeLandmarks(const struct Graph* graph, int numLandmarks, struct Workspace* ws);
+
+// Recomputes the distance tables of the same landmark cities after the map changed
+void refreshLandmarks(struct Landmarks* landmarks, const struct Graph* graph, struct Workspace* ws);
+
+// Writes the landmarks of a graph as a .lmk file; returns 1 on success
+int writeLandmarks(const struct Landmarks* landmarks, const struct Graph* graph, FILE* output);
+
+// Reads a .lmk file; returns NULL (after reporting why) if it is unreadable or belongs to another map
+struct Landmarks* readLandmarks(FILE* input, const struct Graph* graph, const char* name);
+
+// Frees the landmarks
+void freeLandmarks(struct Landmarks* landmarks);
+
+// A* search from startCity to endCity (1-based) guided by the landmarks; returns the number of settled cities
+int alt_search(const struct Graph* graph, struct Workspace* ws, const struct Landmarks* landmarks, struct Restrictions restrictions, int startCity, int endCity);
+
+// Compares settled cities of Dijkstra and A* on random cost queries and prints the result
+void reportLandmarks(const struct Graph* graph, const struct Landmarks* landmarks, struct Workspace* ws, int numQueries, FILE* output);
+
+#endif
@@ -5,34 +5,272 @@
 * Description: Main file of the project. Responsible for managing function calls
 *              when the program is invoked from the command line. Ensures the
 *              correct number of arguments and closes opened files.
-* Arguments: <executable.exe> <mapsFile> <clientsFile>
-* Output: Results file with the extension .sol
+* Arguments: <executable.exe> [options] <mapsFile> <clientsFile>
+*            <executable.exe> compile <mapsFile> <graphFile>
+*            <executable.exe> landmarks <mapsFile> [numLandmarks]
+*            <executable.exe> contract <mapsFile>
+*            <executable.exe> [options] bench <mapsFile> <clientsFile>
+*            <executable.exe> [options] serve <mapsFile> [socketFile]
+* Output: Results file with the extension .sol (plus a JSON timing report on stdout for bench), the binary graph
+*         snapshot, the .lmk landmark tables or the .ch contraction hierarchy; serve writes one .sol line per client
+*         line it reads
 */
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include "file.h"
+#include "processFiles.h"
+#include "threadpool.h"
+#include "landmarks.h"
 
-int main(int argc, char* argv[]) {
+/* Description: Prints the command line usage and exits.
+* Arguments: program - name of the executable
+*/
+static void usage(char *program) {
+    printf("Usage: %s [options] <mapsFile> <clientsFile>\n", program);
+    printf("       %s compile <mapsFile> <graphFile>\n", program);
+    printf("       %s landmarks <mapsFile> [numLandmarks]\n", program);
+    printf("       %s contract <mapsFile>\n", program);
+    printf("       %s [options] bench <mapsFile> <clientsFile>\n", program);
+    printf("       %s [options] serve <mapsFile> [socketFile]\n", program);
+    printf("  <mapsFile> may be a text .map file or a .graph snapshot made by compile\n");
+    printf("  serve keeps the map loaded and answers client lines (.cli syntax, one per line) with .sol lines, on\n");
+    printf("  stdin/stdout or on the connections to a Unix domain socket; add / remove / retime lines (the --delta\n");
+    printf("  syntax) change the loaded map and are answered with \"ok\" or \"error\"\n");
+    printf("  -j threads   solve clients on this many threads (0 = one per processor)\n");
+    printf("  -q queue     priority queue of the searches: binary (default), 4ary, radix, dial, or auto (dial\n");
+    printf("               when the largest connection fits its bucket window, radix otherwise)\n");
+    printf("  --cache MB   answer repeated questions from a result cache of at most MB megabytes\n");
+    printf("  --subgraphs MB  search recurring A1/A2/A3 profiles on filtered copies of the map, using at most MB\n");
+    printf("               megabytes\n");
+    printf("  --delta FILE apply the add / remove / retime lines of FILE to the map before answering\n");
+    printf("  --stats      write phase timings, latencies and the slowest clients to <clientsFile>.stats\n");
+    printf("               (search counters need a build made with \"make STATS=1\")\n");
+    printf("  --verify     check the checksum of a .graph snapshot before using it\n");
+    printf("  -e engine    enable a search engine (may be repeated):\n");
+    printf("                 bidir  bidirectional Dijkstra for cost queries\n");
+    printf("                 alt    A* with the landmarks stored beside the map, for cost queries\n");
+    printf("                 ch     contraction hierarchy stored beside the map, for cost queries without filters\n");
+    printf("                 csa    connection scan over a day of departures, for duration queries\n");
+    printf("                 rcsp   label setting search that keeps both budgets, for queries with B1 or B2\n");
+    exit(0);
+}
+
+/* Description: Runs "compile": loads a map and writes it as a binary snapshot.
+* Arguments: mapsName - map file to read
+*            graphName - snapshot file to write
+*            options - command line options
+*/
+static void compileMain(char *mapsName, char *graphName, struct RunOptions *options) {
+    options->mapsName = mapsName;
+    options->clientsName = graphName;
+
+    FILE *mapsInput = openFile(mapsName);
+    if(mapsInput == NULL) exit(0);
+
+    FILE *graphOutput = fopen(graphName, "wb");
+    if(graphOutput == NULL){
+        fclose(mapsInput);
+        exit(0);
+    }
+
+    int compiled = compileFiles(mapsInput, graphOutput, options);
+
+    fclose(mapsInput);
+    fclose(graphOutput);
+    if(!compiled) remove(graphName);
+
+    exit(0);
+}
+
+/* Description: Runs "landmarks": picks landmarks on a map and writes their tables beside it.
+* Arguments: mapsName - map file to read (the tables go to the same name with the extension .lmk)
+*            count - number of landmarks, NULL for the default
+*            options - command line options
+*            program - name of the executable
+*/
+static void landmarksMain(char *mapsName, char *count, struct RunOptions *options, char *program) {
+    int numLandmarks = LANDMARKS_DEFAULT;
+    if(count != NULL) {
+        char *end;
+        long value = strtol(count, &end, 10);
+        if(*end != '\0' || value < 1 || value > LANDMARKS_MAX) usage(program);
+        numLandmarks = (int)value;
+    }
+
+    char *landmarksName = replaceExtension(mapsName, ".lmk");
+    options->mapsName = mapsName;
+    options->clientsName = landmarksName;
+
+    FILE *mapsInput = openFile(mapsName);
+    if(mapsInput == NULL) exit(0);
+
+    FILE *landmarksOutput = fopen(landmarksName, "wb");
+    if(landmarksOutput == NULL){
+        fclose(mapsInput);
+        exit(0);
+    }
+
+    int written = landmarkFiles(mapsInput, landmarksOutput, numLandmarks, options);
+
+    fclose(mapsInput);
+    fclose(landmarksOutput);
+    if(!written) remove(landmarksName);
+    free(landmarksName);
+
+    exit(0);
+}
+
+/* Description: Runs "contract": builds the contraction hierarchy of a map and writes it beside it.
+* Arguments: mapsName - map file to read (the hierarchy goes to the same name with the extension .ch)
+*            options - command line options
+*/
+static void contractMain(char *mapsName, struct RunOptions *options) {
+    char *hierarchyName = replaceExtension(mapsName, ".ch");
+    options->mapsName = mapsName;
+    options->clientsName = hierarchyName;
 
-    if(argc != 3) {
-        printf("Usage: %s <mapsFile> <clientsFile>\n", argv[0]);
+    FILE *mapsInput = openFile(mapsName);
+    if(mapsInput == NULL) exit(0);
+
+    FILE *hierarchyOutput = fopen(hierarchyName, "wb");
+    if(hierarchyOutput == NULL){
+        fclose(mapsInput);
         exit(0);
+    }
+
+    int written = contractFiles(mapsInput, hierarchyOutput, options);
+
+    fclose(mapsInput);
+    fclose(hierarchyOutput);
+    if(!written) remove(hierarchyName);
+    free(hierarchyName);
+
+    exit(0);
+}
+
+/* Description: Runs "serve": keeps a map loaded and answers client lines until the input ends or a stop signal.
+* Arguments: mapsName - map file to read
+*            socketName - Unix domain socket to listen on, NULL for stdin and stdout
+*            options - command line options
+*/
+static void serveMain(char *mapsName, char *socketName, struct RunOptions *options) {
+    options->mapsName = mapsName;
+    options->clientsName = socketName != NULL ? socketName : "stdin";
+
+    FILE *mapsInput = openFile(mapsName);
+    if(mapsInput == NULL) exit(0);
+
+    serveFiles(mapsInput, socketName, options);
+
+    fclose(mapsInput);
+    exit(0);
+}
+
+int main(int argc, char* argv[]) {
+    struct RunOptions options;
+    options.numThreads = 1;
+    options.verifySnapshot = 0;
+    options.engines = 0;
+    options.queue = QUEUE_BINARY;
+    options.bench = 0;
+    options.stats = 0;
+    options.cacheMegabytes = 0;
+    options.subgraphMegabytes = 0;
+    options.deltaName = NULL;
+
+    char *positional[3];
+    int numPositional = 0;
+
+    for(int arg = 1; arg < argc; arg++) {
+        if(strcmp(argv[arg], "-j") == 0 && arg + 1 < argc) {
+            char *end;
+            long threads = strtol(argv[++arg], &end, 10);
+            if(*end != '\0' || threads < 0 || threads > 1024) usage(argv[0]);
+            options.numThreads = threads == 0 ? availableProcessors() : (int)threads;
+        } else if(strcmp(argv[arg], "-e") == 0 && arg + 1 < argc) {
+            arg++;
+            if(strcmp(argv[arg], "bidir") == 0) options.engines |= ENGINE_BIDIRECTIONAL;
+            else if(strcmp(argv[arg], "alt") == 0) options.engines |= ENGINE_ALT;
+            else if(strcmp(argv[arg], "ch") == 0) options.engines |= ENGINE_CH;
+            else if(strcmp(argv[arg], "csa") == 0) options.engines |= ENGINE_CSA;
+            else if(strcmp(argv[arg], "rcsp") == 0) options.engines |= ENGINE_RCSP;
+            // The profile sweep is chosen automatically; "-e profile" is still accepted
+            else if(strcmp(argv[arg], "profile") != 0) usage(argv[0]);
+        } else if(strcmp(argv[arg], "-q") == 0 && arg + 1 < argc) {
+            arg++;
+            if(strcmp(argv[arg], "binary") == 0) options.queue = QUEUE_BINARY;
+            else if(strcmp(argv[arg], "4ary") == 0) options.queue = QUEUE_QUATERNARY;
+            else if(strcmp(argv[arg], "radix") == 0) options.queue = QUEUE_RADIX;
+            else if(strcmp(argv[arg], "dial") == 0) options.queue = QUEUE_DIAL;
+            else if(strcmp(argv[arg], "auto") == 0) options.queue = QUEUE_AUTO;
+            else usage(argv[0]);
+        } else if(strcmp(argv[arg], "--cache") == 0 && arg + 1 < argc) {
+            char *end;
+            long megabytes = strtol(argv[++arg], &end, 10);
+            if(*end != '\0' || megabytes < 1 || megabytes > 65536) usage(argv[0]);
+            options.cacheMegabytes = (int)megabytes;
+        } else if(strcmp(argv[arg], "--subgraphs") == 0 && arg + 1 < argc) {
+            char *end;
+            long megabytes = strtol(argv[++arg], &end, 10);
+            if(*end != '\0' || megabytes < 1 || megabytes > 65536) usage(argv[0]);
+            options.subgraphMegabytes = (int)megabytes;
+        } else if(strcmp(argv[arg], "--delta") == 0 && arg + 1 < argc) {
+            options.deltaName = argv[++arg];
+        } else if(strcmp(argv[arg], "--stats") == 0) {
+            options.stats = 1;
+        } else if(strcmp(argv[arg], "--verify") == 0) {
+            options.verifySnapshot = 1;
+        } else if(argv[arg][0] == '-' || numPositional == 3) {
+            usage(argv[0]);
+        } else {
+            positional[numPositional++] = argv[arg];
+        }
+    }
+
+    if(numPositional == 3 && strcmp(positional[0], "compile") == 0) {
+        compileMain(positional[1], positional[2], &options);
+    }
+
+    if(numPositional >= 2 && strcmp(positional[0], "landmarks") == 0) {
+        landmarksMain(positional[1], numPositional == 3 ? positional[2] : NULL, &options, argv[0]);
+    }
+
+    if(numPositional == 2 && strcmp(positional[0], "contract") == 0) {
+        contractMain(positional[1], &options);
+    }
+
+    if(numPositional >= 2 && strcmp(positional[0], "serve") == 0) {
+        serveMain(positional[1], numPositional == 3 ? positional[2] : NULL, &options);
+    }
+
+    if(numPositional == 3 && strcmp(positional[0], "bench") == 0) {
+        options.bench = 1;
+        positional[0] = positional[1];
+        positional[1] = positional[2];
+        numPositional = 2;
+    }
+
+    if(numPositional != 2) {
+        usage(argv[0]);
     } 
 
-    FILE *mapsInput = openFile(argv[1]);
+    options.mapsName = positional[0];
+    options.clientsName = positional[1];
+
+    FILE *mapsInput = openFile(positional[0]);
     if(mapsInput == NULL) exit(0);
 
-    FILE *clientsInput = openFile(argv[2]);
+    FILE *clientsInput = openFile(positional[1]);
     if(clientsInput == NULL){
         fclose(mapsInput);
         exit(0);
     }
 
-    FILE *output = createOutputFile(argv[2]);
+    FILE *output = createOutputFile(positional[1]);
 
-    processFiles(mapsInput, clientsInput, output);
+    processFiles(mapsInput, clientsInput, output, &options);
 
     fclose(mapsInput);
     fclose(clientsInput);
@@ -0,0 +1,256 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: output.c
+* Description: In-memory buffers used to build .sol lines before they are written to the output file.
+*/
+
+#include "output.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Characters of the longest int in decimal ("-2147483648")
+#define INT_DIGITS 11
+
+/***********************************************************************************************************************
+ * initSolBuffer()
+ *
+ * Arguments: buffer - buffer to initialize
+ * Returns: void
+ * Side-Effects: none
+ *
+ * Description: sets the buffer to empty; memory is only allocated on the first append.
+ ***********************************************************************************************************************/
+void initSolBuffer(struct SolBuffer* buffer) {
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+    buffer->front = 0;
+}
+
+/***********************************************************************************************************************
+ * reserve()
+ *
+ * Arguments: buffer - buffer to grow
+ *            extra - number of bytes that must fit after the current contents
+ * Returns: void
+ * Side-Effects: reallocates the buffer, exits if memory runs out
+ *
+ * Description: makes sure there is room for extra more bytes plus the null terminator.
+ ***********************************************************************************************************************/
+static void reserve(struct SolBuffer* buffer, size_t extra) {
+    if (buffer->length + extra + 1 <= buffer->capacity) return;
+    size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (capacity < buffer->length + extra + 1) capacity *= 2;
+    char* data = realloc(buffer->data, capacity);
+    if (data == NULL) exit(0);
+    buffer->data = data;
+    buffer->capacity = capacity;
+}
+
+/***********************************************************************************************************************
+ * formatInt()
+ *
+ * Arguments: end - position just after the last digit
+ *            value - integer to format
+ * Returns: position of the first character
+ * Side-Effects: writes at most INT_DIGITS characters before end
+ *
+ * Description: writes the decimal digits from the last one, as printf("%d") would write them.
+ ***********************************************************************************************************************/
+static char* formatInt(char* end, int value) {
+    unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    do {
+        *--end = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) *--end = '-';
+    return end;
+}
+
+/***********************************************************************************************************************
+ * solAppend()
+ *
+ * Arguments: buffer - destination buffer
+ *            data - bytes to append
+ *            length - number of bytes
+ * Returns: void
+ * Side-Effects: appends to the buffer, growing it if needed
+ *
+ * Description: copies the bytes after the contents.
+ ***********************************************************************************************************************/
+void solAppend(struct SolBuffer* buffer, const char* data, size_t length) {
+    reserve(buffer, length);
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+}
+
+/***********************************************************************************************************************
+ * solPutInt()
+ *
+ * Arguments: buffer - destination buffer
+ *            value - integer to append
+ *            separator - character appended after it
+ * Returns: void
+ * Side-Effects: appends to the buffer, growing it if needed
+ *
+ * Description: the digits are formatted in a small array and copied, so the text is the same as printf("%d%c").
+ ***********************************************************************************************************************/
+void solPutInt(struct SolBuffer* buffer, int value, char separator) {
+    char digits[INT_DIGITS + 1];
+    char* end = digits + INT_DIGITS;
+    char* start = formatInt(end, value);
+    *end++ = separator;
+    solAppend(buffer, start, end - start);
+}
+
+/***********************************************************************************************************************
+ * solPutWord()
+ *
+ * Arguments: buffer - destination buffer
+ *            word - null-terminated string to append
+ *            separator - character appended after it
+ * Returns: void
+ * Side-Effects: appends to the buffer, growing it if needed
+ *
+ * Description: appends the string and the separator.
+ ***********************************************************************************************************************/
+void solPutWord(struct SolBuffer* buffer, const char* word, char separator) {
+    size_t length = strlen(word);
+    reserve(buffer, length + 1);
+    memcpy(buffer->data + buffer->length, word, length);
+    buffer->data[buffer->length + length] = separator;
+    buffer->length += length + 1;
+}
+
+/***********************************************************************************************************************
+ * solBeginBackward()
+ *
+ * Arguments: buffer - buffer to build text backwards in
+ * Returns: void
+ * Side-Effects: none
+ *
+ * Description: the text built backwards starts empty at the end of the buffer's memory.
+ ***********************************************************************************************************************/
+void solBeginBackward(struct SolBuffer* buffer) {
+    buffer->front = buffer->capacity;
+}
+
+/***********************************************************************************************************************
+ * reserveFront()
+ *
+ * Arguments: buffer - buffer building text backwards
+ *            extra - number of bytes that must fit before the text built backwards
+ * Returns: void
+ * Side-Effects: reallocates the buffer and moves the text built backwards to its new end, exits if memory runs out
+ *
+ * Description: the free space is the gap between the contents (and their null terminator) and the text built
+ *              backwards; it is doubled like in reserve().
+ ***********************************************************************************************************************/
+static void reserveFront(struct SolBuffer* buffer, size_t extra) {
+    if (buffer->length + extra + 1 <= buffer->front) return;
+    size_t built = buffer->capacity - buffer->front;
+    size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (capacity < buffer->length + built + extra + 1) capacity *= 2;
+    char* data = realloc(buffer->data, capacity);
+    if (data == NULL) exit(0);
+    memmove(data + capacity - built, data + buffer->front, built);
+    buffer->data = data;
+    buffer->front = capacity - built;
+    buffer->capacity = capacity;
+}
+
+/***********************************************************************************************************************
+ * solPrependInt()
+ *
+ * Arguments: buffer - buffer building text backwards
+ *            value - integer to put
+ *            separator - character put after it
+ * Returns: void
+ * Side-Effects: extends the text built backwards, growing the buffer if needed
+ *
+ * Description: the digits are formatted in place, from the last one.
+ ***********************************************************************************************************************/
+void solPrependInt(struct SolBuffer* buffer, int value, char separator) {
+    reserveFront(buffer, INT_DIGITS + 1);
+    char* end = buffer->data + buffer->front;
+    *--end = separator;
+    buffer->front = formatInt(end, value) - buffer->data;
+}
+
+/***********************************************************************************************************************
+ * solPrependWord()
+ *
+ * Arguments: buffer - buffer building text backwards
+ *            word - null-terminated string to put
+ *            separator - character put after it
+ * Returns: void
+ * Side-Effects: extends the text built backwards, growing the buffer if needed
+ *
+ * Description: puts the string and the separator before the text built so far.
+ ***********************************************************************************************************************/
+void solPrependWord(struct SolBuffer* buffer, const char* word, char separator) {
+    size_t length = strlen(word);
+    reserveFront(buffer, length + 1);
+    buffer->front -= length + 1;
+    memcpy(buffer->data + buffer->front, word, length);
+    buffer->data[buffer->front + length] = separator;
+}
+
+/***********************************************************************************************************************
+ * solEndBackward()
+ *
+ * Arguments: buffer - buffer building text backwards
+ * Returns: void
+ * Side-Effects: appends the text built backwards to the contents
+ *
+ * Description: one move closes the gap between the contents and the text built backwards.
+ ***********************************************************************************************************************/
+void solEndBackward(struct SolBuffer* buffer) {
+    size_t built = buffer->capacity - buffer->front;
+    memmove(buffer->data + buffer->length, buffer->data + buffer->front, built);
+    buffer->length += built;
+    buffer->front = buffer->capacity;
+}
+
+/***********************************************************************************************************************
+ * flushSolBuffer()
+ *
+ * Arguments: buffer - buffer to write
+ *            output - destination file
+ * Returns: 1 if every byte was written, 0 otherwise
+ * Side-Effects: flushes the output stream, writes to its file descriptor and empties the buffer
+ *
+ * Description: what the stream holds is written first, so the lines stay in order; the buffer then goes to the file
+ *              with write() calls as large as the buffer, without the stream's own buffering.
+ ***********************************************************************************************************************/
+int flushSolBuffer(struct SolBuffer* buffer, FILE* output) {
+    int written = fflush(output) == 0;
+    int fd = fileno(output);
+    size_t done = 0;
+
+    while (written && done < buffer->length) {
+        ssize_t n = write(fd, buffer->data + done, buffer->length - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) written = 0;
+        else done += (size_t)n;
+    }
+    buffer->length = 0;
+    return written;
+}
+
+/***********************************************************************************************************************
+ * freeSolBuffer()
+ *
+ * Arguments: buffer - buffer to free
+ * Returns: void
+ * Side-Effects: frees dynamically allocated memory
+ *
+ * Description: frees the buffer memory and leaves it empty.
+ ***********************************************************************************************************************/
+void freeSolBuffer(struct SolBuffer* buffer) {
+    free(buffer->data);
+    initSolBuffer(buffer);
+}
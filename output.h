@@ -0,0 +1,69 @@
+/******************************************************************************
+ * NAME
+ *   output.h
+ *
+ * DESCRIPTION
+ *   Header file for the in-memory buffers that collect .sol lines.
+ *
+ * COMMENTS
+ *   Each thread pool task of a batch formats its results into its own
+ *   buffer, kept until the whole batch is solved; the lines are then written
+ *   to the .sol file in client order, SOL_FLUSH_SIZE bytes per write() call,
+ *   so a batch holds about as much memory as its output. Integers are
+ *   formatted by hand, without printf.
+ *   A line can also be built backwards: between solBeginBackward() and
+ *   solEndBackward() the solPrepend*() calls fill the free end of the buffer
+ *   from the right, which is how a path is written while walking the
+ *   predecessor tree from its last city; solEndBackward() moves that text
+ *   after the current contents.
+ *
+ ******************************************************************************/
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// Bytes written to the output file at a time
+#define SOL_FLUSH_SIZE (1 << 20)
+
+// Growable character buffer
+struct SolBuffer {
+    char* data;
+    size_t length;
+    size_t capacity;
+    size_t front;               // start of the text being built backwards, which ends at capacity
+};
+
+// Initializes an empty buffer
+void initSolBuffer(struct SolBuffer* buffer);
+
+// Appends length bytes
+void solAppend(struct SolBuffer* buffer, const char* data, size_t length);
+
+// Appends an integer in decimal followed by separator
+void solPutInt(struct SolBuffer* buffer, int value, char separator);
+
+// Appends a string followed by separator
+void solPutWord(struct SolBuffer* buffer, const char* word, char separator);
+
+// Starts building text backwards; nothing else may be appended until solEndBackward()
+void solBeginBackward(struct SolBuffer* buffer);
+
+// Puts an integer in decimal followed by separator before the text built backwards
+void solPrependInt(struct SolBuffer* buffer, int value, char separator);
+
+// Puts a string followed by separator before the text built backwards
+void solPrependWord(struct SolBuffer* buffer, const char* word, char separator);
+
+// Appends the text built backwards to the contents
+void solEndBackward(struct SolBuffer* buffer);
+
+// Writes the buffer contents to a file and empties it; returns 0 if the write fails
+int flushSolBuffer(struct SolBuffer* buffer, FILE* output);
+
+// Frees the buffer memory
+void freeSolBuffer(struct SolBuffer* buffer);
+
+#endif
@@ -1,158 +1,609 @@
 #include "processFiles.h"  
+#include "batch.h"
+#include "scanner.h"
+#include "snapshot.h"
+#include "landmarks.h"
+#include "hierarchy.h"
+#include "csa.h"
+#include "file.h"
+#include "timer.h"
+#include "cache.h"
+#include "subgraph.h"
+#include "server.h"
+#include "delta.h"
+#include "arena.h"
+#include "allpairs.h"
 #include <string.h> 
 #include <stdlib.h> 
 #include <stdio.h>
 
 /***********************************************************************************************************************
- * processFiles()
+ * readRestriction()
+ *
+ * Arguments: scanner - scanner over the clients file
+ *            restrictions - restrictions of the client being read
+ * Returns: 1 if the restriction was read, 0 (after reporting the line) if the file is malformed
+ * Side-Effects: reads from the clients file
+ *
+ * Description: reads one restriction code and its value. Unknown codes are skipped without reading a value.
+ ***********************************************************************************************************************/
+static int readRestriction(struct Scanner* scanner, struct Restrictions* restrictions) {
+    char restriction[10];
+
+    if (!expectWord(scanner, restriction, sizeof(restriction), "restriction")) return 0;
+    if (strcmp(restriction, "A1") == 0) {
+        restrictions->A1 = true;
+        return expectWord(scanner, restrictions->restrictedTransport, sizeof(restrictions->restrictedTransport), "A1 transport");
+    } else if (strcmp(restriction, "A2") == 0) {
+        restrictions->A2 = true;
+        return expectInt(scanner, &restrictions->maxDuration, "A2 duration");
+    } else if (strcmp(restriction, "A3") == 0) {
+        restrictions->A3 = true;
+        return expectInt(scanner, &restrictions->maxCost, "A3 cost");
+    } else if (strcmp(restriction, "B1") == 0) {
+        restrictions->B1 = true;
+        return expectInt(scanner, &restrictions->totalDuration, "B1 duration");
+    } else if (strcmp(restriction, "B2") == 0) {
+        restrictions->B2 = true; 
+        return expectInt(scanner, &restrictions->totalCost, "B2 cost");
+    }
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * readClient()
+ *
+ * Arguments: scanner - scanner over the clients file
+ *            graph - map graph, used to compile the restrictions
+ *            client - structure filled with the client's request
+ * Returns: 1 if a client was read, 0 at the end of the file or (after reporting the line) if the file is malformed
+ * Side-Effects: reads from the clients file
+ *
+ * Description: reads one client line: identifier, cities, departure time, filter and restrictions.
+ ***********************************************************************************************************************/
+int readClient(struct Scanner* scanner, const struct Graph* graph, struct Client* client) {
+    int numRestrictions;
+
+    if (scanInt(scanner, &client->clientID, "client id") != 1) return 0;
+    if (!expectInt(scanner, &client->startCity, "starting city")) return 0;
+    if (!expectInt(scanner, &client->endCity, "ending city")) return 0;
+    if (!expectInt(scanner, &client->departureTime, "departure time")) return 0;
+    if (!expectWord(scanner, client->filter, sizeof(client->filter), "filter")) return 0;
+    if (!expectInt(scanner, &numRestrictions, "number of restrictions")) return 0;
+
+    struct Restrictions* restrictions = &client->restrictions;
+    strcpy(restrictions->restrictedTransport, "");
+    restrictions->totalDuration = 0;
+    restrictions->totalCost = 0;
+    restrictions->maxCost = 0;
+    restrictions->maxDuration = 0;
+
+    if (numRestrictions < 0 || numRestrictions > 2) {
+        scanError(scanner, "expected 0, 1 or 2 restrictions", "number of restrictions");
+        return 0;
+    }
+
+    restrictions->A1 = false;
+    restrictions->A2 = false;
+    restrictions->A3 = false;
+    restrictions->B1 = false;
+    restrictions->B2 = false;
+
+    for (int i = 0; i < numRestrictions; i++) {
+        if (!readRestriction(scanner, restrictions)) return 0;
+    }
+
+    compile_restrictions(graph, restrictions);
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * readClients()
+ *
+ * Arguments: scanner - scanner over the clients file
+ *            graph - map graph
+ *            clients - set to the array of clients read
+ * Returns: number of clients read
+ * Side-Effects: reads the whole clients file, allocates dynamic memory
+ *
+ * Description: reads every client of the batch. Reading stops at the first malformed line; the clients before it
+ *              are still answered, as when the file was processed line by line.
+ ***********************************************************************************************************************/
+static int readClients(struct Scanner* scanner, const struct Graph* graph, struct Client** clients) {
+    int count = 0, capacity = 1024;
+    struct Client* array = malloc(capacity * sizeof(struct Client));
+    if (array == NULL) exit(0);
+
+    for (;;) {
+        if (count == capacity) {
+            capacity *= 2;
+            array = realloc(array, capacity * sizeof(struct Client));
+            if (array == NULL) exit(0);
+        }
+        if (!readClient(scanner, graph, &array[count])) break;
+        count++;
+    }
+
+    *clients = array;
+    return count;
+}
+
+/***********************************************************************************************************************
+ * loadMap()
+ *
+ * Arguments: mapsInput - input file containing the map, as text or as a binary snapshot
+ *            options - run options (file name, snapshot verification)
+ * Returns: pointer to the graph, or NULL if the map cannot be loaded
+ * Side-Effects: parses the text map or maps the snapshot into memory
+ *
+ * Description: snapshots are recognized by their magic number and mapped without parsing; anything else is read as
+ *              a text .map file.
+ ***********************************************************************************************************************/
+struct Graph* loadMap(FILE *mapsInput, const struct RunOptions* options) {
+    struct Scanner mapsScanner;
+
+    if (isSnapshot(mapsInput)) {
+        return mapSnapshot(mapsInput, options->verifySnapshot, options->mapsName);
+    }
+
+    if (!openScanner(&mapsScanner, mapsInput, options->mapsName)) return NULL;
+    struct Graph* graph = loadGraph(&mapsScanner);
+    closeScanner(&mapsScanner);
+    return graph;
+}
+
+/***********************************************************************************************************************
+ * compileFiles()
  *
  * Arguments: mapsInput - input file containing the map
+ *            graphOutput - binary file receiving the snapshot
+ *            options - run options (file names)
+ * Returns: 1 on success, 0 otherwise
+ * Side-Effects: reads the map and writes the snapshot file
+ *
+ * Description: loads the map once and stores it as a .graph snapshot that later runs can map directly.
+ ***********************************************************************************************************************/
+int compileFiles(FILE *mapsInput, FILE *graphOutput, const struct RunOptions* options) {
+    struct Graph* graph = loadMap(mapsInput, options);
+    if (!graph) return 0;
+
+    int written = writeSnapshot(graph, graphOutput);
+    if (!written) fprintf(stderr, "%s: cannot write graph snapshot\n", options->clientsName);
+
+    freeGraph(graph);
+    return written;
+}
+
+/***********************************************************************************************************************
+ * landmarkFiles()
+ *
+ * Arguments: mapsInput - input file containing the map (text or binary snapshot)
+ *            landmarksOutput - binary file receiving the landmark tables
+ *            numLandmarks - number of landmarks to pick
+ *            options - run options (file names)
+ * Returns: 1 on success, 0 otherwise
+ * Side-Effects: runs one full search per landmark, writes the .lmk file and prints how much A* saves on stdout
+ *
+ * Description: preprocessing step of the "alt" engine.
+ ***********************************************************************************************************************/
+int landmarkFiles(FILE *mapsInput, FILE *landmarksOutput, int numLandmarks, const struct RunOptions* options) {
+    struct Graph* graph = loadMap(mapsInput, options);
+    if (!graph) return 0;
+
+    struct Workspace* ws = createWorkspace(graph->numCities);
+    struct Landmarks* landmarks = computeLandmarks(graph, numLandmarks, ws);
+
+    int written = writeLandmarks(landmarks, graph, landmarksOutput);
+    if (!written) fprintf(stderr, "%s: cannot write landmarks\n", options->clientsName);
+    else reportLandmarks(graph, landmarks, ws, 100, stdout);
+
+    freeLandmarks(landmarks);
+    freeWorkspace(ws);
+    freeGraph(graph);
+    return written;
+}
+
+/***********************************************************************************************************************
+ * contractFiles()
+ *
+ * Arguments: mapsInput - input file containing the map (text or binary snapshot)
+ *            hierarchyOutput - binary file receiving the contraction hierarchy
+ *            options - run options (file names)
+ * Returns: 1 on success, 0 otherwise
+ * Side-Effects: contracts the map, writes the .ch file and prints its size on stdout
+ *
+ * Description: preprocessing step of the "ch" engine.
+ ***********************************************************************************************************************/
+int contractFiles(FILE *mapsInput, FILE *hierarchyOutput, const struct RunOptions* options) {
+    struct Graph* graph = loadMap(mapsInput, options);
+    if (!graph) return 0;
+
+    struct Hierarchy* hierarchy = buildHierarchy(graph);
+    int shortcuts = 0;
+    for (int i = 0; i < hierarchy->numArcs; i++) {
+        if (hierarchy->arcs[i].second >= 0) shortcuts++;
+    }
+
+    int written = writeHierarchy(hierarchy, graph, hierarchyOutput);
+    if (!written) fprintf(stderr, "%s: cannot write hierarchy\n", options->clientsName);
+    else printf("%d cities, %d contracted, core of %d cities, %d shortcut arcs\n", graph->numCities,
+                graph->numCities - hierarchy->coreSize, hierarchy->coreSize, shortcuts);
+
+    freeHierarchy(hierarchy);
+    freeGraph(graph);
+    return written;
+}
+
+/***********************************************************************************************************************
+ * openIndex()
+ *
+ * Arguments: options - run options (map file name)
+ *            extension - extension of the preprocessed file
+ *            command - command that creates it, for the warning
+ *            name - set to the name of the file (to be freed by the caller)
+ * Returns: the open file, or NULL after a warning on stderr
+ * Side-Effects: opens the file
+ *
+ * Description: preprocessed data of "name.map" or "name.graph" is stored in "name" plus its own extension.
+ ***********************************************************************************************************************/
+static FILE* openIndex(const struct RunOptions* options, const char* extension, const char* command, char** name) {
+    *name = replaceExtension(options->mapsName, extension);
+    FILE* input = fopen(*name, "rb");
+    if (input == NULL) {
+        fprintf(stderr, "%s: not found (run \"%s\" on the map first), searching without it\n", *name, command);
+    }
+    return input;
+}
+
+/***********************************************************************************************************************
+ * loadLandmarks()
+ *
+ * Arguments: graph - map graph
+ *            options - run options (map file name)
+ * Returns: landmarks stored beside the map, or NULL if there are none usable (reported on stderr)
+ * Side-Effects: reads the .lmk file
+ *
+ * Description: the landmarks of "name.map" or "name.graph" are in "name.lmk".
+ ***********************************************************************************************************************/
+static struct Landmarks* loadLandmarks(const struct Graph* graph, const struct RunOptions* options) {
+    char* name;
+    struct Landmarks* landmarks = NULL;
+
+    FILE* input = openIndex(options, ".lmk", "landmarks", &name);
+    if (input != NULL) {
+        landmarks = readLandmarks(input, graph, name);
+        fclose(input);
+    }
+    free(name);
+    return landmarks;
+}
+
+/***********************************************************************************************************************
+ * loadHierarchy()
+ *
+ * Arguments: graph - map graph
+ *            options - run options (map file name)
+ * Returns: contraction hierarchy stored beside the map, or NULL if there is none usable (reported on stderr)
+ * Side-Effects: reads the .ch file
+ *
+ * Description: the hierarchy of "name.map" or "name.graph" is in "name.ch".
+ ***********************************************************************************************************************/
+static struct Hierarchy* loadHierarchy(const struct Graph* graph, const struct RunOptions* options) {
+    char* name;
+    struct Hierarchy* hierarchy = NULL;
+
+    FILE* input = openIndex(options, ".ch", "contract", &name);
+    if (input != NULL) {
+        hierarchy = readHierarchy(input, graph, name);
+        fclose(input);
+    }
+    free(name);
+    return hierarchy;
+}
+
+/***********************************************************************************************************************
+ * loadIndexes()
+ *
+ * Arguments: graph - map graph
+ *            options - run options (engines, map file name)
+ *            indexes - filled with the preprocessed data of the enabled engines
+ * Returns: void
+ * Side-Effects: reads the .lmk and .ch files beside the map, builds the timetable
+ *
+ * Description: an engine whose data is missing is left out (with a warning) and its queries use Dijkstra.
+ ***********************************************************************************************************************/
+static void loadIndexes(const struct Graph* graph, const struct RunOptions* options, struct Indexes* indexes) {
+    indexes->landmarks = (options->engines & ENGINE_ALT) ? loadLandmarks(graph, options) : NULL;
+    indexes->hierarchy = (options->engines & ENGINE_CH) ? loadHierarchy(graph, options) : NULL;
+    indexes->timetable = (options->engines & ENGINE_CSA) ? buildTimetable(graph) : NULL;
+}
+
+/***********************************************************************************************************************
+ * freeIndexes()
+ *
+ * Arguments: indexes - data loaded by loadIndexes()
+ * Returns: void
+ * Side-Effects: frees dynamically allocated memory
+ *
+ * Description: NULL members are ignored.
+ ***********************************************************************************************************************/
+static void freeIndexes(struct Indexes* indexes) {
+    freeLandmarks(indexes->landmarks);
+    freeHierarchy(indexes->hierarchy);
+    freeTimetable(indexes->timetable);
+}
+
+/***********************************************************************************************************************
+ * createCaches()
+ *
+ * Arguments: options - run options (--cache and --subgraphs budgets)
+ *            caches - filled with the caches asked for, NULL members otherwise
+ * Returns: void
+ * Side-Effects: allocates the caches
+ *
+ * Description: the workspaces and the scratch arena are left to solveBatch(), the cost table to chooseCostTable().
+ ***********************************************************************************************************************/
+static void createCaches(const struct RunOptions* options, struct Caches* caches) {
+    caches->results = options->cacheMegabytes > 0 ? createResultCache((size_t)options->cacheMegabytes << 20) : NULL;
+    caches->subgraphs = options->subgraphMegabytes > 0 ? createSubgraphCache((size_t)options->subgraphMegabytes << 20) : NULL;
+    caches->workspaces = NULL;
+    caches->scratch = NULL;
+    caches->costs = NULL;
+}
+
+/***********************************************************************************************************************
+ * chooseCostTable()
+ *
+ * Arguments: graph - map graph
+ *            clients - clients of the file
+ *            numClients - number of clients
+ *            options - run options (engines)
+ * Returns: an empty all-pairs cost table, or NULL if searching is the better choice
+ * Side-Effects: allocates the table
+ *
+ * Description: counts the cost queries the table would answer and lets costTablePays() decide from that count and
+ *              the number of cities: small maps with many such queries per city.
+ ***********************************************************************************************************************/
+static struct CostTable* chooseCostTable(const struct Graph* graph, const struct Client* clients, int numClients, const struct RunOptions* options) {
+    bool budgetAware = (options->engines & ENGINE_RCSP) != 0;
+    int eligible = 0;
+    for (int i = 0; i < numClients; i++) {
+        if (costTableEligible(graph, &clients[i], budgetAware)) eligible++;
+    }
+    return costTablePays(graph->numCities, eligible) ? createCostTable(graph) : NULL;
+}
+
+/***********************************************************************************************************************
+ * applyDelta()
+ *
+ * Arguments: graph - loaded map
+ *            indexes - preprocessed data of the enabled engines, loaded for the map as it was
+ *            caches - caches and workspaces
+ *            options - run options (--delta file name)
+ * Returns: void
+ * Side-Effects: reads the delta file, changes the graph and repairs what depends on it
+ *
+ * Description: applies the changes of the --delta file in order. Reading stops at the first change that cannot be
+ *              applied (reported on stderr); the changes before it are kept.
+ ***********************************************************************************************************************/
+static void applyDelta(struct Graph* graph, struct Indexes* indexes, struct Caches* caches, const struct RunOptions* options) {
+    struct Scanner scanner;
+    struct Update update;
+
+    FILE* input = fopen(options->deltaName, "r");
+    if (input == NULL) {
+        fprintf(stderr, "%s: cannot open the delta file, using the map as it is\n", options->deltaName);
+        return;
+    }
+    if (openScanner(&scanner, input, options->deltaName)) {
+        startUpdate(&update, graph);
+        while (readChange(&scanner, &update)) {
+        }
+        finishUpdate(&update);
+        repairIndexes(&update, indexes, caches, options);
+        freeUpdate(&update);
+    }
+    closeScanner(&scanner);
+    fclose(input);
+}
+
+/***********************************************************************************************************************
+ * compareLatency()
+ *
+ * Arguments: a, b - pointers to two latencies
+ * Returns: negative, zero or positive as for qsort
+ * Side-Effects: none
+ *
+ * Description: ascending order of latencies.
+ ***********************************************************************************************************************/
+static int compareLatency(const void* a, const void* b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+/***********************************************************************************************************************
+ * writeStatsFile()
+ *
+ * Arguments: options - run options (the stats file is named after the clients file)
+ *            run - wall time of each phase
+ *            clients - clients of the batch
+ *            queries - measurements of each client
+ *            numClients - number of clients
+ * Returns: void
+ * Side-Effects: creates the .stats file
+ *
+ * Description: writes the --stats report beside the .sol file.
+ ***********************************************************************************************************************/
+static void writeStatsFile(const struct RunOptions* options, const struct RunStats* run, const struct Client* clients, const struct QueryStats* queries, int numClients) {
+    char* name = replaceExtension(options->clientsName, ".stats");
+    FILE* output = fopen(name, "w");
+    if (output == NULL) {
+        fprintf(stderr, "%s: cannot create the stats file\n", name);
+    } else {
+        writeStats(output, run, clients, queries, numClients);
+        fclose(output);
+    }
+    free(name);
+}
+
+/***********************************************************************************************************************
+ * reportBench()
+ *
+ * Arguments: graph - map graph
+ *            options - run options
+ *            cache - result cache, or NULL
+ *            loadTime - nanoseconds spent reading the map and the clients
+ *            solveTime - nanoseconds spent solving and writing the batch
+ *            queries - measurements of each client
+ *            numClients - number of clients
+ * Returns: void
+ * Side-Effects: prints one JSON object on stdout
+ *
+ * Description: the figures "make bench" collects: load time, queries per second and latency percentiles, and the
+ *              hits and misses of the result cache when there is one.
+ ***********************************************************************************************************************/
+static void reportBench(const struct Graph* graph, const struct RunOptions* options, const struct ResultCache* cache, long long loadTime, long long solveTime, const struct QueryStats* queries, int numClients) {
+    long long* latency = malloc((numClients > 0 ? numClients : 1) * sizeof(long long));
+    if (latency == NULL) exit(0);
+    for (int i = 0; i < numClients; i++) latency[i] = queries[i].nanoseconds;
+    qsort(latency, numClients, sizeof(long long), compareLatency);
+    long long p50 = numClients > 0 ? latency[(numClients - 1) / 2] : 0;
+    long long p99 = numClients > 0 ? latency[(int)((numClients - 1) * 0.99)] : 0;
+    long long maximum = numClients > 0 ? latency[numClients - 1] : 0;
+
+    printf("{\"map\": \"%s\", \"clients\": \"%s\", \"cities\": %d, \"connections\": %d, \"queries\": %d, "
+           "\"threads\": %d, \"load_ms\": %.3f, \"solve_ms\": %.3f, \"queries_per_sec\": %.1f, "
+           "\"latency_us\": {\"p50\": %.1f, \"p99\": %.1f, \"max\": %.1f}",
+           options->mapsName, options->clientsName, graph->numCities, graph->numEdges / 2, numClients,
+           options->numThreads, loadTime / 1e6, solveTime / 1e6, solveTime > 0 ? numClients / (solveTime / 1e9) : 0.0,
+           p50 / 1e3, p99 / 1e3, maximum / 1e3);
+    if (cache != NULL) {
+        printf(", \"cache\": {\"hits\": %lld, \"misses\": %lld, \"kib\": %.1f}", cache->hits, cache->misses, cache->bytes / 1024.0);
+    }
+    printf("}\n");
+    free(latency);
+}
+
+/***********************************************************************************************************************
+ * processFiles()
+ *
+ * Arguments: mapsInput - input file containing the map (text or binary snapshot)
  *            clientsInput - input file containing clients and their requests
  *            output - output file where results will be written
+ *            options - run options (number of threads, engines, benchmark and stats reports)
  * Returns: 0
  * Side-Effects: reads data from input files and writes results to the output file
  *               allocates and frees dynamic memory
- *               calls dijkstra() to process each client
+ *               calls solveBatch() to answer every client
  *
- * Description: reads input files, builds the adjacency list representing the map graph,
- *              reads each client's information and restrictions, and executes Dijkstra's algorithm.
+ * Description: reads input files, builds the CSR graph representing the map,
+ *              reads every client's information and restrictions, and solves the batch
+ *              serially or on options->numThreads threads.
  ***********************************************************************************************************************/
-int processFiles(FILE *mapsInput, FILE *clientsInput, FILE *output) {
-    int clientID, numClients, numRestrictions, cities, connections, startCity, endCity, departureTime;
-    char filter[6], restriction[3];
+int processFiles(FILE *mapsInput, FILE *clientsInput, FILE *output, const struct RunOptions* options) {
+    int numClients;
+    struct Scanner clientsScanner;
+    struct RunStats run;
+    long long start = nowNanoseconds();
 
-    if (fscanf(mapsInput, "%d", &cities) != 1) return 0;
-    if (fscanf(mapsInput, "%d", &connections) != 1) return 0; 
-    if (fscanf(clientsInput, "%d", &numClients) != 1) return 0;
+    struct Graph* graph = loadMap(mapsInput, options);
+    if (!graph) return 0;
+    long long mapRead = nowNanoseconds();
 
-    struct Adjacency** adj = malloc(cities * sizeof(struct Adjacency*));
-    if (!adj) {
-        fclose(clientsInput);
-        fclose(mapsInput);
-        fclose(output);
+    // The engines' data is checked against the map as loaded, then repaired for the --delta changes, which come
+    // before the clients so their transport names are known
+    struct Indexes indexes;
+    loadIndexes(graph, options, &indexes);
+    struct Caches caches;
+    createCaches(options, &caches);
+    if (options->deltaName != NULL) applyDelta(graph, &indexes, &caches, options);
+    long long indexed = nowNanoseconds();
+
+    if (!openScanner(&clientsScanner, clientsInput, options->clientsName) ||
+        !expectInt(&clientsScanner, &numClients, "number of clients")) {
+        closeScanner(&clientsScanner);
+        freeResultCache(caches.results);
+        freeSubgraphCache(caches.subgraphs);
+        freeIndexes(&indexes);
+        freeGraph(graph);
         return 0;
     }
-    for (int i = 0; i < cities; i++) {
-        adj[i] = NULL;
-    }
-
-    for (int i = 0; i < connections; i++) {
-        struct Path paths;
-        if (fscanf(mapsInput, "%d %d %9s %d %d %d %d %d", &paths.originCity, &paths.destinationCity, paths.transport, &paths.travelDuration, &paths.travelCost, &paths.firstDeparture, &paths.lastDeparture, &paths.departurePeriodicity) != 8) return 0;
-
-        struct Adjacency* newAdj = malloc(sizeof(struct Adjacency));
-        if (!newAdj) return 0;
-        newAdj->path = paths;
-        newAdj->next = adj[paths.originCity - 1];
-        adj[paths.originCity - 1] = newAdj;
-
-        struct Adjacency* reverse = malloc(sizeof(struct Adjacency));
-        if (!reverse) return 0;
-        reverse->path = paths;
-        reverse->path.originCity = paths.destinationCity;
-        reverse->path.destinationCity = paths.originCity;
-        reverse->next = adj[paths.destinationCity - 1];
-        adj[paths.destinationCity - 1] = reverse;
-    }
-
-    while (fscanf(clientsInput, "%d", &clientID) == 1) {
-        if (fscanf(clientsInput, "%d", &startCity) != 1) return 0;
-        if (fscanf(clientsInput, "%d", &endCity) != 1) return 0;
-        if (fscanf(clientsInput, "%d", &departureTime) != 1) return 0;
-        if (fscanf(clientsInput, "%s", filter) != 1) return 0;
-        if (fscanf(clientsInput, "%d", &numRestrictions) != 1) return 0;
-
-        struct Restrictions* clientRestrictions = malloc(sizeof(struct Restrictions));
-        if (!clientRestrictions) {
-            fclose(clientsInput);
-            fclose(mapsInput);
-            fclose(output);
-            free(adj);
-            exit(0);
-        }
 
-        strcpy(clientRestrictions->restrictedTransport, "");
-        clientRestrictions->totalDuration = 0;
-        clientRestrictions->totalCost = 0;
-        clientRestrictions->maxCost = 0;
-        clientRestrictions->maxDuration = 0;
-
-        if (numRestrictions < 0 || numRestrictions > 2) return 0;
-
-        clientRestrictions->A1 = false;
-        clientRestrictions->A2 = false;
-        clientRestrictions->A3 = false;
-        clientRestrictions->B1 = false;
-        clientRestrictions->B2 = false;
-
-        switch (numRestrictions) {
-            case 0:
-                break;
-            case 1:
-                if (fscanf(clientsInput, "%s", restriction) != 1) return 0;
-                if (strcmp(restriction, "A1") == 0) {
-                    clientRestrictions->A1 = true;
-                    if(fscanf(clientsInput, "%9s", clientRestrictions->restrictedTransport) != 1) return 0;
-                } else if (strcmp(restriction, "A2") == 0) {
-                    clientRestrictions->A2 = true;
-                    if(fscanf(clientsInput, "%d", &clientRestrictions->maxDuration) != 1) return 0;
-                } else if (strcmp(restriction, "A3") == 0) {
-                    clientRestrictions->A3 = true;
-                    if(fscanf(clientsInput, "%d", &clientRestrictions->maxCost) != 1) return 0;
-                } else if (strcmp(restriction, "B1") == 0) {
-                    clientRestrictions->B1 = true;
-                    if(fscanf(clientsInput, "%d", &clientRestrictions->totalDuration) != 1) return 0;
-                } else if (strcmp(restriction, "B2") == 0) {
-                    clientRestrictions->B2 = true; 
-                    if(fscanf(clientsInput, "%d", &clientRestrictions->totalCost) != 1) return 0;
-                }
-                break;
-            case 2:
-                for (int i = 0; i < 2; i++) {
-                    if (fscanf(clientsInput, "%s", restriction) != 1) return 0;
-                    if (strcmp(restriction, "A1") == 0) {
-                        clientRestrictions->A1 = true;
-                        if(fscanf(clientsInput, "%9s", clientRestrictions->restrictedTransport) != 1) return 0;
-                    } else if (strcmp(restriction, "A2") == 0) {
-                        clientRestrictions->A2 = true;
-                        if(fscanf(clientsInput, "%d", &clientRestrictions->maxDuration) != 1) return 0;
-                    } else if (strcmp(restriction, "A3") == 0) {
-                        clientRestrictions->A3 = true;
-                        if(fscanf(clientsInput, "%d", &clientRestrictions->maxCost) != 1) return 0;
-                    } else if (strcmp(restriction, "B1") == 0) {
-                        clientRestrictions->B1 = true;
-                        if(fscanf(clientsInput, "%d", &clientRestrictions->totalDuration) != 1) return 0;
-                    } else if (strcmp(restriction, "B2") == 0) {
-                        clientRestrictions->B2 = true; 
-                        if(fscanf(clientsInput, "%d", &clientRestrictions->totalCost) != 1) return 0;
-                    }
-                }
-                break;
-            default:
-                break;    
-        }
+    struct Client* clients;
+    numClients = readClients(&clientsScanner, graph, &clients);
+    closeScanner(&clientsScanner);
+    caches.costs = chooseCostTable(graph, clients, numClients, options);
 
-        // In case of restriction violation, print "<clientID> -1"
-        if(endCity <= 0 || startCity <= 0 || endCity > cities || startCity > cities){
-            free(clientRestrictions);
-            fprintf(output, "%d -1\n", clientID);
-            continue;
-        }
+    struct QueryStats* queries = NULL;
+    if (options->bench || options->stats) {
+        queries = malloc((numClients > 0 ? numClients : 1) * sizeof(struct QueryStats));
+        if (queries == NULL) exit(0);
+    }
+    long long loaded = nowNanoseconds();
 
-        dijkstra(adj, *clientRestrictions, cities, startCity, endCity, departureTime, filter, clientID, output);
+    solveBatch(graph, &indexes, &caches, clients, numClients, options, output, queries);
+    fflush(output);
+    long long solved = nowNanoseconds();
 
-        free(clientRestrictions);
+    if (options->bench) {
+        reportBench(graph, options, caches.results, loaded - start, solved - loaded, queries, numClients);
     }
-
-    for (int i = 0; i < cities; i++) {
-        struct Adjacency* ptr = adj[i];
-        while (ptr) {
-            struct Adjacency* tmp = ptr;
-            ptr = ptr->next;
-            free(tmp);
-        }
+    if (options->stats) {
+        run.readMap = mapRead - start;
+        run.loadIndexes = indexed - mapRead;
+        run.readClients = loaded - indexed;
+        run.solve = solved - loaded;
+        run.numThreads = options->numThreads;
+        run.cache = caches.results;
+        run.subgraphs = caches.subgraphs;
+        writeStatsFile(options, &run, clients, queries, numClients);
     }
-    free(adj);
+    free(queries);
+
+    freeCostTable(caches.costs);
+    freeResultCache(caches.results);
+    freeSubgraphCache(caches.subgraphs);
+    freeIndexes(&indexes);
+    free(clients);
+    freeGraph(graph);
 
     return 0;
 }
+
+/***********************************************************************************************************************
+ * serveFiles()
+ *
+ * Arguments: mapsInput - input file containing the map (text or binary snapshot)
+ *            socketName - Unix domain socket to listen on, or NULL to answer stdin on stdout
+ *            options - run options (number of threads, engines, caches)
+ * Returns: 1 if the server ran until the end of its input or a stop signal, 0 if it could not start
+ * Side-Effects: loads the map once, answers client lines until stopped
+ *
+ * Description: the "serve" command. The map, the engines' data, the caches and one workspace per thread are loaded
+ *              before the first line is read and kept for every batch, and so is the arena holding a batch's arrays.
+ ***********************************************************************************************************************/
+int serveFiles(FILE *mapsInput, const char* socketName, const struct RunOptions* options) {
+    struct Graph* graph = loadMap(mapsInput, options);
+    if (!graph) return 0;
+
+    struct Indexes indexes;
+    loadIndexes(graph, options, &indexes);
+    struct Caches caches;
+    createCaches(options, &caches);
+    caches.workspaces = createWorkspaces(graph, options);
+    struct Arena scratch;
+    initArena(&scratch, 0);
+    caches.scratch = &scratch;
+    if (options->deltaName != NULL) applyDelta(graph, &indexes, &caches, options);
+
+    int served = serve(graph, &indexes, &caches, options, socketName);
+
+    freeWorkspaces(caches.workspaces, options);
+    freeArena(&scratch);
+    freeResultCache(caches.results);
+    freeSubgraphCache(caches.subgraphs);
+    freeIndexes(&indexes);
+    freeGraph(graph);
+    return served;
+}
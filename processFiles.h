@@ -17,7 +17,49 @@
 #include <stdlib.h>
 #include "dijkstra.h"
 
+// Search engines that can be enabled with -e (bitmask)
+#define ENGINE_BIDIRECTIONAL 1u   // "bidir": bidirectional Dijkstra for single cost queries
+#define ENGINE_ALT 2u             // "alt": A* with landmark lower bounds for single cost queries
+#define ENGINE_CH 4u              // "ch": contraction hierarchy for cost queries without filters
+#define ENGINE_CSA 8u             // "csa": connection scan for duration queries
+#define ENGINE_RCSP 16u           // "rcsp": label setting search keeping the B1/B2 budgets
+
+// Options given on the command line
+struct RunOptions {
+    int numThreads;             // -j: worker threads used to solve clients
+    unsigned int engines;       // -e: ENGINE_* flags
+    int queue;                  // -q: QUEUE_* priority queue of the searches
+    int verifySnapshot;         // --verify: check the payload checksum of a .graph snapshot
+    int bench;                  // "bench": print load time, throughput and latencies as JSON on stdout
+    int stats;                  // --stats: write timings and search counters to a .stats file
+    int cacheMegabytes;         // --cache: memory budget of the result cache, 0 without a cache
+    int subgraphMegabytes;      // --subgraphs: memory budget of the subgraph views, 0 without views
+    const char* deltaName;      // --delta: changes applied to the map before answering (see delta.h), NULL without
+    const char* mapsName;       // file names, used in error messages
+    const char* clientsName;
+};
+
+struct Scanner;
+
+// Reads one client line (restrictions compiled for the graph); returns 0 at the end of the input or on a bad line
+int readClient(struct Scanner* scanner, const struct Graph* graph, struct Client* client);
+
+// Loads the map from a text .map file or a binary .graph snapshot
+struct Graph* loadMap(FILE *mapsInput, const struct RunOptions* options);
+
+// Compiles a text map into a binary snapshot
+int compileFiles(FILE *mapsInput, FILE *graphOutput, const struct RunOptions* options);
+
+// Picks landmarks on the map and writes their distance tables to a .lmk file
+int landmarkFiles(FILE *mapsInput, FILE *landmarksOutput, int numLandmarks, const struct RunOptions* options);
+
+// Contracts the map into a hierarchy and writes it to a .ch file
+int contractFiles(FILE *mapsInput, FILE *hierarchyOutput, const struct RunOptions* options);
+
 // Processes input files and executes Dijkstra for each client
-int processFiles(FILE *mapsInput, FILE *clientsInput, FILE *output);
+int processFiles(FILE *mapsInput, FILE *clientsInput, FILE *output, const struct RunOptions* options);
+
+// Keeps the map loaded and answers client lines from stdin, or from a Unix domain socket if socketName is not NULL
+int serveFiles(FILE *mapsInput, const char* socketName, const struct RunOptions* options);
 
 #endif
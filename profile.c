@@ -0,0 +1,167 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: profile.c
+* Description: Profile engine for duration queries: one sweep over the minutes of the day for the clients of a start
+*              city, from the latest to the earliest, each search starting from the arrivals of the previous one.
+*/
+
+#include "profile.h"
+#include "heap.h"
+#include <string.h>
+
+/***********************************************************************************************************************
+ * startProfile()
+ *
+ * Arguments: ws - query workspace
+ * Returns: void
+ * Side-Effects: allocates the workspace's second set of per-city arrays on the first call, empties them
+ *
+ * Description: the profile (best arrival, predecessor city and edge of every city) is kept in the arrays of
+ *              reverseWorkspace(), so ws itself is free for each search of the sweep.
+ ***********************************************************************************************************************/
+void startProfile(struct Workspace* ws) {
+    resetWorkspace(reverseWorkspace(ws));
+}
+
+/***********************************************************************************************************************
+ * profileBound()
+ *
+ * Arguments: profile - arrays of the sweep
+ *            targets - 1-based target cities, all touched in the profile
+ *            numTargets - number of entries in targets
+ * Returns: latest arrival at a target
+ * Side-Effects: none
+ *
+ * Description: a search can stop once every city left in its queue is reached at this time or later: from there
+ *              no target can be reached sooner.
+ ***********************************************************************************************************************/
+static int profileBound(const struct Workspace* profile, const int* targets, int numTargets) {
+    int bound = 0;
+    for (int i = 0; i < numTargets; i++) {
+        if (profile->weight[targets[i] - 1] > bound) bound = profile->weight[targets[i] - 1];
+    }
+    return bound;
+}
+
+/***********************************************************************************************************************
+ * profile_search()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            ws - query workspace, after startProfile()
+ *            restrictions - structure containing travel restrictions
+ *            startCity - source city
+ *            minute - departure minute of the day, below the one of the previous search of the sweep
+ *            targets - cities whose arrivals are wanted
+ *            numTargets - number of entries in targets
+ * Returns: number of cities settled
+ * Side-Effects: overwrites the search state kept in the workspace, lowers the arrivals of the profile
+ *
+ * Description: Dijkstra on arrival times in which a city starts at its arrival in the profile instead of infinity,
+ *              so only the cities reached sooner than when leaving later are queued; a city settled copies its
+ *              arrival and predecessor to the profile. The arrivals of the profile are reached by waiting at the
+ *              start and were settled (their connections relaxed) by an earlier search, so they are bounds the
+ *              result does not go below. While a target has never been reached the search stops like
+ *              dijkstra_search(), when it is settled; after that, when the queue reaches the latest arrival at a
+ *              target. That bound only goes down, so it is computed again at most twice per search.
+ ***********************************************************************************************************************/
+int profile_search(const struct Graph* graph, struct Workspace* ws, struct Restrictions restrictions, int startCity, int minute, const int* targets, int numTargets) {
+    struct Workspace* profile = ws->reverse;
+    int* weight = ws->weight;
+    int* heapIndex = ws->heapIndex;
+    int* best = profile->weight;
+    unsigned int* targetStamp = ws->targetStamp;
+    struct minHeap* heap = ws->heap;
+    bool filtered = restrictions.A1 || restrictions.A2 || restrictions.A3;
+
+    resetWorkspace(ws);
+    unsigned int epoch = ws->epoch;
+
+    int unreached = 0;
+    for (int i = 0; i < numTargets; i++) {
+        int target = targets[i] - 1;
+        touchCity(profile, target);
+        if (targetStamp[target] == epoch) continue;
+        targetStamp[target] = epoch;
+        if (best[target] == INF) unreached++;
+    }
+    int bound = unreached > 0 ? INF : profileBound(profile, targets, numTargets);
+
+    int s = startCity - 1;
+    touchCity(ws, s);
+    touchCity(profile, s);
+    weight[s] = minute;
+    insertMinHeap(heap, s, minute, heapIndex);
+
+    int settled = 0;
+    while (!isEmpty(heap)) {
+        if (minKey(heap, heapIndex) >= bound) {
+            bound = profileBound(profile, targets, numTargets);
+            if (minKey(heap, heapIndex) >= bound) break;
+        }
+        int u = extractMin(heap, heapIndex).city;
+        heapIndex[u] = -2;
+        settled++;
+        STAT(ws->counters.settled++);
+
+        bool reached = targetStamp[u] == epoch && best[u] == INF;
+        best[u] = weight[u];
+        profile->prevCity[u] = ws->prevCity[u];
+        profile->prevEdge[u] = ws->prevEdge[u];
+        if (reached && --unreached == 0) bound = profileBound(profile, targets, numTargets);
+
+        int weightU = weight[u];
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            const struct Edge* edge = &graph->edges[e];
+            STAT(ws->counters.scanned++);
+            if (filtered && !check_restrictions(restrictions, edge)) {
+                STAT(ws->counters.filtered++);
+                continue;
+            }
+            int v = edge->destination;
+            if (ws->stamp[v] != epoch) {
+                touchCity(ws, v);
+                touchCity(profile, v);
+                weight[v] = best[v];
+            }
+            if (heapIndex[v] == -2) continue;
+
+            int arrival = weightU + waiting_time(weightU, edge) + edge->travelDuration;
+            if (arrival < weight[v]) {
+                weight[v] = arrival;
+                ws->prevCity[v] = u;
+                ws->prevEdge[v] = e;
+                if (heapIndex[v] == -1) insertMinHeap(heap, v, arrival, heapIndex);
+                else decreaseKey(heap, v, arrival, heapIndex);
+            }
+        }
+    }
+    return settled;
+}
+
+/***********************************************************************************************************************
+ * write_profile()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            ws - query workspace holding the sweep
+ *            client - duration client whose departure minute is the one of the last profile_search()
+ *            output - buffer receiving the .sol line
+ * Returns: true if the line was written, false if the client must be searched with Dijkstra
+ * Side-Effects: appends the result to the output buffer
+ *
+ * Description: the arrival of the profile moved to the client's day, and the path of the profile's predecessors;
+ *              write_tree() replays its waiting times from the client's own departure time. A predecessor may have
+ *              been kept by a later minute, so when another connection arrives as early at a city of the path (see
+ *              unique_path()) Dijkstra may pick a different path and nothing is written. The arrivals of the
+ *              profile below the bound of the last search are the earliest ones, as unique_path() needs.
+ ***********************************************************************************************************************/
+bool write_profile(const struct Graph* graph, struct Workspace* ws, const struct Client* client, struct SolBuffer* output) {
+    struct Workspace* profile = ws->reverse;
+    int endCity = client->endCity - 1;
+    touchCity(profile, endCity);
+    int arrival = profile->weight[endCity];
+    if (arrival != INF && !unique_path(graph, profile, client->restrictions, client->startCity, client->endCity)) return false;
+    int dayStart = client->departureTime - client->departureTime % 1440;
+    write_tree(graph, profile, client, arrival == INF ? INF : dayStart + arrival, output);
+    return true;
+}
@@ -0,0 +1,48 @@
+/******************************************************************************
+ * NAME
+ *   profile.h
+ *
+ * DESCRIPTION
+ *   Header file for the profile engine: the earliest arrivals from one start
+ *   city for many departure minutes, found in a single sweep.
+ *
+ * COMMENTS
+ *   waiting_time() only looks at the minute of the day, so the arrival
+ *   function of a start city repeats every day and a client leaving at
+ *   day * 1440 + minute arrives day * 1440 minutes after one leaving at that
+ *   minute. The sweep searches every minute of the day, from 1439 down to
+ *   the earliest departure minute of its clients. Leaving earlier is never
+ *   worse, because the traveller can wait at the start, so the arrival at
+ *   every city found for a later minute bounds the arrival for an earlier
+ *   one: each search starts from those arrivals and only explores the cities
+ *   it reaches sooner. The first search costs as much as Dijkstra's, the
+ *   next ones only what changes from one minute to the one before. The
+ *   arrivals and predecessors kept across the sweep are the profile at the
+ *   current minute, so the clients of that minute are answered from them by
+ *   walking the predecessors. A predecessor kept from a later minute may be
+ *   another path than the one Dijkstra writes when two arrive at the same
+ *   time; those clients are searched again with Dijkstra.
+ *
+ ******************************************************************************/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "dijkstra.h"
+
+// Duration queries from one start city (with the same connection filters) answered by one sweep, at least; a sweep
+// costs a few dozen searches of Dijkstra, and on maps with many ties a share of its clients is searched again
+#define PROFILE_MIN_CLIENTS 128
+
+// Starts a sweep on the workspace, forgetting the arrivals of the previous one
+void startProfile(struct Workspace* ws);
+
+// Adds the earliest arrivals from startCity leaving at minute (0 .. 1439, below the previous search of the sweep) to
+// the profile, at least for the target cities; returns the number of cities settled
+int profile_search(const struct Graph* graph, struct Workspace* ws, struct Restrictions restrictions, int startCity, int minute, const int* targets, int numTargets);
+
+// Writes the .sol line of a duration client of the sweep whose departure minute was the last one searched; returns
+// false, writing nothing, if Dijkstra could have picked another path of the same duration
+bool write_profile(const struct Graph* graph, struct Workspace* ws, const struct Client* client, struct SolBuffer* output);
+
+#endif
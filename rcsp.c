@@ -0,0 +1,257 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: rcsp.c
+* Description: Label setting search for queries with a B1 or B2 budget: Pareto frontiers of (primary, secondary)
+*              labels per city, with labels over a budget pruned as they are created.
+*/
+
+#include "rcsp.h"
+#include "heap.h"
+#include <string.h>
+#include <stdlib.h>
+
+/***********************************************************************************************************************
+ * labelPool()
+ *
+ * Arguments: ws - query workspace
+ * Returns: the workspace's label pool, emptied
+ * Side-Effects: allocates the pool on the first call, exits if memory runs out
+ *
+ * Description: RCSP_POOL_PER_CITY labels per city of the map, at least RCSP_MIN_POOL.
+ ***********************************************************************************************************************/
+static struct LabelPool* labelPool(struct Workspace* ws) {
+    struct LabelPool* pool = ws->labels;
+    if (pool == NULL) {
+        long long capacity = (long long)ws->numCities * RCSP_POOL_PER_CITY;
+        if (capacity < RCSP_MIN_POOL) capacity = RCSP_MIN_POOL;
+        if (capacity > INT_MAX / 2) capacity = INT_MAX / 2;
+
+        pool = malloc(sizeof(struct LabelPool));
+        if (pool == NULL) exit(0);
+        pool->capacity = (int)capacity;
+        pool->labels = malloc(capacity * sizeof(struct Label));
+        pool->heapIndex = malloc(capacity * sizeof(int));
+        pool->heap = createMinHeap(pool->capacity);
+        if (pool->labels == NULL || pool->heapIndex == NULL || pool->heap == NULL) exit(0);
+        ws->labels = pool;
+    }
+    pool->size = 0;
+    clearMinHeap(pool->heap);
+    return pool;
+}
+
+/***********************************************************************************************************************
+ * freeLabelPool()
+ *
+ * Arguments: pool - pointer to the label pool
+ * Returns: void
+ * Side-Effects: frees dynamically allocated memory
+ *
+ * Description: frees the labels, the queue and the structure.
+ ***********************************************************************************************************************/
+void freeLabelPool(struct LabelPool* pool) {
+    if (pool == NULL) return;
+    free(pool->labels);
+    free(pool->heapIndex);
+    freeMinHeap(pool->heap);
+    free(pool);
+}
+
+/***********************************************************************************************************************
+ * reachCity()
+ *
+ * Arguments: ws - query workspace
+ *            city - 0-based city
+ * Returns: void
+ * Side-Effects: initializes the city's entries the first time the query reaches it
+ *
+ * Description: weight holds the smallest secondary weight settled at the city (INF before the first label) and
+ *              potential the number of labels it settled.
+ ***********************************************************************************************************************/
+static void reachCity(struct Workspace* ws, int city) {
+    if (ws->stamp[city] != ws->epoch) {
+        touchCity(ws, city);
+        ws->potential[city] = 0;
+    }
+}
+
+/***********************************************************************************************************************
+ * growLabelPool()
+ *
+ * Arguments: pool - full label pool
+ * Returns: void
+ * Side-Effects: doubles the labels, their queue positions and the queue, keeping their contents; exits if memory runs
+ *               out
+ *
+ * Description: used by the exact search, which has no bound on the labels of a query.
+ ***********************************************************************************************************************/
+static void growLabelPool(struct LabelPool* pool) {
+    if (pool->capacity > INT_MAX / 2) exit(0);
+    int capacity = 2 * pool->capacity;
+    pool->labels = realloc(pool->labels, capacity * sizeof(struct Label));
+    pool->heapIndex = realloc(pool->heapIndex, capacity * sizeof(int));
+    pool->heap->arr = realloc(pool->heap->arr, capacity * sizeof(struct heapNode));
+    if (pool->labels == NULL || pool->heapIndex == NULL || pool->heap->arr == NULL) exit(0);
+    pool->capacity = capacity;
+    pool->heap->capacity = capacity;
+}
+
+/***********************************************************************************************************************
+ * searchLabels()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            ws - query workspace
+ *            client - query with valid start and end cities
+ *            maxFrontier - labels a city may settle
+ *            exact - true to grow the pool when it is full instead of giving up
+ *            truncated - set to true when a label that is not dominated is dropped by maxFrontier or the pool
+ * Returns: index in the pool of the first label settled at the end city, or -1 if none was
+ * Side-Effects: overwrites the search state kept in the workspace and the label pool
+ *
+ * Description: labels are extended from the start city in primary order; a label over a budget is not created,
+ *              and one whose secondary weight is not below that of a label already settled at its city is
+ *              dominated and dropped. When the query has no budget on its secondary criterion only the first label
+ *              of each city is kept, which makes the search a plain Dijkstra stopped by the budget. Unless the
+ *              search was truncated, the first label settled at the end city has the smallest primary weight of
+ *              every path within both budgets.
+ ***********************************************************************************************************************/
+static int searchLabels(const struct Graph* graph, struct Workspace* ws, const struct Client* client, int maxFrontier, bool exact, bool* truncated) {
+    struct Restrictions restrictions = client->restrictions;
+    bool costFilter = strcmp(client->filter, "cost") == 0;
+    bool filtered = restrictions.A1 || restrictions.A2 || restrictions.A3;
+    int costBudget = restrictions.B2 ? restrictions.totalCost : INF;
+    int arrivalBudget = restrictions.B1 && restrictions.totalDuration < INF - client->departureTime ? client->departureTime + restrictions.totalDuration : INF;
+    bool frontier = costFilter ? restrictions.B1 : restrictions.B2;
+    int startCity = client->startCity - 1;
+    int endCity = client->endCity - 1;
+    int* best = ws->weight;
+    int* settled = ws->potential;
+
+    resetWorkspace(ws);
+    struct LabelPool* pool = labelPool(ws);
+    int found = -1;
+
+    if (client->departureTime <= arrivalBudget && 0 <= costBudget) {
+        struct Label* label = &pool->labels[pool->size++];
+        label->city = startCity;
+        label->primary = costFilter ? 0 : client->departureTime;
+        label->secondary = costFilter ? client->departureTime : 0;
+        label->parent = -1;
+        label->edge = -1;
+        reachCity(ws, startCity);
+        insertMinHeap(pool->heap, 0, label->primary, pool->heapIndex);
+    }
+
+    while (!isEmpty(pool->heap)) {
+        int index = extractMin(pool->heap, pool->heapIndex).city;
+        const struct Label* label = &pool->labels[index];
+        int u = label->city;
+        int key = frontier ? label->secondary : 0;
+        if (key >= best[u]) continue;
+        if (settled[u] >= maxFrontier) {
+            *truncated = true;
+            continue;
+        }
+        best[u] = key;
+        settled[u]++;
+        STAT(ws->counters.settled++);
+
+        if (u == endCity) {
+            found = index;
+            break;
+        }
+
+        int cost = costFilter ? label->primary : label->secondary;
+        int arrival = costFilter ? label->secondary : label->primary;
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            const struct Edge* edge = &graph->edges[e];
+            STAT(ws->counters.scanned++);
+            if (filtered && !check_restrictions(restrictions, edge)) {
+                STAT(ws->counters.filtered++);
+                continue;
+            }
+
+            int nextCost = cost + edge->travelCost;
+            int nextArrival = arrival + waiting_time(arrival, edge) + edge->travelDuration;
+            if (nextCost > costBudget || nextArrival > arrivalBudget) continue;
+
+            int v = edge->destination;
+            reachCity(ws, v);
+            int secondary = costFilter ? nextArrival : nextCost;
+            if ((frontier ? secondary : 0) >= best[v]) continue;
+            if (settled[v] >= maxFrontier) {
+                *truncated = true;
+                continue;
+            }
+            if (pool->size == pool->capacity) {
+                if (!exact) {
+                    *truncated = true;
+                    clearMinHeap(pool->heap);
+                    break;
+                }
+                growLabelPool(pool);
+            }
+
+            struct Label* next = &pool->labels[pool->size];
+            next->city = v;
+            next->primary = costFilter ? nextCost : nextArrival;
+            next->secondary = secondary;
+            next->parent = index;
+            next->edge = e;
+            insertMinHeap(pool->heap, pool->size, next->primary, pool->heapIndex);
+            pool->size++;
+        }
+    }
+    return found;
+}
+
+/***********************************************************************************************************************
+ * rcsp_query()
+ *
+ * Arguments: graph - map graph in CSR layout
+ *            ws - query workspace
+ *            client - query with valid start and end cities
+ *            output - buffer receiving the .sol line
+ * Returns: void
+ * Side-Effects: appends the result to the output buffer, overwrites the search state kept in the workspace, may grow
+ *               the label pool
+ *
+ * Description: B2 bounds the cost and B1 the duration written on the .sol line, whatever the filter. The search
+ *              runs first with RCSP_MAX_FRONTIER labels per city and the pool as allocated; if either limit dropped
+ *              a label, it is run again with neither, so the limits only cost time and never change the answer.
+ *              The query is answered with -1 when no label within both budgets reaches the end city.
+ ***********************************************************************************************************************/
+void rcsp_query(const struct Graph* graph, struct Workspace* ws, const struct Client* client, struct SolBuffer* output) {
+    bool truncated = false;
+    int found = searchLabels(graph, ws, client, RCSP_MAX_FRONTIER, false, &truncated);
+    if (truncated) {
+        STAT(ws->counters.reruns++);
+        found = searchLabels(graph, ws, client, INT_MAX, true, &truncated);
+    }
+    struct LabelPool* pool = ws->labels;
+    struct Label* labels = pool->labels;
+
+    // The queue of the pool is counted with the workspace's queue
+    ws->heap->inserts += pool->heap->inserts;
+    ws->heap->extracts += pool->heap->extracts;
+    pool->heap->inserts = pool->heap->extracts = 0;
+
+    if (found < 0) {
+        solPutInt(output, client->clientID, ' ');
+        solPutInt(output, -1, '\n');
+        return;
+    }
+
+    int numHops = 0;
+    for (int l = found; labels[l].parent >= 0; l = labels[l].parent) {
+        numHops++;
+    }
+    int hop = numHops;
+    for (int l = found; labels[l].parent >= 0; l = labels[l].parent) {
+        hop--;
+        ws->trip[hop] = labels[l].city;
+        ws->tripEdge[hop] = labels[l].edge;
+    }
+    write_path(graph, ws, numHops, labels[found].primary, client, output);
+}
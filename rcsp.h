@@ -0,0 +1,59 @@
+/******************************************************************************
+ * NAME
+ *   rcsp.h
+ *
+ * DESCRIPTION
+ *   Header file for the resource constrained shortest path (RCSP) engine
+ *   used by queries with a B1 or B2 budget.
+ *
+ * COMMENTS
+ *   A label is one way of reaching a city: its primary weight (cost, or
+ *   arrival time for duration queries), its secondary weight (arrival time,
+ *   or cost) and the label it was extended from. Labels are settled in
+ *   primary order, and a city keeps the labels it settled as a Pareto
+ *   frontier: a new label is only worth extending if its secondary weight is
+ *   below that of every label settled there before. Labels over a budget are
+ *   never created. Labels live in a pool attached to the workspace. A first
+ *   search keeps at most RCSP_MAX_FRONTIER labels per city and stops when the
+ *   pool is full; if that dropped a label, the query is searched again with
+ *   no frontier limit and a pool that grows, so the limits never change an
+ *   answer.
+ *
+ ******************************************************************************/
+
+#ifndef RCSP_H
+#define RCSP_H
+
+#include "dijkstra.h"
+
+// Labels a city may settle in the first search; dropping a later one makes the query search again without limit
+#define RCSP_MAX_FRONTIER 16
+// Initial size of the label pool: this many labels per city, at least RCSP_MIN_POOL
+#define RCSP_POOL_PER_CITY 4
+#define RCSP_MIN_POOL (1 << 16)
+
+// Partial path ending at a city
+struct Label {
+    int city;                   // 0-based
+    int primary;
+    int secondary;
+    int parent;                 // label it was extended from, -1 at the start city
+    int edge;                   // index in graph->edges of the last hop
+};
+
+// Labels of the current query and the queue ordering them by primary weight
+struct LabelPool {
+    int capacity;
+    int size;
+    struct Label* labels;
+    int* heapIndex;
+    struct minHeap* heap;
+};
+
+// Frees a label pool (NULL is ignored)
+void freeLabelPool(struct LabelPool* pool);
+
+// Answers one valid query, keeping both of its budgets during the search
+void rcsp_query(const struct Graph* graph, struct Workspace* ws, const struct Client* client, struct SolBuffer* output);
+
+#endif
@@ -0,0 +1,306 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: scanner.c
+* Description: Hand-written tokenizer over memory-mapped input files, with a buffered fallback for pipes.
+*/
+
+#include "scanner.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/***********************************************************************************************************************
+ * openScanner()
+ *
+ * Arguments: scanner - scanner to initialize
+ *            file - open input file, nothing must have been read from it yet
+ *            name - label used in error messages
+ * Returns: 1 on success, 0 if the file cannot be read
+ * Side-Effects: maps the file into memory or allocates the read buffer
+ *
+ * Description: maps regular files read-only; anything else (pipes, terminals) is read in SCANNER_BUFFER_SIZE chunks.
+ ***********************************************************************************************************************/
+int openScanner(struct Scanner* scanner, FILE* file, const char* name) {
+    struct stat info;
+
+    scanner->data = NULL;
+    scanner->length = 0;
+    scanner->pos = 0;
+    scanner->line = 1;
+    scanner->mapped = 0;
+    scanner->buffer = NULL;
+    scanner->name = name;
+    scanner->fd = fileno(file);
+    if (scanner->fd < 0) return 0;
+
+    if (fstat(scanner->fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, scanner->fd, 0);
+        if (data != MAP_FAILED) {
+            posix_madvise(data, (size_t)info.st_size, POSIX_MADV_SEQUENTIAL);
+            scanner->data = data;
+            scanner->length = (size_t)info.st_size;
+            scanner->mapped = 1;
+            return 1;
+        }
+    }
+
+    scanner->buffer = malloc(SCANNER_BUFFER_SIZE);
+    if (scanner->buffer == NULL) return 0;
+    scanner->data = scanner->buffer;
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * openStringScanner()
+ *
+ * Arguments: scanner - scanner to initialize
+ *            data - text to scan, kept by the caller until the scanner is closed
+ *            length - number of bytes
+ *            name - label used in error messages
+ * Returns: void
+ * Side-Effects: none
+ *
+ * Description: the text is the whole input: refill() finds nothing more.
+ ***********************************************************************************************************************/
+void openStringScanner(struct Scanner* scanner, const char* data, size_t length, const char* name) {
+    scanner->data = data;
+    scanner->length = length;
+    scanner->pos = 0;
+    scanner->line = 1;
+    scanner->mapped = 0;
+    scanner->fd = -1;
+    scanner->buffer = NULL;
+    scanner->name = name;
+}
+
+/***********************************************************************************************************************
+ * refill()
+ *
+ * Arguments: scanner - pointer to the scanner
+ * Returns: 1 if more data is available, 0 at end of input
+ * Side-Effects: reads the next chunk of a stream into the buffer
+ *
+ * Description: called when every byte of the current data has been consumed. Mapped files have no more data.
+ ***********************************************************************************************************************/
+static int refill(struct Scanner* scanner) {
+    if (scanner->mapped || scanner->buffer == NULL) return 0;
+    ssize_t n;
+    do {
+        n = read(scanner->fd, scanner->buffer, SCANNER_BUFFER_SIZE);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) return 0;
+    scanner->length = (size_t)n;
+    scanner->pos = 0;
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * peekChar()
+ *
+ * Arguments: scanner - pointer to the scanner
+ * Returns: next character, or -1 at end of input
+ * Side-Effects: may refill the buffer
+ *
+ * Description: looks at the next character without consuming it.
+ ***********************************************************************************************************************/
+static inline int peekChar(struct Scanner* scanner) {
+    if (scanner->pos == scanner->length && !refill(scanner)) return -1;
+    return (unsigned char)scanner->data[scanner->pos];
+}
+
+/***********************************************************************************************************************
+ * skipSpaces()
+ *
+ * Arguments: scanner - pointer to the scanner
+ * Returns: first character of the next token, or -1 at end of input
+ * Side-Effects: consumes whitespace and counts newlines
+ *
+ * Description: moves to the start of the next token.
+ ***********************************************************************************************************************/
+static int skipSpaces(struct Scanner* scanner) {
+    int c;
+    while ((c = peekChar(scanner)) == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f') {
+        if (c == '\n') scanner->line++;
+        scanner->pos++;
+    }
+    return c;
+}
+
+/***********************************************************************************************************************
+ * isSpace()
+ *
+ * Arguments: c - character returned by peekChar()
+ * Returns: 1 if c ends a token (whitespace or end of input)
+ * Side-Effects: none
+ *
+ * Description: token separator test.
+ ***********************************************************************************************************************/
+static inline int isSpace(int c) {
+    return c == -1 || c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+/***********************************************************************************************************************
+ * scanEnd()
+ *
+ * Arguments: scanner - pointer to the scanner
+ * Returns: 1 if nothing but whitespace is left, 0 otherwise
+ * Side-Effects: consumes the whitespace
+ *
+ * Description: used to reject lines with extra tokens.
+ ***********************************************************************************************************************/
+int scanEnd(struct Scanner* scanner) {
+    return skipSpaces(scanner) == -1;
+}
+
+/***********************************************************************************************************************
+ * scanError()
+ *
+ * Arguments: scanner - pointer to the scanner
+ *            message - description of the problem
+ *            what - name of the field being read
+ * Returns: void
+ * Side-Effects: writes to stderr
+ *
+ * Description: reports a malformed field with the line where it was found.
+ ***********************************************************************************************************************/
+void scanError(struct Scanner* scanner, const char* message, const char* what) {
+    fprintf(stderr, "%s:%d: %s (%s)\n", scanner->name, scanner->line, message, what);
+}
+
+/***********************************************************************************************************************
+ * scanInt()
+ *
+ * Arguments: scanner - pointer to the scanner
+ *            value - set to the integer read
+ *            what - name of the field, used in error messages
+ * Returns: 1 on success, 0 at end of input, -1 if the token is not an integer that fits in an int
+ * Side-Effects: consumes the token
+ *
+ * Description: reads an optionally signed decimal integer followed by whitespace or end of input.
+ ***********************************************************************************************************************/
+int scanInt(struct Scanner* scanner, int* value, const char* what) {
+    int c = skipSpaces(scanner);
+    if (c == -1) return 0;
+
+    int negative = 0;
+    if (c == '-' || c == '+') {
+        negative = c == '-';
+        scanner->pos++;
+        c = peekChar(scanner);
+    }
+    if (c < '0' || c > '9') {
+        scanError(scanner, "expected an integer", what);
+        return -1;
+    }
+
+    long long n = 0;
+    while (c >= '0' && c <= '9') {
+        n = n * 10 + (c - '0');
+        if (n > (long long)INT_MAX + 1) {
+            scanError(scanner, "integer out of range", what);
+            return -1;
+        }
+        scanner->pos++;
+        c = peekChar(scanner);
+    }
+    if (!isSpace(c)) {
+        scanError(scanner, "expected an integer", what);
+        return -1;
+    }
+    if (negative) n = -n;
+    if (n > INT_MAX) {
+        scanError(scanner, "integer out of range", what);
+        return -1;
+    }
+    *value = (int)n;
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * scanWord()
+ *
+ * Arguments: scanner - pointer to the scanner
+ *            word - buffer receiving the null-terminated word
+ *            size - size of the buffer
+ *            what - name of the field, used in error messages
+ * Returns: 1 on success, 0 at end of input, -1 if the word does not fit in the buffer
+ * Side-Effects: consumes the token
+ *
+ * Description: reads a whitespace-delimited word.
+ ***********************************************************************************************************************/
+int scanWord(struct Scanner* scanner, char* word, size_t size, const char* what) {
+    int c = skipSpaces(scanner);
+    if (c == -1) return 0;
+
+    size_t n = 0;
+    while (!isSpace(c)) {
+        if (n + 1 >= size) {
+            scanError(scanner, "word too long", what);
+            return -1;
+        }
+        word[n++] = (char)c;
+        scanner->pos++;
+        c = peekChar(scanner);
+    }
+    word[n] = '\0';
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * expectInt()
+ *
+ * Arguments: scanner - pointer to the scanner
+ *            value - set to the integer read
+ *            what - name of the field, used in error messages
+ * Returns: 1 on success, 0 (after reporting) if the field is missing or malformed
+ * Side-Effects: consumes the token
+ *
+ * Description: reads a mandatory integer field; end of input is reported as an error.
+ ***********************************************************************************************************************/
+int expectInt(struct Scanner* scanner, int* value, const char* what) {
+    int result = scanInt(scanner, value, what);
+    if (result == 0) scanError(scanner, "unexpected end of file", what);
+    return result == 1;
+}
+
+/***********************************************************************************************************************
+ * expectWord()
+ *
+ * Arguments: scanner - pointer to the scanner
+ *            word - buffer receiving the word
+ *            size - size of the buffer
+ *            what - name of the field, used in error messages
+ * Returns: 1 on success, 0 (after reporting) if the field is missing or too long
+ * Side-Effects: consumes the token
+ *
+ * Description: reads a mandatory word field; end of input is reported as an error.
+ ***********************************************************************************************************************/
+int expectWord(struct Scanner* scanner, char* word, size_t size, const char* what) {
+    int result = scanWord(scanner, word, size, what);
+    if (result == 0) scanError(scanner, "unexpected end of file", what);
+    return result == 1;
+}
+
+/***********************************************************************************************************************
+ * closeScanner()
+ *
+ * Arguments: scanner - pointer to the scanner
+ * Returns: void
+ * Side-Effects: unmaps the file or frees the buffer
+ *
+ * Description: releases the scanner resources. The underlying FILE is closed by its owner.
+ ***********************************************************************************************************************/
+void closeScanner(struct Scanner* scanner) {
+    if (scanner->mapped) {
+        munmap((void*)scanner->data, scanner->length);
+    }
+    free(scanner->buffer);
+    scanner->data = NULL;
+    scanner->buffer = NULL;
+    scanner->mapped = 0;
+}
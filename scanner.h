@@ -0,0 +1,63 @@
+/******************************************************************************
+ * NAME
+ *   scanner.h
+ *
+ * DESCRIPTION
+ *   Header file for the tokenizer used to read .map and .cli files.
+ *
+ * COMMENTS
+ *   Regular files are memory-mapped and scanned in place. Pipes and other
+ *   streams that cannot be mapped are read through a fixed-size buffer, and
+ *   lines already in memory (the server's) are scanned where they are.
+ *   Errors are reported on stderr with the line number of the bad token.
+ *
+ ******************************************************************************/
+
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define SCANNER_BUFFER_SIZE (1 << 16)
+
+// Tokenizer state
+struct Scanner {
+    const char* data;           // mapped file or current buffer contents
+    size_t length;
+    size_t pos;
+    int line;                   // line of the next character
+    int mapped;                 // 1 if data is an mmap of the whole file
+    int fd;
+    char* buffer;               // buffered fallback for streams
+    const char* name;           // label used in error messages
+};
+
+// Prepares to scan an open file; name is used in error messages
+int openScanner(struct Scanner* scanner, FILE* file, const char* name);
+
+// Prepares to scan length bytes of memory in place; name is used in error messages
+void openStringScanner(struct Scanner* scanner, const char* data, size_t length, const char* name);
+
+// Returns 1 if only whitespace is left
+int scanEnd(struct Scanner* scanner);
+
+// Reads an integer; returns 1 on success, 0 at end of input, -1 (after reporting) on malformed input
+int scanInt(struct Scanner* scanner, int* value, const char* what);
+
+// Reads a word of at most size-1 characters; same return values as scanInt
+int scanWord(struct Scanner* scanner, char* word, size_t size, const char* what);
+
+// Reads a mandatory integer; returns 1 on success, 0 (after reporting) if it is missing or malformed
+int expectInt(struct Scanner* scanner, int* value, const char* what);
+
+// Reads a mandatory word; returns 1 on success, 0 (after reporting) if it is missing or too long
+int expectWord(struct Scanner* scanner, char* word, size_t size, const char* what);
+
+// Reports a malformed field at the current line
+void scanError(struct Scanner* scanner, const char* message, const char* what);
+
+// Releases the mapping or the buffer
+void closeScanner(struct Scanner* scanner);
+
+#endif
@@ -0,0 +1,276 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: schedule.c
+* Description: Edge schedules as a structure of arrays and the SSE2 / AVX2 kernels computing the arrival times through
+*              the edges of a city, bit for bit equal to waiting_time().
+*/
+
+#include "schedule.h"
+#include <stdlib.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define SCHEDULE_X86 1
+#include <immintrin.h>
+#else
+#define SCHEDULE_X86 0
+#endif
+
+/***********************************************************************************************************************
+ * scheduleStride()
+ *
+ * Arguments: numEdges - number of edges of the map
+ * Returns: size in bytes of one array of the schedule block
+ * Side-Effects: none
+ *
+ * Description: rounded up to a multiple of 8, so the block can be a snapshot section as it is.
+ ***********************************************************************************************************************/
+size_t scheduleStride(int numEdges) {
+    return ((size_t)numEdges * sizeof(int) + 7) & ~(size_t)7;
+}
+
+/***********************************************************************************************************************
+ * arrivalKernel()
+ *
+ * Arguments: none
+ * Returns: ARRIVALS_AVX2 if the processor has AVX2, else ARRIVALS_SSE2 on x86, else ARRIVALS_SCALAR
+ * Side-Effects: none
+ *
+ * Description: the AVX2 kernel is compiled for that instruction set on its own, so the program still runs on
+ *              processors without it.
+ ***********************************************************************************************************************/
+int arrivalKernel(void) {
+#if SCHEDULE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return ARRIVALS_AVX2;
+    return ARRIVALS_SSE2;
+#else
+    return ARRIVALS_SCALAR;
+#endif
+}
+
+/***********************************************************************************************************************
+ * attachSchedules()
+ *
+ * Arguments: graph - graph whose schedules are set
+ *            block - five arrays of scheduleStride() bytes: first, last, period, duration and reciprocal
+ *            maxDegree - most edges leaving one city
+ *            regular - 1 if every schedule is within SCHEDULE_LIMIT
+ * Returns: void
+ * Side-Effects: none (the block is owned by the caller or by the graph's mapping)
+ *
+ * Description: shared by buildSchedules() and mapSnapshot().
+ ***********************************************************************************************************************/
+void attachSchedules(struct Graph* graph, void* block, int maxDegree, int regular) {
+    size_t stride = scheduleStride(graph->numEdges);
+    char* base = block;
+    graph->schedules.first = (int*)base;
+    graph->schedules.last = (int*)(base + stride);
+    graph->schedules.period = (int*)(base + 2 * stride);
+    graph->schedules.duration = (int*)(base + 3 * stride);
+    graph->schedules.reciprocal = (float*)(base + 4 * stride);
+    graph->schedules.maxDegree = maxDegree;
+    graph->schedules.regular = regular;
+    graph->schedules.kernel = arrivalKernel();
+}
+
+/***********************************************************************************************************************
+ * setSchedule()
+ *
+ * Arguments: schedules - edge schedules
+ *            e - entry to set
+ *            edge - edge whose timetable is copied
+ * Returns: 1 if the schedule is within SCHEDULE_LIMIT, 0 otherwise
+ * Side-Effects: none
+ *
+ * Description: used when the schedules are built and when a connection is retimed (see delta.h).
+ ***********************************************************************************************************************/
+int setSchedule(struct Schedules* schedules, int e, const struct Edge* edge) {
+    schedules->first[e] = edge->firstDeparture;
+    schedules->last[e] = edge->lastDeparture;
+    schedules->period[e] = edge->departurePeriodicity;
+    schedules->duration[e] = edge->travelDuration;
+    schedules->reciprocal[e] = edge->departurePeriodicity != 0 ? 1.0f / (float)edge->departurePeriodicity : 0.0f;
+    return edge->firstDeparture >= -SCHEDULE_LIMIT && edge->firstDeparture <= SCHEDULE_LIMIT &&
+           edge->lastDeparture >= -SCHEDULE_LIMIT && edge->lastDeparture <= SCHEDULE_LIMIT &&
+           edge->departurePeriodicity >= 1 && edge->departurePeriodicity <= SCHEDULE_LIMIT;
+}
+
+/***********************************************************************************************************************
+ * buildSchedules()
+ *
+ * Arguments: graph - loaded graph without schedules
+ * Returns: 1 on success, 0 if memory runs out
+ * Side-Effects: allocates the schedule block (freed by freeGraph())
+ *
+ * Description: copies the timetable of every edge into the arrays and checks whether the vector kernels may use
+ *              them. The block is zeroed first so its padding is always the same in a snapshot.
+ ***********************************************************************************************************************/
+int buildSchedules(struct Graph* graph) {
+    size_t bytes = 5 * scheduleStride(graph->numEdges);
+    void* block = calloc(bytes > 0 ? bytes : 1, 1);
+    if (block == NULL) return 0;
+    attachSchedules(graph, block, 0, 1);
+
+    struct Schedules* schedules = &graph->schedules;
+    for (int e = 0; e < graph->numEdges; e++) {
+        if (!setSchedule(schedules, e, &graph->edges[e])) schedules->regular = 0;
+    }
+    for (int u = 0; u < graph->numCities; u++) {
+        int degree = graph->offsets[u + 1] - graph->offsets[u];
+        if (degree > schedules->maxDegree) schedules->maxDegree = degree;
+    }
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * arrivalOf()
+ *
+ * Arguments: schedules - edge schedules
+ *            e - edge
+ *            time - arrival time at the edge's origin
+ *            h - time % 1440
+ * Returns: time + waiting time + duration of the edge
+ * Side-Effects: none
+ *
+ * Description: waiting_time() on the arrays; used for the edges left over by the vector loops.
+ ***********************************************************************************************************************/
+static int arrivalOf(const struct Schedules* schedules, int e, int time, int h) {
+    int first = schedules->first[e];
+    int last = schedules->last[e];
+    int period = schedules->period[e];
+    int wait;
+
+    if (h <= first) wait = first - h;
+    else if (h > last) wait = (1440 - h) + first;
+    else {
+        int nextDeparture = first + ((h - first + period - 1) / period) * period;
+        wait = nextDeparture > last ? (1440 - h) + first : nextDeparture - h;
+    }
+    return time + wait + schedules->duration[e];
+}
+
+#if SCHEDULE_X86
+
+/***********************************************************************************************************************
+ * arrivalsSSE2()
+ *
+ * Arguments: as in edgeArrivals()
+ * Returns: void
+ * Side-Effects: writes the arrivals
+ *
+ * Description: 4 edges per step. With a = h - first, the next departure is first + ceil(a / period) * period and
+ *              ceil(a / period) = floor((a - 1) / period) + 1. The quotient is estimated with the reciprocal (off by
+ *              at most one, the operands being below 2^22) and corrected by comparing q * period with a - 1. The
+ *              three cases of waiting_time() are then selected with masks, the first one taking precedence.
+ ***********************************************************************************************************************/
+static void arrivalsSSE2(const struct Schedules* schedules, int begin, int end, int time, int* arrival) {
+    int h = time % 1440;
+    __m128 hour = _mm_set1_ps((float)h);
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 day = _mm_set1_ps(1440.0f);
+    __m128i now = _mm_set1_epi32(time);
+
+    int e = begin;
+    for (; e + 4 <= end; e += 4) {
+        __m128 first = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(schedules->first + e)));
+        __m128 last = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(schedules->last + e)));
+        __m128 period = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(schedules->period + e)));
+        __m128 reciprocal = _mm_loadu_ps(schedules->reciprocal + e);
+
+        __m128 a = _mm_sub_ps(_mm_sub_ps(hour, first), one);
+        __m128 q = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(a, reciprocal)));
+        q = _mm_add_ps(q, _mm_and_ps(_mm_cmple_ps(_mm_mul_ps(_mm_add_ps(q, one), period), a), one));
+        q = _mm_sub_ps(q, _mm_and_ps(_mm_cmpgt_ps(_mm_mul_ps(q, period), a), one));
+        __m128 next = _mm_add_ps(first, _mm_mul_ps(_mm_add_ps(q, one), period));
+
+        __m128 wrap = _mm_add_ps(_mm_sub_ps(day, hour), first);
+        __m128 late = _mm_or_ps(_mm_cmpgt_ps(hour, last), _mm_cmpgt_ps(next, last));
+        __m128 wait = _mm_or_ps(_mm_and_ps(late, wrap), _mm_andnot_ps(late, _mm_sub_ps(next, hour)));
+        __m128 early = _mm_cmple_ps(hour, first);
+        wait = _mm_or_ps(_mm_and_ps(early, _mm_sub_ps(first, hour)), _mm_andnot_ps(early, wait));
+
+        __m128i duration = _mm_loadu_si128((const __m128i*)(schedules->duration + e));
+        __m128i result = _mm_add_epi32(_mm_add_epi32(now, _mm_cvttps_epi32(wait)), duration);
+        _mm_storeu_si128((__m128i*)(arrival + e - begin), result);
+    }
+    for (; e < end; e++) {
+        arrival[e - begin] = arrivalOf(schedules, e, time, h);
+    }
+}
+
+/***********************************************************************************************************************
+ * arrivalsAVX2()
+ *
+ * Arguments: as in edgeArrivals()
+ * Returns: void
+ * Side-Effects: writes the arrivals
+ *
+ * Description: arrivalsSSE2() with 8 edges per step; the last edges are left to it, after clearing the upper halves
+ *              of the AVX registers (mixing them with SSE instructions is slow otherwise).
+ ***********************************************************************************************************************/
+__attribute__((target("avx2")))
+static void arrivalsAVX2(const struct Schedules* schedules, int begin, int end, int time, int* arrival) {
+    int h = time % 1440;
+    __m256 hour = _mm256_set1_ps((float)h);
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 day = _mm256_set1_ps(1440.0f);
+    __m256i now = _mm256_set1_epi32(time);
+
+    int e = begin;
+    for (; e + 8 <= end; e += 8) {
+        __m256 first = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(schedules->first + e)));
+        __m256 last = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(schedules->last + e)));
+        __m256 period = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(schedules->period + e)));
+        __m256 reciprocal = _mm256_loadu_ps(schedules->reciprocal + e);
+
+        __m256 a = _mm256_sub_ps(_mm256_sub_ps(hour, first), one);
+        __m256 q = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(_mm256_mul_ps(a, reciprocal)));
+        q = _mm256_add_ps(q, _mm256_and_ps(_mm256_cmp_ps(_mm256_mul_ps(_mm256_add_ps(q, one), period), a, _CMP_LE_OQ), one));
+        q = _mm256_sub_ps(q, _mm256_and_ps(_mm256_cmp_ps(_mm256_mul_ps(q, period), a, _CMP_GT_OQ), one));
+        __m256 next = _mm256_add_ps(first, _mm256_mul_ps(_mm256_add_ps(q, one), period));
+
+        __m256 wrap = _mm256_add_ps(_mm256_sub_ps(day, hour), first);
+        __m256 late = _mm256_or_ps(_mm256_cmp_ps(hour, last, _CMP_GT_OQ), _mm256_cmp_ps(next, last, _CMP_GT_OQ));
+        __m256 wait = _mm256_blendv_ps(_mm256_sub_ps(next, hour), wrap, late);
+        wait = _mm256_blendv_ps(wait, _mm256_sub_ps(first, hour), _mm256_cmp_ps(hour, first, _CMP_LE_OQ));
+
+        __m256i duration = _mm256_loadu_si256((const __m256i*)(schedules->duration + e));
+        __m256i result = _mm256_add_epi32(_mm256_add_epi32(now, _mm256_cvttps_epi32(wait)), duration);
+        _mm256_storeu_si256((__m256i*)(arrival + e - begin), result);
+    }
+    _mm256_zeroupper();
+    arrivalsSSE2(schedules, e, end, time, arrival + (e - begin));
+}
+
+#endif
+
+/***********************************************************************************************************************
+ * edgeArrivals()
+ *
+ * Arguments: schedules - regular edge schedules
+ *            begin, end - edges to compute (those of one city)
+ *            time - arrival time at their origin, not negative
+ *            arrival - end - begin entries written
+ * Returns: void
+ * Side-Effects: writes the arrivals
+ *
+ * Description: arrival[k] is time + waiting_time(time, edge) + duration for edge begin + k, computed by the kernel
+ *              picked when the schedules were attached.
+ ***********************************************************************************************************************/
+void edgeArrivals(const struct Schedules* schedules, int begin, int end, int time, int* arrival) {
+#if SCHEDULE_X86
+    if (schedules->kernel == ARRIVALS_AVX2) {
+        arrivalsAVX2(schedules, begin, end, time, arrival);
+        return;
+    }
+    if (schedules->kernel == ARRIVALS_SSE2) {
+        arrivalsSSE2(schedules, begin, end, time, arrival);
+        return;
+    }
+#endif
+    int h = time % 1440;
+    for (int e = begin; e < end; e++) {
+        arrival[e - begin] = arrivalOf(schedules, e, time, h);
+    }
+}
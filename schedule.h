@@ -0,0 +1,57 @@
+/******************************************************************************
+ * NAME
+ *   schedule.h
+ *
+ * DESCRIPTION
+ *   Header file for the edge schedules kept as a structure of arrays and the
+ *   vectorized kernel computing the arrival time through every edge leaving
+ *   a city.
+ *
+ * COMMENTS
+ *   waiting_time() reads three fields of a 28-byte edge and divides by the
+ *   period. Here the first and last departures, the periods, the durations
+ *   and the reciprocals of the periods are separate arrays in CSR order, so
+ *   the edges of a city are loaded 4 (SSE2) or 8 (AVX2) at a time. The
+ *   division is replaced by a multiplication by the reciprocal followed by
+ *   an exact correction, and every value stays below 2^24, where float
+ *   arithmetic on integers is exact: the arrivals are the same as with
+ *   waiting_time(). Maps with a schedule outside SCHEDULE_LIMIT use the
+ *   scalar function only.
+ *
+ ******************************************************************************/
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include "graph.h"
+
+// Largest first departure, last departure or period (in absolute value) the vector kernels accept
+#define SCHEDULE_LIMIT (1 << 20)
+// Cities with fewer edges are relaxed with waiting_time(): below this the extra arrays cost more than the divisions
+#define ARRIVALS_MIN_DEGREE 128
+
+// Implementations of edgeArrivals()
+#define ARRIVALS_SCALAR 0
+#define ARRIVALS_SSE2 1
+#define ARRIVALS_AVX2 2
+
+// Bytes of one array of the schedule block (a multiple of 8)
+size_t scheduleStride(int numEdges);
+
+// Allocates and fills the graph's schedules from its edges; returns 0 if memory runs out
+int buildSchedules(struct Graph* graph);
+
+// Copies the timetable of an edge into entry e of the schedules; returns 1 if the vector kernels may use it
+int setSchedule(struct Schedules* schedules, int e, const struct Edge* edge);
+
+// Sets the schedule arrays of a graph from a block laid out by buildSchedules() and picks the kernel
+void attachSchedules(struct Graph* graph, void* block, int maxDegree, int regular);
+
+// Best implementation of edgeArrivals() this machine runs
+int arrivalKernel(void);
+
+// Writes time + waiting time + duration of edges begin .. end - 1 to arrival[0 .. end - begin - 1]; needs regular
+// schedules and time >= 0
+void edgeArrivals(const struct Schedules* schedules, int begin, int end, int time, int* arrival);
+
+#endif
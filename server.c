@@ -0,0 +1,406 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: server.c
+* Description: Resident server: keeps the map loaded and answers the client lines of stdin or of the connections to a
+*              Unix domain socket, one batch per read.
+*/
+
+#include "server.h"
+#include "processFiles.h"
+#include "scanner.h"
+#include "delta.h"
+#include <ctype.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+static volatile sig_atomic_t stopRequested = 0;
+
+// One client of the server: stdin and stdout, or an accepted socket
+struct Connection {
+    int fd;                     // read side
+    FILE* output;               // answers
+    int ownsOutput;             // 1 if output (and fd) are closed with the connection
+    int failed;                 // 1 once writing the answers of a batch failed
+    char* data;                 // bytes received and not answered yet
+    size_t length;
+    size_t capacity;
+    int line;                   // line number of data[0], for error messages
+};
+
+// What every batch needs
+struct Server {
+    struct Graph* graph;        // changed in place by add / remove / retime lines
+    struct Indexes* indexes;
+    struct Caches* caches;
+    const struct RunOptions* options;
+    const char* name;           // label of the input in error messages
+    struct Client* clients;     // clients of the batch being read
+    int capacity;
+};
+
+/***********************************************************************************************************************
+ * requestStop()
+ *
+ * Arguments: signal - signal number
+ * Returns: void
+ * Side-Effects: sets the stop flag
+ *
+ * Description: SIGINT / SIGTERM handler; the poll() it interrupts returns and the server shuts down.
+ ***********************************************************************************************************************/
+static void requestStop(int signal) {
+    (void)signal;
+    stopRequested = 1;
+}
+
+/***********************************************************************************************************************
+ * installSignals()
+ *
+ * Arguments: none
+ * Returns: void
+ * Side-Effects: installs the SIGINT and SIGTERM handlers, ignores SIGPIPE
+ *
+ * Description: a client that disconnects before reading its answers makes a write fail instead of killing the server.
+ ***********************************************************************************************************************/
+static void installSignals(void) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    sigemptyset(&action.sa_mask);
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    action.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &action, NULL);
+}
+
+/***********************************************************************************************************************
+ * openListener()
+ *
+ * Arguments: socketName - path of the Unix domain socket
+ * Returns: listening socket, or -1 (after reporting on stderr)
+ * Side-Effects: creates the socket file, replacing a stale one
+ *
+ * Description: a socket file left by a server that is gone is removed; one another server still accepts on is not.
+ ***********************************************************************************************************************/
+static int openListener(const char* socketName) {
+    struct sockaddr_un address;
+    struct stat info;
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketName) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "%s: socket path too long\n", socketName);
+        return -1;
+    }
+    strcpy(address.sun_path, socketName);
+
+    if (stat(socketName, &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            fprintf(stderr, "%s: exists and is not a socket\n", socketName);
+            return -1;
+        }
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        int live = probe >= 0 && connect(probe, (struct sockaddr*)&address, sizeof(address)) == 0;
+        if (probe >= 0) close(probe);
+        if (live) {
+            fprintf(stderr, "%s: another server is listening\n", socketName);
+            return -1;
+        }
+        unlink(socketName);
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listener, SERVER_MAX_CONNECTIONS) != 0) {
+        fprintf(stderr, "%s: cannot listen: %s\n", socketName, strerror(errno));
+        if (listener >= 0) close(listener);
+        return -1;
+    }
+    return listener;
+}
+
+/***********************************************************************************************************************
+ * openConnection()
+ *
+ * Arguments: fd - descriptor to read from
+ *            output - stream the answers are written to
+ *            ownsOutput - 1 if the connection closes output (and with it fd)
+ * Returns: the connection
+ * Side-Effects: allocates dynamic memory, exits if memory runs out
+ *
+ * Description: the receive buffer starts with room for one read.
+ ***********************************************************************************************************************/
+static struct Connection* openConnection(int fd, FILE* output, int ownsOutput) {
+    struct Connection* connection = malloc(sizeof(struct Connection));
+    if (connection == NULL) exit(0);
+    connection->fd = fd;
+    connection->output = output;
+    connection->failed = 0;
+    connection->ownsOutput = ownsOutput;
+    connection->capacity = SERVER_READ_SIZE;
+    connection->data = malloc(connection->capacity);
+    if (connection->data == NULL) exit(0);
+    connection->length = 0;
+    connection->line = 1;
+    return connection;
+}
+
+/***********************************************************************************************************************
+ * closeConnection()
+ *
+ * Arguments: connection - connection to close
+ * Returns: void
+ * Side-Effects: flushes the answers, closes the socket, frees the connection
+ *
+ * Description: stdout is only flushed.
+ ***********************************************************************************************************************/
+static void closeConnection(struct Connection* connection) {
+    if (connection->ownsOutput) fclose(connection->output);
+    else fflush(connection->output);
+    free(connection->data);
+    free(connection);
+}
+
+/***********************************************************************************************************************
+ * solveClients()
+ *
+ * Arguments: server - server state
+ *            connection - connection the clients came from
+ *            numClients - number of clients read into server->clients
+ * Returns: void
+ * Side-Effects: writes their answers to the connection, marks it failed if that does not work
+ *
+ * Description: one solveBatch() call with the server's workspaces and caches.
+ ***********************************************************************************************************************/
+static void solveClients(struct Server* server, struct Connection* connection, int numClients) {
+    if (numClients == 0) return;
+    if (!solveBatch(server->graph, server->indexes, server->caches, server->clients, numClients, server->options, connection->output, NULL)) {
+        connection->failed = 1;
+    }
+}
+
+/***********************************************************************************************************************
+ * isChange()
+ *
+ * Arguments: data - start of a line
+ *            length - length of the line
+ * Returns: 1 if the line starts with a word (a change of the map), 0 if it starts with a client identifier
+ * Side-Effects: none
+ *
+ * Description: looks at the first character that is not a space.
+ ***********************************************************************************************************************/
+static int isChange(const char* data, size_t length) {
+    size_t i = 0;
+    while (i < length && isspace((unsigned char)data[i])) i++;
+    return i < length && isalpha((unsigned char)data[i]);
+}
+
+/***********************************************************************************************************************
+ * endUpdate()
+ *
+ * Arguments: server - server state
+ *            update - update started by the change lines just read
+ * Returns: void
+ * Side-Effects: places the added connections, repairs the engines' data and the caches
+ *
+ * Description: called before the next client line is solved, so every answer after a change sees it.
+ ***********************************************************************************************************************/
+static void endUpdate(struct Server* server, struct Update* update) {
+    finishUpdate(update);
+    repairIndexes(update, server->indexes, server->caches, server->options);
+    freeUpdate(update);
+}
+
+/***********************************************************************************************************************
+ * answerLines()
+ *
+ * Arguments: server - server state
+ *            connection - connection with received data
+ *            final - 1 if the connection has ended, so a last line without a newline is complete
+ * Returns: void
+ * Side-Effects: answers every complete line, keeps the rest for the next read
+ *
+ * Description: the lines are read into clients and solved together; a line that cannot be read first has the clients
+ *              before it solved, so "error" takes its place in the answers. A change line (see delta.h) also has
+ *              the clients before it solved, and is answered with "ok" or "error"; consecutive changes are applied
+ *              as one update, finished before the next client is read.
+ ***********************************************************************************************************************/
+static void answerLines(struct Server* server, struct Connection* connection, int final) {
+    size_t start = 0;
+    int numClients = 0;
+    int updating = 0;
+    struct Update update;
+
+    while (start < connection->length) {
+        const char* newline = memchr(connection->data + start, '\n', connection->length - start);
+        if (newline == NULL && !final) break;
+        size_t end = newline != NULL ? (size_t)(newline - connection->data) : connection->length;
+
+        struct Scanner scanner;
+        openStringScanner(&scanner, connection->data + start, end - start, server->name);
+        scanner.line = connection->line;
+        if (isChange(connection->data + start, end - start)) {
+            solveClients(server, connection, numClients);
+            numClients = 0;
+            if (!updating) startUpdate(&update, server->graph);
+            updating = 1;
+            int applied = readChange(&scanner, &update);
+            if (applied && !scanEnd(&scanner)) scanError(&scanner, "unexpected text after the change", "end of line");
+            fputs(applied ? "ok\n" : "error\n", connection->output);
+        } else if (!scanEnd(&scanner)) {
+            if (updating) endUpdate(server, &update);
+            updating = 0;
+            if (numClients == server->capacity) {
+                server->capacity *= 2;
+                server->clients = realloc(server->clients, server->capacity * sizeof(struct Client));
+                if (server->clients == NULL) exit(0);
+            }
+            int read = readClient(&scanner, server->graph, &server->clients[numClients]);
+            if (read && scanEnd(&scanner)) {
+                numClients++;
+            } else {
+                if (read) scanError(&scanner, "unexpected text after the client", "end of line");
+                solveClients(server, connection, numClients);
+                numClients = 0;
+                fputs("error\n", connection->output);
+            }
+        }
+        connection->line++;
+        start = newline != NULL ? end + 1 : end;
+    }
+    if (updating) endUpdate(server, &update);
+    solveClients(server, connection, numClients);
+    fflush(connection->output);
+
+    memmove(connection->data, connection->data + start, connection->length - start);
+    connection->length -= start;
+}
+
+/***********************************************************************************************************************
+ * receive()
+ *
+ * Arguments: server - server state
+ *            connection - connection poll() found readable
+ * Returns: 1 if the connection stays open, 0 if it ended or failed
+ * Side-Effects: reads from the connection and answers its complete lines
+ *
+ * Description: a line longer than SERVER_MAX_LINE is answered with "error" and ends the connection.
+ ***********************************************************************************************************************/
+static int receive(struct Server* server, struct Connection* connection) {
+    if (connection->capacity - connection->length < SERVER_READ_SIZE) {
+        connection->capacity = connection->length + SERVER_READ_SIZE;
+        connection->data = realloc(connection->data, connection->capacity);
+        if (connection->data == NULL) exit(0);
+    }
+
+    ssize_t n = read(connection->fd, connection->data + connection->length, SERVER_READ_SIZE);
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) return 1;
+    if (n <= 0) {
+        answerLines(server, connection, 1);
+        return 0;
+    }
+    connection->length += (size_t)n;
+    answerLines(server, connection, 0);
+
+    if (connection->length > SERVER_MAX_LINE) {
+        fprintf(stderr, "%s:%d: line longer than %d bytes\n", server->name, connection->line, SERVER_MAX_LINE);
+        fputs("error\n", connection->output);
+        return 0;
+    }
+    return !connection->failed && !ferror(connection->output);
+}
+
+/***********************************************************************************************************************
+ * serve()
+ *
+ * Arguments: graph - map graph
+ *            indexes - preprocessed data of the optional engines (repaired after changes of the map)
+ *            caches - caches and workspaces kept for every batch (cleared or replaced after changes of the map)
+ *            options - run options
+ *            socketName - Unix domain socket to listen on, or NULL to answer stdin on stdout
+ * Returns: 1 when stopped, 0 if the socket cannot be opened
+ * Side-Effects: reads lines, writes answers, creates and removes the socket file
+ *
+ * Description: one thread polls stdin or the listening socket and its connections; the connections are served in
+ *              turn, each read being answered before the next poll(). With stdin the server stops at its end, with a
+ *              socket on SIGINT or SIGTERM.
+ ***********************************************************************************************************************/
+int serve(struct Graph* graph, struct Indexes* indexes, struct Caches* caches, const struct RunOptions* options, const char* socketName) {
+    struct Server server;
+    struct Connection* connections[SERVER_MAX_CONNECTIONS];
+    struct pollfd polled[SERVER_MAX_CONNECTIONS + 1];
+    int numConnections = 0;
+    int listener = -1;
+
+    server.graph = graph;
+    server.indexes = indexes;
+    server.caches = caches;
+    server.options = options;
+    server.name = socketName != NULL ? socketName : "stdin";
+    server.capacity = 64;
+    server.clients = malloc(server.capacity * sizeof(struct Client));
+    if (server.clients == NULL) exit(0);
+
+    installSignals();
+    if (socketName != NULL) {
+        listener = openListener(socketName);
+        if (listener < 0) {
+            free(server.clients);
+            return 0;
+        }
+    } else {
+        connections[numConnections++] = openConnection(STDIN_FILENO, stdout, 0);
+    }
+
+    while (!stopRequested && (listener >= 0 || numConnections > 0)) {
+        int first = 0;
+        if (listener >= 0) {
+            polled[0].fd = listener;
+            polled[0].events = POLLIN;
+            first = 1;
+        }
+        for (int c = 0; c < numConnections; c++) {
+            polled[first + c].fd = connections[c]->fd;
+            polled[first + c].events = POLLIN;
+        }
+        if (poll(polled, first + numConnections, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int c = numConnections - 1; c >= 0; c--) {
+            if (!(polled[first + c].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            if (!receive(&server, connections[c])) {
+                closeConnection(connections[c]);
+                connections[c] = connections[--numConnections];
+            }
+        }
+
+        if (listener >= 0 && (polled[0].revents & POLLIN)) {
+            int fd = accept(listener, NULL, NULL);
+            FILE* output = fd >= 0 ? fdopen(fd, "w") : NULL;
+            if (output == NULL || numConnections == SERVER_MAX_CONNECTIONS) {
+                if (output != NULL) fclose(output);
+                else if (fd >= 0) close(fd);
+            } else {
+                connections[numConnections++] = openConnection(fd, output, 1);
+            }
+        }
+    }
+
+    while (numConnections > 0) {
+        closeConnection(connections[--numConnections]);
+    }
+    if (listener >= 0) {
+        close(listener);
+        unlink(socketName);
+    }
+    free(server.clients);
+    return 1;
+}
@@ -0,0 +1,40 @@
+/******************************************************************************
+ * NAME
+ *   server.h
+ *
+ * DESCRIPTION
+ *   Header file for the resident server ("serve"): answers client lines
+ *   streamed over stdin or a Unix domain socket with the map kept loaded.
+ *
+ * COMMENTS
+ *   Every line a connection sends is one client in the .cli syntax (without
+ *   the count line of a file) and gets exactly one line back, in the order
+ *   the lines were sent: its .sol line, or "error" if it cannot be read (the
+ *   details go to stderr). Blank lines are ignored. Lines may be pipelined:
+ *   the complete lines received from a connection are solved as one batch,
+ *   on the worker threads of -j, and their answers are written as soon as
+ *   the batch is solved. The workspaces and the caches live as long as the
+ *   server, so a question asked again is answered from --cache.
+ *   A line starting with add, remove or retime changes the loaded map (see
+ *   delta.h) and is answered with "ok" or "error"; the lines after it, on
+ *   every connection, are answered on the changed map.
+ *
+ ******************************************************************************/
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "batch.h"
+
+// Connections served at once; later ones are closed until one ends
+#define SERVER_MAX_CONNECTIONS 64
+// Bytes read from a connection at a time
+#define SERVER_READ_SIZE (1 << 16)
+// Longest line accepted; a connection sending a longer one gets "error" and is closed
+#define SERVER_MAX_LINE 4096
+
+// Answers the lines of stdin (socketName NULL) or of the connections to socketName until the input ends or SIGINT /
+// SIGTERM; returns 0 if the socket cannot be opened
+int serve(struct Graph* graph, struct Indexes* indexes, struct Caches* caches, const struct RunOptions* options, const char* socketName);
+
+#endif
@@ -0,0 +1,217 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: snapshot.c
+* Description: Writes the loaded graph as a versioned, checksummed binary snapshot and maps it back without parsing.
+*/
+
+#include "snapshot.h"
+#include "schedule.h"
+#include <string.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define BYTE_ORDER_MARK 0x01020304u
+
+/***********************************************************************************************************************
+ * align8()
+ *
+ * Arguments: position - byte position
+ * Returns: position rounded up to a multiple of 8
+ * Side-Effects: none
+ *
+ * Description: keeps every section of the snapshot aligned for direct use after mmap.
+ ***********************************************************************************************************************/
+static uint64_t align8(uint64_t position) {
+    return (position + 7) & ~(uint64_t)7;
+}
+
+/***********************************************************************************************************************
+ * buildHeader()
+ *
+ * Arguments: graph - graph to describe
+ *            header - header to fill (checksums excluded)
+ * Returns: void
+ * Side-Effects: none
+ *
+ * Description: computes the layout of the snapshot sections.
+ ***********************************************************************************************************************/
+static void buildHeader(const struct Graph* graph, struct SnapshotHeader* header) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, SNAPSHOT_MAGIC, 8);
+    header->version = SNAPSHOT_VERSION;
+    header->byteOrder = BYTE_ORDER_MARK;
+    header->numCities = graph->numCities;
+    header->numEdges = graph->numEdges;
+    header->numTransports = graph->numTransports;
+    header->edgeSize = sizeof(struct Edge);
+    header->offsetsPos = align8(sizeof(struct SnapshotHeader));
+    header->edgesPos = align8(header->offsetsPos + (uint64_t)(graph->numCities + 1) * sizeof(int));
+    header->schedulesPos = align8(header->edgesPos + (uint64_t)graph->numEdges * sizeof(struct Edge));
+    header->transportsPos = header->schedulesPos + 5 * (uint64_t)scheduleStride(graph->numEdges);
+    header->fileSize = header->transportsPos + (uint64_t)graph->numTransports * TRANSPORT_NAME_LEN;
+}
+
+/***********************************************************************************************************************
+ * writeSection()
+ *
+ * Arguments: output - snapshot file
+ *            position - current write position, advanced by the call
+ *            target - byte position where the section starts
+ *            data - section contents
+ *            length - section size
+ *            hash - payload checksum, updated with the padding and the section
+ * Returns: 1 on success, 0 on a write error
+ * Side-Effects: writes zero padding and the section to the file
+ *
+ * Description: writes one aligned section of the snapshot.
+ ***********************************************************************************************************************/
+static int writeSection(FILE* output, uint64_t* position, uint64_t target, const void* data, size_t length, uint64_t* hash) {
+    static const char zeros[8] = {0};
+    size_t padding = (size_t)(target - *position);
+    if (padding > 0) {
+        if (fwrite(zeros, 1, padding, output) != padding) return 0;
+        *hash = fnv1a(*hash, zeros, padding);
+    }
+    if (length > 0 && fwrite(data, 1, length, output) != length) return 0;
+    *hash = fnv1a(*hash, data, length);
+    *position = target + length;
+    return 1;
+}
+
+/***********************************************************************************************************************
+ * writeSnapshot()
+ *
+ * Arguments: graph - loaded graph
+ *            output - file opened for binary writing
+ * Returns: 1 on success, 0 on a write error
+ * Side-Effects: writes the snapshot file
+ *
+ * Description: writes the header and the offsets, edges, schedules and transport sections. The payload checksum is computed
+ *              while writing, so the header is written last.
+ ***********************************************************************************************************************/
+int writeSnapshot(const struct Graph* graph, FILE* output) {
+    struct SnapshotHeader header;
+    uint64_t hash = FNV_OFFSET;
+    uint64_t position = sizeof(header);
+
+    buildHeader(graph, &header);
+    header.maxDegree = graph->schedules.maxDegree;
+    header.regularSchedules = (uint32_t)graph->schedules.regular;
+
+    if (fseek(output, (long)sizeof(header), SEEK_SET) != 0) return 0;
+    if (!writeSection(output, &position, header.offsetsPos, graph->offsets, (size_t)(graph->numCities + 1) * sizeof(int), &hash)) return 0;
+    if (!writeSection(output, &position, header.edgesPos, graph->edges, (size_t)graph->numEdges * sizeof(struct Edge), &hash)) return 0;
+    if (!writeSection(output, &position, header.schedulesPos, graph->schedules.first, 5 * scheduleStride(graph->numEdges), &hash)) return 0;
+    if (!writeSection(output, &position, header.transportsPos, graph->transports, (size_t)graph->numTransports * TRANSPORT_NAME_LEN, &hash)) return 0;
+
+    header.payloadChecksum = hash;
+    header.headerChecksum = fnv1a(FNV_OFFSET, &header, sizeof(header));
+
+    if (fseek(output, 0, SEEK_SET) != 0) return 0;
+    if (fwrite(&header, sizeof(header), 1, output) != 1) return 0;
+    return fflush(output) == 0;
+}
+
+/***********************************************************************************************************************
+ * isSnapshot()
+ *
+ * Arguments: file - open input file, nothing read from it yet
+ * Returns: 1 if the file starts with the snapshot magic, 0 otherwise
+ * Side-Effects: none (uses pread, so the stream position is untouched)
+ *
+ * Description: tells a .graph snapshot apart from a text .map file.
+ ***********************************************************************************************************************/
+int isSnapshot(FILE* file) {
+    char magic[8];
+    return pread(fileno(file), magic, sizeof(magic), 0) == (ssize_t)sizeof(magic) && memcmp(magic, SNAPSHOT_MAGIC, 8) == 0;
+}
+
+/***********************************************************************************************************************
+ * mapSnapshot()
+ *
+ * Arguments: file - open snapshot file
+ *            verify - if not 0, the payload checksum is also checked (reads the whole file)
+ *            name - file name used in error messages
+ * Returns: graph whose arrays point into the read-only mapping, or NULL if the snapshot is invalid
+ * Side-Effects: maps the file, allocates the graph structure and its transport dictionary, writes errors to stderr,
+ *               exits if memory runs out
+ *
+ * Description: validates the header (magic, version, byte order, edge layout, sizes and header checksum) and points
+ *              the graph at the mapped sections. The transport names are interned again, in order, so they keep their
+ *              ids. Without verify the cost does not depend on the size of the map.
+ ***********************************************************************************************************************/
+struct Graph* mapSnapshot(FILE* file, int verify, const char* name) {
+    struct stat info;
+    int fd = fileno(file);
+
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(struct SnapshotHeader)) {
+        fprintf(stderr, "%s: truncated graph snapshot\n", name);
+        return NULL;
+    }
+
+    void* mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "%s: cannot map graph snapshot\n", name);
+        return NULL;
+    }
+
+    struct SnapshotHeader header, expected;
+    memcpy(&header, mapping, sizeof(header));
+    uint64_t headerChecksum = header.headerChecksum;
+    header.headerChecksum = 0;
+
+    const char* problem = NULL;
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, 8) != 0) problem = "not a graph snapshot";
+    else if (header.version != SNAPSHOT_VERSION) problem = "unsupported snapshot version, recompile the map";
+    else if (header.byteOrder != BYTE_ORDER_MARK || header.edgeSize != sizeof(struct Edge)) problem = "snapshot written on an incompatible machine";
+    else if (fnv1a(FNV_OFFSET, &header, sizeof(header)) != headerChecksum) problem = "corrupted snapshot header";
+    else if (header.numCities < 0 || header.numEdges < 0 || header.numTransports < 0) problem = "corrupted snapshot header";
+    else {
+        struct Graph sizes;
+        sizes.numCities = header.numCities;
+        sizes.numEdges = header.numEdges;
+        sizes.numTransports = header.numTransports;
+        buildHeader(&sizes, &expected);
+        if (expected.offsetsPos != header.offsetsPos || expected.edgesPos != header.edgesPos || expected.schedulesPos != header.schedulesPos ||
+            expected.transportsPos != header.transportsPos || expected.fileSize != header.fileSize ||
+            header.fileSize != (uint64_t)info.st_size) {
+            problem = "truncated graph snapshot";
+        } else if (verify && fnv1a(FNV_OFFSET, (const char*)mapping + sizeof(header), header.fileSize - sizeof(header)) != header.payloadChecksum) {
+            problem = "snapshot checksum mismatch";
+        }
+    }
+    if (problem != NULL) {
+        fprintf(stderr, "%s: %s\n", name, problem);
+        munmap(mapping, (size_t)info.st_size);
+        return NULL;
+    }
+
+    struct Graph* graph = malloc(sizeof(struct Graph));
+    if (graph == NULL) {
+        munmap(mapping, (size_t)info.st_size);
+        return NULL;
+    }
+    graph->numCities = header.numCities;
+    graph->numEdges = header.numEdges;
+    graph->numTransports = 0;
+    graph->transportCapacity = 0;
+    graph->transports = NULL;
+    graph->transportIndex = NULL;
+    graph->offsets = (int*)((char*)mapping + header.offsetsPos);
+    graph->edges = (struct Edge*)((char*)mapping + header.edgesPos);
+    attachSchedules(graph, (char*)mapping + header.schedulesPos, header.maxDegree, header.regularSchedules != 0);
+    const char* names = (const char*)mapping + header.transportsPos;
+    for (int id = 0; id < header.numTransports; id++) {
+        char name[TRANSPORT_NAME_LEN];
+        memcpy(name, names + (size_t)id * TRANSPORT_NAME_LEN, TRANSPORT_NAME_LEN);
+        name[TRANSPORT_NAME_LEN - 1] = '\0';
+        internTransport(graph, name);
+    }
+    graph->removed = NULL;
+    graph->mapping = mapping;
+    graph->mappingLength = (size_t)info.st_size;
+    return graph;
+}
@@ -0,0 +1,55 @@
+/******************************************************************************
+ * NAME
+ *   snapshot.h
+ *
+ * DESCRIPTION
+ *   Header file for the binary graph snapshot (.graph) format.
+ *
+ * COMMENTS
+ *   A snapshot is a fixed header followed by the CSR arrays, the edge
+ *   schedules and the transport dictionary exactly as they are laid out in
+ *   memory. Loading it is a single
+ *   read-only mmap: nothing is parsed and no edge is copied.
+ *
+ ******************************************************************************/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "graph.h"
+
+#define SNAPSHOT_MAGIC "TOURGRPH"
+#define SNAPSHOT_VERSION 3
+
+// On-disk header, 64-bit aligned
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;         // 0x01020304 written in native order
+    int32_t numCities;
+    int32_t numEdges;
+    int32_t numTransports;
+    uint32_t edgeSize;          // sizeof(struct Edge) of the writer
+    uint64_t offsetsPos;        // byte positions of the sections
+    uint64_t edgesPos;
+    uint64_t schedulesPos;      // block of buildSchedules()
+    uint64_t transportsPos;
+    uint64_t fileSize;
+    int32_t maxDegree;          // schedule properties, derived from the edges when the map was read
+    uint32_t regularSchedules;
+    uint64_t payloadChecksum;   // FNV-1a over every byte after the header
+    uint64_t headerChecksum;    // FNV-1a over the header with this field set to 0
+};
+
+// Writes the graph as a snapshot; returns 1 on success
+int writeSnapshot(const struct Graph* graph, FILE* output);
+
+// Returns 1 if the open file starts with the snapshot magic
+int isSnapshot(FILE* file);
+
+// Maps a snapshot read-only; verify also checks the payload checksum. Returns NULL on error
+struct Graph* mapSnapshot(FILE* file, int verify, const char* name);
+
+#endif
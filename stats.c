@@ -0,0 +1,151 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: stats.c
+* Description: Writes the --stats report: phase timings, search counters, latency histogram and slowest clients.
+*/
+
+#include "stats.h"
+#include "dijkstra.h"
+#include "cache.h"
+#include "subgraph.h"
+#include <stdlib.h>
+
+/***********************************************************************************************************************
+ * addCounters()
+ *
+ * Arguments: a - counters to add to
+ *            b - counters added
+ * Returns: void
+ * Side-Effects: updates a
+ *
+ * Description: field by field sum.
+ ***********************************************************************************************************************/
+void addCounters(struct SearchCounters* a, const struct SearchCounters* b) {
+    a->settled += b->settled;
+    a->scanned += b->scanned;
+    a->filtered += b->filtered;
+    a->inserts += b->inserts;
+    a->decreases += b->decreases;
+    a->extracts += b->extracts;
+    a->reruns += b->reruns;
+}
+
+/***********************************************************************************************************************
+ * compareSlowest()
+ *
+ * Arguments: a, b - pointers to two QueryStats pointers
+ * Returns: negative, zero or positive as for qsort
+ * Side-Effects: none
+ *
+ * Description: slowest first, then by position in the batch so the order is stable.
+ ***********************************************************************************************************************/
+static int compareSlowest(const void* a, const void* b) {
+    const struct QueryStats* x = *(const struct QueryStats* const*)a;
+    const struct QueryStats* y = *(const struct QueryStats* const*)b;
+    if (x->nanoseconds != y->nanoseconds) return x->nanoseconds < y->nanoseconds ? 1 : -1;
+    return (x > y) - (x < y);
+}
+
+/***********************************************************************************************************************
+ * writeStats()
+ *
+ * Arguments: output - stats file
+ *            run - wall time of each phase
+ *            clients - clients of the batch
+ *            queries - measurements of each client
+ *            numClients - number of clients
+ * Returns: void
+ * Side-Effects: writes to the stats file
+ *
+ * Description: each client adds its share of its group's counters to the totals. Latencies go into power-of-two
+ *              buckets of microseconds.
+ ***********************************************************************************************************************/
+void writeStats(FILE* output, const struct RunStats* run, const struct Client* clients, const struct QueryStats* queries, int numClients) {
+    struct SearchCounters total = { 0, 0, 0, 0, 0, 0, 0 };
+    long long histogram[40] = { 0 };
+    long long solved = 0;
+
+    for (int i = 0; i < numClients; i++) {
+        const struct QueryStats* query = &queries[i];
+        total.settled += query->counters.settled / query->groupSize;
+        total.scanned += query->counters.scanned / query->groupSize;
+        total.filtered += query->counters.filtered / query->groupSize;
+        total.inserts += query->counters.inserts / query->groupSize;
+        total.decreases += query->counters.decreases / query->groupSize;
+        total.extracts += query->counters.extracts / query->groupSize;
+        total.reruns += query->counters.reruns / query->groupSize;
+        solved += query->nanoseconds;
+
+        int bucket = 0;
+        for (long long micro = query->nanoseconds / 1000; micro > 0 && bucket < 39; micro >>= 1) bucket++;
+        histogram[bucket]++;
+    }
+
+    fprintf(output, "phases (ms)\n");
+    fprintf(output, "  read map       %12.3f\n", run->readMap / 1e6);
+    fprintf(output, "  read clients   %12.3f\n", run->readClients / 1e6);
+    fprintf(output, "  load indexes   %12.3f\n", run->loadIndexes / 1e6);
+    fprintf(output, "  solve & write  %12.3f   (%d thread%s, %.3f ms in searches)\n", run->solve / 1e6,
+            run->numThreads, run->numThreads == 1 ? "" : "s", solved / 1e6);
+
+    fprintf(output, "\nsearch counters (approximate totals; clients sharing a search split its counters)\n");
+    fprintf(output, "  clients            %12d\n", numClients);
+    fprintf(output, "  settled            %12lld\n", total.settled);
+    fprintf(output, "  edges scanned      %12lld\n", total.scanned);
+    fprintf(output, "  edges filtered     %12lld\n", total.filtered);
+    fprintf(output, "  queue inserts      %12lld\n", total.inserts);
+    fprintf(output, "  queue decreases    %12lld\n", total.decreases);
+    fprintf(output, "  queue extracts     %12lld\n", total.extracts);
+    fprintf(output, "  exact reruns       %12lld\n", total.reruns);
+#ifndef TOURISTS_STATS
+    fprintf(output, "  (counters are zero: rebuild with \"make STATS=1\" to count)\n");
+#endif
+
+    if (run->cache != NULL) {
+        const struct ResultCache* cache = run->cache;
+        long long lookups = cache->hits + cache->misses;
+        fprintf(output, "\nresult cache\n");
+        fprintf(output, "  hits               %12lld   (%.1f%%)\n", cache->hits, lookups > 0 ? 100.0 * cache->hits / lookups : 0.0);
+        fprintf(output, "  misses             %12lld\n", cache->misses);
+        fprintf(output, "  evictions          %12lld\n", cache->evictions);
+        fprintf(output, "  entries            %12d\n", cache->numEntries);
+        fprintf(output, "  memory (KiB)       %12.1f   (of %.1f)\n", cache->bytes / 1024.0, cache->maxBytes / 1024.0);
+    }
+
+    if (run->subgraphs != NULL) {
+        const struct SubgraphCache* subgraphs = run->subgraphs;
+        fprintf(output, "\nsubgraph views\n");
+        fprintf(output, "  profiles           %12d\n", subgraphs->numViews);
+        fprintf(output, "  views built        %12lld\n", subgraphs->builds);
+        fprintf(output, "  searches on views  %12lld\n", subgraphs->searches);
+        fprintf(output, "  evictions          %12lld\n", subgraphs->evictions);
+        fprintf(output, "  memory (KiB)       %12.1f   (of %.1f)\n", subgraphs->bytes / 1024.0, subgraphs->maxBytes / 1024.0);
+    }
+
+    fprintf(output, "\nlatency histogram (us)\n");
+    for (int b = 0; b < 40; b++) {
+        if (histogram[b] == 0) continue;
+        long long low = b == 0 ? 0 : 1LL << (b - 1);
+        long long high = 1LL << b;
+        fprintf(output, "  %9lld .. %-9lld %10lld\n", low, high, histogram[b]);
+    }
+
+    const struct QueryStats** order = malloc((numClients > 0 ? numClients : 1) * sizeof(const struct QueryStats*));
+    if (order == NULL) exit(0);
+    for (int i = 0; i < numClients; i++) order[i] = &queries[i];
+    qsort(order, numClients, sizeof(const struct QueryStats*), compareSlowest);
+
+    fprintf(output, "\nslowest clients\n");
+    fprintf(output, "  %8s %8s %8s %-8s %12s %10s %12s %10s %10s %6s\n", "client", "start", "end", "filter",
+            "latency_us", "settled", "scanned", "filtered", "queue_ops", "group");
+    for (int k = 0; k < numClients && k < STATS_TOP; k++) {
+        const struct QueryStats* query = order[k];
+        const struct Client* client = &clients[query - queries];
+        const struct SearchCounters* c = &query->counters;
+        fprintf(output, "  %8d %8d %8d %-8s %12.1f %10lld %12lld %10lld %10lld %6d\n", client->clientID,
+                client->startCity, client->endCity, client->filter, query->nanoseconds / 1e3, c->settled, c->scanned,
+                c->filtered, c->inserts + c->decreases + c->extracts, query->groupSize);
+    }
+    free(order);
+}
@@ -0,0 +1,69 @@
+/******************************************************************************
+ * NAME
+ *   stats.h
+ *
+ * DESCRIPTION
+ *   Header file for the search instrumentation reported by --stats.
+ *
+ * COMMENTS
+ *   The counters in the search loops and the queues are only compiled in
+ *   builds made with "make STATS=1" (which defines TOURISTS_STATS); in other
+ *   builds STAT() expands to nothing and the loops are unchanged. Timings of
+ *   the phases and of each client do not need the counters.
+ *
+ ******************************************************************************/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+#ifdef TOURISTS_STATS
+#define STAT(statement) statement
+#else
+#define STAT(statement) ((void)0)
+#endif
+
+// Slowest clients listed in the stats file
+#define STATS_TOP 10
+
+// Work done by searches (settled cities, edges, queue operations)
+struct SearchCounters {
+    long long settled;          // cities settled (departures taken, for the connection scan)
+    long long scanned;          // edges (or departures, or hierarchy arcs) looked at
+    long long filtered;         // edges rejected by check_restrictions()
+    long long inserts;          // queue operations
+    long long decreases;
+    long long extracts;
+    long long reruns;           // searches run again because a capacity limit dropped part of them
+};
+
+// Measurements of one client
+struct QueryStats {
+    long long nanoseconds;      // time of the client's search group divided by the group size
+    int groupSize;              // clients answered by the same search
+    struct SearchCounters counters;     // work of the whole group
+};
+
+// Wall time of each phase of a run, in nanoseconds
+struct RunStats {
+    long long readMap;
+    long long readClients;
+    long long loadIndexes;
+    long long solve;            // solving and writing the .sol file
+    int numThreads;
+    const struct ResultCache* cache;    // --cache: hits, misses and memory, NULL without a cache
+    const struct SubgraphCache* subgraphs;      // --subgraphs: views built and reused, NULL without views
+};
+
+struct Client;
+struct ResultCache;
+struct SubgraphCache;
+
+// Adds the counters of b to a
+void addCounters(struct SearchCounters* a, const struct SearchCounters* b);
+
+// Writes the stats file: phases, total counters, latency histogram and the slowest clients
+void writeStats(FILE* output, const struct RunStats* run, const struct Client* clients, const struct QueryStats* queries, int numClients);
+
+#endif
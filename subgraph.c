@@ -0,0 +1,248 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: subgraph.c
+* Description: Subgraph cache: compact copies of the map keeping only the connections a restriction profile allows,
+*              evicted in least recently used order when the memory budget is reached.
+*/
+
+#include "subgraph.h"
+#include <stdlib.h>
+
+/***********************************************************************************************************************
+ * createSubgraphCache()
+ *
+ * Arguments: maxBytes - memory budget of the views
+ * Returns: pointer to the empty cache
+ * Side-Effects: allocates dynamic memory, exits if memory runs out
+ *
+ * Description: no view is built until a profile is looked up.
+ ***********************************************************************************************************************/
+struct SubgraphCache* createSubgraphCache(size_t maxBytes) {
+    struct SubgraphCache* cache = malloc(sizeof(struct SubgraphCache));
+    if (cache == NULL) exit(0);
+    cache->maxBytes = maxBytes;
+    cache->bytes = 0;
+    cache->numViews = 0;
+    cache->batch = 0;
+    cache->searches = 0;
+    cache->builds = 0;
+    cache->evictions = 0;
+    return cache;
+}
+
+/***********************************************************************************************************************
+ * startSubgraphBatch()
+ *
+ * Arguments: cache - subgraph cache
+ * Returns: void
+ * Side-Effects: advances the batch counter
+ *
+ * Description: views looked up by earlier batches may be evicted again.
+ ***********************************************************************************************************************/
+void startSubgraphBatch(struct SubgraphCache* cache) {
+    cache->batch++;
+}
+
+/***********************************************************************************************************************
+ * removeView()
+ *
+ * Arguments: cache - subgraph cache
+ *            slot - position of the view
+ * Returns: void
+ * Side-Effects: frees the view, moves the last view into its slot
+ *
+ * Description: the order of the slots does not matter.
+ ***********************************************************************************************************************/
+static void removeView(struct SubgraphCache* cache, int slot) {
+    struct Subgraph* view = cache->views[slot];
+    cache->bytes -= view->bytes;
+    free(view->offsets);
+    free(view->edges);
+    free(view->edgeIds);
+    free(view);
+    cache->views[slot] = cache->views[--cache->numViews];
+}
+
+/***********************************************************************************************************************
+ * evictOldest()
+ *
+ * Arguments: cache - subgraph cache
+ * Returns: true if a view was evicted, false if every view is used by the current batch
+ * Side-Effects: frees the least recently used view
+ *
+ * Description: linear scan, there are at most SUBGRAPH_SLOTS views.
+ ***********************************************************************************************************************/
+static bool evictOldest(struct SubgraphCache* cache) {
+    int oldest = -1;
+    for (int slot = 0; slot < cache->numViews; slot++) {
+        const struct Subgraph* view = cache->views[slot];
+        if (view->lastUse < cache->batch && (oldest < 0 || view->lastUse < cache->views[oldest]->lastUse)) {
+            oldest = slot;
+        }
+    }
+    if (oldest < 0) return false;
+    removeView(cache, oldest);
+    cache->evictions++;
+    return true;
+}
+
+/***********************************************************************************************************************
+ * allowed()
+ *
+ * Arguments: view - profile
+ *            edge - CSR edge
+ * Returns: true if the profile allows the edge
+ * Side-Effects: none
+ *
+ * Description: the test of check_restrictions(), on the normalized profile.
+ ***********************************************************************************************************************/
+static bool allowed(const struct Subgraph* view, const struct Edge* edge) {
+    bool transport = view->excludedTransport >= 0 ? edge->transport != view->excludedTransport
+                     : edge->transport >= TRANSPORT_MASK_BITS || ((view->allowedTransports >> edge->transport) & 1);
+    return transport && edge->travelDuration <= view->maxDuration && edge->travelCost <= view->maxCost;
+}
+
+/***********************************************************************************************************************
+ * buildView()
+ *
+ * Arguments: cache - subgraph cache
+ *            graph - map graph in CSR layout
+ *            view - remembered profile without a copy
+ * Returns: true if the view was built, false if the profile is not worth a copy or does not fit in the budget
+ * Side-Effects: may evict views not used by the current batch, exits if memory runs out
+ *
+ * Description: counts the connections the profile keeps; if it removes enough of them, room is made and the kept
+ *              connections are copied in CSR order.
+ ***********************************************************************************************************************/
+static bool buildView(struct SubgraphCache* cache, const struct Graph* graph, struct Subgraph* view) {
+    int kept = 0;
+    for (int e = 0; e < graph->numEdges; e++) {
+        if (allowed(view, &graph->edges[e])) kept++;
+    }
+    if ((long long)(graph->numEdges - kept) * SUBGRAPH_MIN_REMOVED < graph->numEdges) {
+        view->declined = true;
+        return false;
+    }
+
+    size_t bytes = (graph->numCities + 1) * sizeof(int) + kept * (sizeof(struct Edge) + sizeof(int));
+    while (cache->bytes + bytes > cache->maxBytes && evictOldest(cache)) {
+    }
+    if (cache->bytes + bytes > cache->maxBytes) return false;
+
+    view->offsets = malloc((graph->numCities + 1) * sizeof(int));
+    view->edges = malloc((kept > 0 ? kept : 1) * sizeof(struct Edge));
+    view->edgeIds = malloc((kept > 0 ? kept : 1) * sizeof(int));
+    if (view->offsets == NULL || view->edges == NULL || view->edgeIds == NULL) exit(0);
+
+    int k = 0;
+    for (int u = 0; u < graph->numCities; u++) {
+        view->offsets[u] = k;
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            if (!allowed(view, &graph->edges[e])) continue;
+            view->edges[k] = graph->edges[e];
+            view->edgeIds[k] = e;
+            k++;
+        }
+    }
+    view->offsets[graph->numCities] = k;
+    view->numEdges = kept;
+    view->bytes = bytes;
+    cache->bytes += bytes;
+    cache->builds++;
+    return true;
+}
+
+/***********************************************************************************************************************
+ * findSubgraph()
+ *
+ * Arguments: cache - subgraph cache
+ *            graph - map graph in CSR layout
+ *            restrictions - restrictions of the searches
+ *            searches - number of searches of this batch that will use the view
+ * Returns: the view of the restrictions' profile, or NULL if the searches should run on the map (no filter, a profile
+ *          seen for the first time by a single search, too few connections removed, or no room in the budget)
+ * Side-Effects: may remember the profile, build its view and evict older ones
+ *
+ * Description: a profile is copied the second time it is looked up, or the first time if several searches need it.
+ ***********************************************************************************************************************/
+const struct Subgraph* findSubgraph(struct SubgraphCache* cache, const struct Graph* graph, const struct Restrictions* restrictions, int searches) {
+    if (restrictions->allowedTransports == ~(uint64_t)0 && restrictions->excludedTransport < 0 && !restrictions->A2 &&
+        !restrictions->A3) {
+        return NULL;
+    }
+
+    uint64_t allowedTransports = restrictions->allowedTransports;
+    int excludedTransport = restrictions->excludedTransport;
+    int maxDuration = restrictions->A2 ? restrictions->maxDuration : INF;
+    int maxCost = restrictions->A3 ? restrictions->maxCost : INF;
+
+    struct Subgraph* view = NULL;
+    for (int slot = 0; slot < cache->numViews && view == NULL; slot++) {
+        struct Subgraph* candidate = cache->views[slot];
+        if (candidate->allowedTransports == allowedTransports && candidate->excludedTransport == excludedTransport &&
+            candidate->maxDuration == maxDuration && candidate->maxCost == maxCost) {
+            view = candidate;
+        }
+    }
+
+    if (view == NULL) {
+        while (cache->numViews == SUBGRAPH_SLOTS && evictOldest(cache)) {
+        }
+        if (cache->numViews == SUBGRAPH_SLOTS) return NULL;
+        view = malloc(sizeof(struct Subgraph));
+        if (view == NULL) exit(0);
+        view->allowedTransports = allowedTransports;
+        view->excludedTransport = excludedTransport;
+        view->maxDuration = maxDuration;
+        view->maxCost = maxCost;
+        view->numEdges = 0;
+        view->offsets = NULL;
+        view->edges = NULL;
+        view->edgeIds = NULL;
+        view->declined = false;
+        view->bytes = 0;
+        view->lastUse = cache->batch;
+        cache->views[cache->numViews++] = view;
+        if (searches < 2) return NULL;
+    } else if (view->offsets != NULL) {
+        view->lastUse = cache->batch;
+        cache->searches += searches;
+        return view;
+    }
+
+    view->lastUse = cache->batch;
+    if (view->declined || !buildView(cache, graph, view)) return NULL;
+    cache->searches += searches;
+    return view;
+}
+
+/***********************************************************************************************************************
+ * clearSubgraphCache()
+ *
+ * Arguments: cache - subgraph cache
+ * Returns: void
+ * Side-Effects: frees every view, keeping the counters
+ *
+ * Description: used when the map the views were copied from changes.
+ ***********************************************************************************************************************/
+void clearSubgraphCache(struct SubgraphCache* cache) {
+    while (cache->numViews > 0) {
+        removeView(cache, cache->numViews - 1);
+    }
+}
+
+/***********************************************************************************************************************
+ * freeSubgraphCache()
+ *
+ * Arguments: cache - pointer to the cache
+ * Returns: void
+ * Side-Effects: frees dynamically allocated memory
+ *
+ * Description: frees the views and the structure.
+ ***********************************************************************************************************************/
+void freeSubgraphCache(struct SubgraphCache* cache) {
+    if (cache == NULL) return;
+    clearSubgraphCache(cache);
+    free(cache);
+}
@@ -0,0 +1,76 @@
+/******************************************************************************
+ * NAME
+ *   subgraph.h
+ *
+ * DESCRIPTION
+ *   Header file for the subgraph cache: copies of the map without the
+ *   connections a set of A1/A2/A3 filters forbids.
+ *
+ * COMMENTS
+ *   Clients tend to reuse a few restriction profiles. Once a profile has
+ *   been asked for by more than one search, the connections it allows are
+ *   copied into a compact CSR view (in the same order, so searches take the
+ *   same decisions), and later searches with that profile run on the view
+ *   without checking the filters. A copy costs about as much as a search, so
+ *   profiles seen once are only remembered, and profiles that forbid too few
+ *   connections are remembered as not worth a copy. Views are evicted in least recently used order to stay within a
+ *   memory budget, but never while the batch that looked them up runs.
+ *
+ ******************************************************************************/
+
+#ifndef SUBGRAPH_H
+#define SUBGRAPH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dijkstra.h"
+
+// Profiles remembered at once
+#define SUBGRAPH_SLOTS 64
+// A view is only built if its filters remove at least 1 / SUBGRAPH_MIN_REMOVED of the connections
+#define SUBGRAPH_MIN_REMOVED 8
+
+// Connections allowed by one restriction profile
+struct Subgraph {
+    uint64_t allowedTransports; // profile (limits are INF when absent)
+    int excludedTransport;
+    int maxDuration;
+    int maxCost;
+    int numEdges;
+    int* offsets;               // numCities + 1 entries; NULL if the profile was not worth a view
+    struct Edge* edges;
+    int* edgeIds;               // index in graph->edges of each edge of the view
+    bool declined;              // the profile removes too few connections to be worth a copy
+    size_t bytes;
+    long long lastUse;          // batch that last looked the profile up
+};
+
+// Views of one map
+struct SubgraphCache {
+    size_t maxBytes;
+    size_t bytes;
+    int numViews;
+    struct Subgraph* views[SUBGRAPH_SLOTS];
+    long long batch;            // incremented by startSubgraphBatch()
+    long long searches;         // searches given a view
+    long long builds;
+    long long evictions;
+};
+
+// Creates an empty cache whose views use at most maxBytes
+struct SubgraphCache* createSubgraphCache(size_t maxBytes);
+
+// Starts a new batch: the views looked up from now on stay until the next call
+void startSubgraphBatch(struct SubgraphCache* cache);
+
+// Returns the view of the restrictions' profile for that many searches of this batch, building it when it is worth
+// it; NULL if the searches should use the map
+const struct Subgraph* findSubgraph(struct SubgraphCache* cache, const struct Graph* graph, const struct Restrictions* restrictions, int searches);
+
+// Frees every view
+void clearSubgraphCache(struct SubgraphCache* cache);
+
+// Frees the cache
+void freeSubgraphCache(struct SubgraphCache* cache);
+
+#endif
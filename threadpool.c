@@ -0,0 +1,182 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: threadpool.c
+* Description: Work-stealing thread pool over a fixed set of integer tasks.
+*/
+
+#include "threadpool.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Range of tasks still owned by a worker: [head, tail)
+struct TaskRange {
+    pthread_mutex_t lock;
+    int head;
+    int tail;
+};
+
+struct Worker {
+    struct ThreadPool* pool;
+    int id;
+    pthread_t thread;
+};
+
+struct ThreadPool {
+    int numThreads;
+    struct TaskRange* ranges;
+    struct Worker* workers;
+    TaskFunction run;
+    void* context;
+};
+
+/***********************************************************************************************************************
+ * popOwnTask()
+ *
+ * Arguments: range - task range owned by the calling worker
+ * Returns: next task of the range, or -1 if it is empty
+ * Side-Effects: advances the head of the range
+ *
+ * Description: takes the lowest-numbered task left in the worker's own range.
+ ***********************************************************************************************************************/
+static int popOwnTask(struct TaskRange* range) {
+    int task = -1;
+    pthread_mutex_lock(&range->lock);
+    if (range->head < range->tail) {
+        task = range->head++;
+    }
+    pthread_mutex_unlock(&range->lock);
+    return task;
+}
+
+/***********************************************************************************************************************
+ * stealTasks()
+ *
+ * Arguments: pool - pointer to the pool
+ *            id - index of the idle worker
+ * Returns: 1 if tasks were stolen into the worker's own range, 0 if every range is empty
+ * Side-Effects: moves tasks between ranges
+ *
+ * Description: visits the other workers in turn and moves the back half of the first non-empty range found into
+ *              the idle worker's range. Only one lock is held at a time.
+ ***********************************************************************************************************************/
+static int stealTasks(struct ThreadPool* pool, int id) {
+    for (int k = 1; k < pool->numThreads; k++) {
+        struct TaskRange* victim = &pool->ranges[(id + k) % pool->numThreads];
+        int head = 0, tail = 0;
+
+        pthread_mutex_lock(&victim->lock);
+        int remaining = victim->tail - victim->head;
+        if (remaining > 0) {
+            tail = victim->tail;
+            head = tail - (remaining + 1) / 2;
+            victim->tail = head;
+        }
+        pthread_mutex_unlock(&victim->lock);
+
+        if (head < tail) {
+            struct TaskRange* own = &pool->ranges[id];
+            pthread_mutex_lock(&own->lock);
+            own->head = head;
+            own->tail = tail;
+            pthread_mutex_unlock(&own->lock);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/***********************************************************************************************************************
+ * workerMain()
+ *
+ * Arguments: arg - pointer to the worker structure
+ * Returns: NULL
+ * Side-Effects: runs tasks
+ *
+ * Description: main loop of a worker: run own tasks, steal when out of work, stop when nothing is left to steal.
+ ***********************************************************************************************************************/
+static void* workerMain(void* arg) {
+    struct Worker* worker = arg;
+    struct ThreadPool* pool = worker->pool;
+
+    for (;;) {
+        int task = popOwnTask(&pool->ranges[worker->id]);
+        if (task < 0) {
+            if (!stealTasks(pool, worker->id)) break;
+            continue;
+        }
+        pool->run(pool->context, task, worker->id);
+    }
+    return NULL;
+}
+
+/***********************************************************************************************************************
+ * startThreadPool()
+ *
+ * Arguments: numThreads - number of worker threads
+ *            numTasks - number of tasks
+ *            run - function executed for each task
+ *            context - pointer passed to run
+ * Returns: pointer to the running pool
+ * Side-Effects: allocates dynamic memory and creates threads, exits if either fails
+ *
+ * Description: splits the tasks into numThreads contiguous ranges and starts one worker per range.
+ ***********************************************************************************************************************/
+struct ThreadPool* startThreadPool(int numThreads, int numTasks, TaskFunction run, void* context) {
+    struct ThreadPool* pool = malloc(sizeof(struct ThreadPool));
+    if (pool == NULL) exit(0);
+    pool->numThreads = numThreads;
+    pool->run = run;
+    pool->context = context;
+    pool->ranges = malloc(numThreads * sizeof(struct TaskRange));
+    pool->workers = malloc(numThreads * sizeof(struct Worker));
+    if (pool->ranges == NULL || pool->workers == NULL) exit(0);
+
+    for (int t = 0; t < numThreads; t++) {
+        pthread_mutex_init(&pool->ranges[t].lock, NULL);
+        pool->ranges[t].head = (int)((long long)numTasks * t / numThreads);
+        pool->ranges[t].tail = (int)((long long)numTasks * (t + 1) / numThreads);
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pool->workers[t].pool = pool;
+        pool->workers[t].id = t;
+        if (pthread_create(&pool->workers[t].thread, NULL, workerMain, &pool->workers[t]) != 0) exit(0);
+    }
+    return pool;
+}
+
+/***********************************************************************************************************************
+ * joinThreadPool()
+ *
+ * Arguments: pool - pointer to the pool
+ * Returns: void
+ * Side-Effects: blocks until every worker exits, frees dynamic memory
+ *
+ * Description: waits for all tasks to complete and releases the pool.
+ ***********************************************************************************************************************/
+void joinThreadPool(struct ThreadPool* pool) {
+    for (int t = 0; t < pool->numThreads; t++) {
+        pthread_join(pool->workers[t].thread, NULL);
+    }
+    for (int t = 0; t < pool->numThreads; t++) {
+        pthread_mutex_destroy(&pool->ranges[t].lock);
+    }
+    free(pool->ranges);
+    free(pool->workers);
+    free(pool);
+}
+
+/***********************************************************************************************************************
+ * availableProcessors()
+ *
+ * Arguments: none
+ * Returns: number of processors online, at least 1
+ * Side-Effects: none
+ *
+ * Description: used when the user asks for -j 0 (one worker per processor).
+ ***********************************************************************************************************************/
+int availableProcessors(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
@@ -0,0 +1,33 @@
+/******************************************************************************
+ * NAME
+ *   threadpool.h
+ *
+ * DESCRIPTION
+ *   Header file for the work-stealing thread pool used to solve clients in
+ *   parallel.
+ *
+ * COMMENTS
+ *   Tasks are the integers 0 .. numTasks-1. Each worker starts with a
+ *   contiguous range and takes tasks from its front; an idle worker steals
+ *   the back half of another worker's range.
+ *
+ ******************************************************************************/
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+// Function executed for each task; thread is the worker index (0 .. numThreads-1)
+typedef void (*TaskFunction)(void* context, int task, int thread);
+
+struct ThreadPool;
+
+// Starts numThreads workers that run every task once
+struct ThreadPool* startThreadPool(int numThreads, int numTasks, TaskFunction run, void* context);
+
+// Waits for every task to finish and frees the pool
+void joinThreadPool(struct ThreadPool* pool);
+
+// Number of processors online, at least 1
+int availableProcessors(void);
+
+#endif
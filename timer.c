@@ -0,0 +1,24 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: timer.c
+* Description: Monotonic clock used by the benchmark report.
+*/
+
+#include "timer.h"
+#include <time.h>
+
+/***********************************************************************************************************************
+ * nowNanoseconds()
+ *
+ * Arguments: none
+ * Returns: current time of the monotonic clock in nanoseconds
+ * Side-Effects: none
+ *
+ * Description: unaffected by changes of the wall clock, so differences measure elapsed time.
+ ***********************************************************************************************************************/
+long long nowNanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
@@ -0,0 +1,18 @@
+/******************************************************************************
+ * NAME
+ *   timer.h
+ *
+ * DESCRIPTION
+ *   Header file for the monotonic clock used to time runs and queries.
+ *
+ * COMMENTS
+ *
+ ******************************************************************************/
+
+#ifndef TIMER_H
+#define TIMER_H
+
+// Nanoseconds since an arbitrary fixed point (only differences are meaningful)
+long long nowNanoseconds(void);
+
+#endif
@@ -0,0 +1,175 @@
+/*
+* AED Project 2025/2026
+* Authors: Filipe Serafim (ist1110177) and Lena Wang (ist1110762)
+* File: workspace.c
+* Description: Allocation and lazy reset of the per-thread query workspace.
+*/
+
+#include "workspace.h"
+#include "rcsp.h"
+#include <stdlib.h>
+#include <string.h>
+
+/***********************************************************************************************************************
+ * createWorkspace()
+ *
+ * Arguments: numCities - number of cities in the map
+ * Returns: pointer to the created workspace
+ * Side-Effects: allocates dynamic memory, exits if memory runs out
+ *
+ * Description: allocates every per-city array used by a search, plus the heap, once for the whole batch.
+ ***********************************************************************************************************************/
+struct Workspace* createWorkspace(int numCities) {
+    int n = numCities > 0 ? numCities : 1;
+
+    struct Workspace* ws = malloc(sizeof(struct Workspace));
+    if (ws == NULL) exit(0);
+    ws->numCities = numCities;
+    ws->epoch = 0;
+    ws->stamp = calloc(n, sizeof(unsigned int));
+    ws->targetStamp = calloc(n, sizeof(unsigned int));
+    ws->weight = malloc(n * sizeof(int));
+    ws->heapIndex = malloc(n * sizeof(int));
+    ws->prevCity = malloc(n * sizeof(int));
+    ws->prevEdge = malloc(n * sizeof(int));
+    ws->trip = malloc(n * sizeof(int));
+    ws->tripEdge = malloc(n * sizeof(int));
+    ws->potential = malloc(n * sizeof(int));
+    ws->arrivals = NULL;
+    ws->arrivalCapacity = 0;
+    ws->heap = createMinHeap(n);
+    ws->queueKind = QUEUE_BINARY;
+    ws->maxStep = 0;
+    ws->counters = (struct SearchCounters){ 0, 0, 0, 0, 0, 0, 0 };
+    ws->reverse = NULL;
+    ws->labels = NULL;
+    if (ws->stamp == NULL || ws->targetStamp == NULL || ws->weight == NULL || ws->heapIndex == NULL ||
+        ws->prevCity == NULL || ws->prevEdge == NULL || ws->trip == NULL || ws->tripEdge == NULL || ws->potential == NULL || ws->heap == NULL) {
+        exit(0);
+    }
+    return ws;
+}
+
+/***********************************************************************************************************************
+ * resetWorkspace()
+ *
+ * Arguments: ws - pointer to the workspace
+ * Returns: void
+ * Side-Effects: advances the epoch and empties the heap
+ *
+ * Description: prepares the workspace for a new query. Cities are re-initialized lazily by touchCity(); the stamps
+ *              are only cleared when the epoch counter wraps around.
+ ***********************************************************************************************************************/
+void resetWorkspace(struct Workspace* ws) {
+    ws->epoch++;
+    if (ws->epoch == 0) {
+        memset(ws->stamp, 0, (ws->numCities > 0 ? ws->numCities : 1) * sizeof(unsigned int));
+        memset(ws->targetStamp, 0, (ws->numCities > 0 ? ws->numCities : 1) * sizeof(unsigned int));
+        ws->epoch = 1;
+    }
+    clearMinHeap(ws->heap);
+}
+
+/***********************************************************************************************************************
+ * setWorkspaceQueue()
+ *
+ * Arguments: ws - pointer to the workspace
+ *            kind - QUEUE_BINARY, QUEUE_QUATERNARY, QUEUE_RADIX or QUEUE_DIAL
+ *            maxStep - largest step of a search on the map, sizes the bucket queue
+ * Returns: void
+ * Side-Effects: frees the current queue and allocates the new one (also for the backward search state)
+ *
+ * Description: selects the priority queue every search run on this workspace uses.
+ ***********************************************************************************************************************/
+void setWorkspaceQueue(struct Workspace* ws, int kind, int maxStep) {
+    int n = ws->numCities > 0 ? ws->numCities : 1;
+
+    freeMinHeap(ws->heap);
+    ws->heap = createQueue(kind, n, maxStep);
+    ws->queueKind = kind;
+    ws->maxStep = maxStep;
+    if (ws->reverse != NULL) setWorkspaceQueue(ws->reverse, kind, maxStep);
+}
+
+/***********************************************************************************************************************
+ * takeCounters()
+ *
+ * Arguments: ws - pointer to the workspace
+ *            total - counters to add to
+ * Returns: void
+ * Side-Effects: zeroes the counters of the workspace, its queue and its backward state
+ *
+ * Description: collects the work of the searches run since the last call, for --stats.
+ ***********************************************************************************************************************/
+void takeCounters(struct Workspace* ws, struct SearchCounters* total) {
+    ws->counters.inserts = ws->heap->inserts;
+    ws->counters.decreases = ws->heap->decreases;
+    ws->counters.extracts = ws->heap->extracts;
+    addCounters(total, &ws->counters);
+    ws->counters = (struct SearchCounters){ 0, 0, 0, 0, 0, 0, 0 };
+    ws->heap->inserts = ws->heap->decreases = ws->heap->extracts = 0;
+    if (ws->reverse != NULL) takeCounters(ws->reverse, total);
+}
+
+/***********************************************************************************************************************
+ * reserveArrivals()
+ *
+ * Arguments: ws - pointer to the workspace
+ *            count - number of edges
+ * Returns: void
+ * Side-Effects: grows the arrivals buffer, exits if memory runs out
+ *
+ * Description: sized for the city with the most edges the first time a duration search uses the edge schedules.
+ ***********************************************************************************************************************/
+void reserveArrivals(struct Workspace* ws, int count) {
+    if (count <= ws->arrivalCapacity) return;
+    free(ws->arrivals);
+    ws->arrivals = malloc(count * sizeof(int));
+    if (ws->arrivals == NULL) exit(0);
+    ws->arrivalCapacity = count;
+}
+
+/***********************************************************************************************************************
+ * reverseWorkspace()
+ *
+ * Arguments: ws - pointer to the workspace
+ * Returns: pointer to the backward search state
+ * Side-Effects: allocates it on the first call
+ *
+ * Description: bidirectional searches keep a second, independent set of per-city arrays for the backward search;
+ *              the profile engine keeps the arrivals of its sweep there.
+ ***********************************************************************************************************************/
+struct Workspace* reverseWorkspace(struct Workspace* ws) {
+    if (ws->reverse == NULL) {
+        ws->reverse = createWorkspace(ws->numCities);
+        if (ws->queueKind != QUEUE_BINARY) setWorkspaceQueue(ws->reverse, ws->queueKind, ws->maxStep);
+    }
+    return ws->reverse;
+}
+
+/***********************************************************************************************************************
+ * freeWorkspace()
+ *
+ * Arguments: ws - pointer to the workspace
+ * Returns: void
+ * Side-Effects: frees dynamically allocated memory
+ *
+ * Description: frees every array of the workspace and the heap.
+ ***********************************************************************************************************************/
+void freeWorkspace(struct Workspace* ws) {
+    if (ws == NULL) return;
+    free(ws->stamp);
+    free(ws->targetStamp);
+    free(ws->weight);
+    free(ws->heapIndex);
+    free(ws->prevCity);
+    free(ws->prevEdge);
+    free(ws->trip);
+    free(ws->tripEdge);
+    free(ws->potential);
+    free(ws->arrivals);
+    freeMinHeap(ws->heap);
+    freeWorkspace(ws->reverse);
+    freeLabelPool(ws->labels);
+    free(ws);
+}
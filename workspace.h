@@ -0,0 +1,78 @@
+/******************************************************************************
+ * NAME
+ *   workspace.h
+ *
+ * DESCRIPTION
+ *   Header file for the per-thread query workspace reused by every search.
+ *
+ * COMMENTS
+ *   The arrays are allocated once for the whole map. A city's entries are only
+ *   meaningful when stamp[city] == epoch; starting a new query just bumps the
+ *   epoch, so a query only initializes the cities it actually reaches.
+ *
+ ******************************************************************************/
+
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <limits.h>
+#include "heap.h"
+
+#define INF INT_MAX
+
+// Search state reused across queries
+struct Workspace {
+    int numCities;
+    unsigned int epoch;
+    unsigned int* stamp;
+    unsigned int* targetStamp;  // == epoch while the city is a target not yet settled
+    int* weight;
+    int* heapIndex;
+    int* prevCity;
+    int* prevEdge;          // index in graph->edges of the edge used to reach the city
+    int* trip;              // path being written: city reached by each hop
+    int* tripEdge;          // and the edge used for that hop
+    int* potential;         // A* lower bound to the target, set when a city is first labelled
+    int* arrivals;          // arrival through each edge of the city being relaxed (see edgeArrivals())
+    int arrivalCapacity;
+    struct minHeap* heap;
+    int queueKind;          // QUEUE_* of the heap and of the reverse workspace's heap
+    int maxStep;
+    struct SearchCounters counters;     // settled, scanned and filtered counts (STATS=1 builds); queue ops are in heap
+    struct Workspace* reverse;  // second search state for bidirectional engines (the arrivals of a profile sweep),
+                                // created on first use
+    struct LabelPool* labels;   // labels of the budget-aware engine, created on first use
+};
+
+// Allocates a workspace for a map with numCities cities
+struct Workspace* createWorkspace(int numCities);
+
+// Starts a new query: invalidates every city in O(1)
+void resetWorkspace(struct Workspace* ws);
+
+// Replaces the workspace's binary heap with another priority queue (kind already resolved by chooseQueue())
+void setWorkspaceQueue(struct Workspace* ws, int kind, int maxStep);
+
+// Adds the counters of the workspace, its queue and its backward state to total, then zeroes them
+void takeCounters(struct Workspace* ws, struct SearchCounters* total);
+
+// Makes room for the arrivals through count edges
+void reserveArrivals(struct Workspace* ws, int count);
+
+// Returns the second search state of the workspace, allocating it the first time
+struct Workspace* reverseWorkspace(struct Workspace* ws);
+
+// Frees the workspace
+void freeWorkspace(struct Workspace* ws);
+
+// Initializes the entries of a city the first time the current query reaches it
+static inline void touchCity(struct Workspace* ws, int city) {
+    if (ws->stamp[city] != ws->epoch) {
+        ws->stamp[city] = ws->epoch;
+        ws->weight[city] = INF;
+        ws->heapIndex[city] = -1;
+        ws->prevCity[city] = city;
+    }
+}
+
+#endif